@@ -0,0 +1,174 @@
+/*!
+@example    AdaptiveBufferDepth.cpp
+
+*  @page       adaptive-buffer-depth-cpp AdaptiveBufferDepth.cpp
+
+*  @brief      Streaming PT motion with an adaptive number of queued points.
+
+*  @details
+UpdateBufferPoints.cpp always keeps two blocks of BUFFER_SZ points queued, no matter how quickly the host responds.
+This sample measures the host wake-up latency after every SyncInterruptWait() and the exact number of queued points
+(from MotionIdExecutingGet() and MotionElementIdExecutingGet()), and lets a StreamingDepthController pick how many points to send.
+
+When the host is responsive the queue stays short, which keeps command-to-motion latency low.
+When latency spikes or the queue gets close to EMPTY_CT, the queue grows before the controller can e-stop.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include AdaptiveBufferDepth.cpp
+*/
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "StreamingDepthController.h"               // Import the adaptive depth controller.
+
+using namespace RSI::RapidCode;
+
+void adaptiveBufferDepthMain()
+{
+    const double    TIME_SLICE = 0.001;                                 // 0.001s = 1ms
+    const int       AXIS_COUNT = 1;                                     // number of axes
+    const int       REVS = 5;                                           // number of revolutions
+    const int       RPS = 1;                                            // revs / sec
+    const int       CPS = (int)std::pow(2, 20);                         // encoder counts per rev (set as appropiate)
+    const int       TOTAL_POINTS = (int)(REVS / TIME_SLICE / RPS);      // total number of points
+    const int       EMPTY_CT = 10;                                      // Number of points that remains in the buffer before an e-stop
+    const int       SYNC_PERIOD = 10;                                   // samples between sync interrupts
+    const int       MIN_POINTS = 20;                                    // lower bound on queued points
+    const int       MAX_POINTS = 500;                                   // upper bound on queued points
+    const int       BLOCK_POINTS = 10;                                  // send in multiples of this many points
+    const double    STARTUP_LATENCY = 0.005;                            // worst wake-up latency (s) assumed until one is measured
+
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    try
+    {
+        SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+
+        // add an additional axis for the multiaxis supervisor
+        controller->MotionCountSet(AXIS_COUNT + 1);
+        MultiAxis *multiAxis = controller->MultiAxisGet(AXIS_COUNT);
+        SampleAppsCPP::HelperFunctions::CheckErrors(multiAxis);
+
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            Axis *tempAxis = controller->AxisGet(i);
+            SampleAppsCPP::HelperFunctions::CheckErrors(tempAxis);
+
+            tempAxis->EStopAbort();
+            tempAxis->ClearFaults();
+            tempAxis->PositionSet(0);
+            tempAxis->UserUnitsSet(CPS);
+            multiAxis->AxisAdd(tempAxis);
+        }
+
+        // populate the positions and times
+        std::vector<double> positions, times;
+        for (int i = 0; i < TOTAL_POINTS; i++)
+        {
+            for (int axis = 0; axis < AXIS_COUNT; axis++)
+            {
+                positions.push_back(i * TIME_SLICE * RPS);
+            }
+            times.push_back(TIME_SLICE);
+        }
+
+        // prepare the controller (and drive)
+        multiAxis->Abort();
+        multiAxis->ClearFaults();
+        assert(multiAxis->StateGet() == RSIState::RSIStateIDLE);
+        multiAxis->AmpEnableSet(true);
+
+        // reset the motion ID to 0
+        multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, &positions[0], &times[0], 1, -1, false, true);
+        multiAxis->MotionIdSet(0);
+
+        // configure the depth controller from the controller's timing
+        const double sampleRate = controller->SampleRateGet();
+        SampleAppsCPP::StreamingDepthConfig config;
+        config.emptyCount = EMPTY_CT;
+        config.minPoints = MIN_POINTS;
+        config.maxPoints = MAX_POINTS;
+        config.blockPoints = BLOCK_POINTS;
+        config.samplesPerPoint = TIME_SLICE * sampleRate;
+        config.syncPeriodSamples = SYNC_PERIOD;
+        config.latencyDecay = 0.999;                                    // a latency spike is remembered for a few thousand cycles
+        config.quietCyclesToShrink = 100;
+        config.startupLatencySamples = STARTUP_LATENCY * sampleRate;
+
+        SampleAppsCPP::StreamingBlockLedger ledger;
+        SampleAppsCPP::StreamingDepthController depth(config);
+        SampleAppsCPP::WakeLatencyEstimator wakeLatency((double)controller->OS->PerformanceTimerFrequencyGet() / sampleRate);
+        SampleAppsCPP::HostTickCounter hostTimer;
+        ledger.Reset(0);
+
+        // Set up a motion hold gate and queue a latency-safe depth (not just MIN_POINTS) before starting
+        const int motionHoldGate = 3;
+        controller->MotionHoldGateSet(motionHoldGate, true);
+        multiAxis->MotionHoldGateSet(motionHoldGate);
+
+        int endOfLastSent = 0;
+        int numPointsToSend = depth.InitialPointsGet();
+        bool exitCondition = false;
+        multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, &positions[0], &times[0], numPointsToSend, EMPTY_CT, false, exitCondition);
+        ledger.BlockSent(numPointsToSend);
+        endOfLastSent += numPointsToSend;
+
+        controller->SyncInterruptPeriodSet(SYNC_PERIOD);
+        controller->SyncInterruptEnableSet(true);
+
+        controller->MotionHoldGateSet(motionHoldGate, false); // release the hold gate to start moving
+
+        while (!exitCondition)
+        {
+            int32 sampleRecieved = controller->SyncInterruptWait();
+            double latency = wakeLatency.Update(sampleRecieved, hostTimer.Read(controller->OS));
+
+            int32 curMotionID = multiAxis->MotionIdExecutingGet();
+            int32 curMotionElementID = multiAxis->MotionElementIdExecutingGet();
+            int64_t queued = ledger.QueuedPointsGet(curMotionID, curMotionElementID);
+
+            numPointsToSend = depth.Update(latency, queued);
+            if (numPointsToSend == 0)
+            {
+                continue;
+            }
+
+            // check end condition
+            if (TOTAL_POINTS <= (endOfLastSent + numPointsToSend))
+            {
+                numPointsToSend = TOTAL_POINTS - endOfLastSent; // send the remaining points
+                exitCondition = true;
+            }
+            multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, &positions[0] + endOfLastSent * AXIS_COUNT, &times[0] + endOfLastSent, numPointsToSend, EMPTY_CT, false, exitCondition);
+            ledger.BlockSent(numPointsToSend);
+            endOfLastSent += numPointsToSend;
+        }
+
+        printf("Updates Done. Target depth %d points, latency peak %.2lf samples, closest margin %d points. Waiting to finish motion.\n",
+            depth.TargetPointsGet(), depth.LatencyPeakGet(), depth.ClosestMarginGet());
+        multiAxis->MotionDoneWait();
+
+        controller->SyncInterruptEnableSet(false);
+        multiAxis->EStopAbort();
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
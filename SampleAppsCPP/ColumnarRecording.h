@@ -0,0 +1,689 @@
+/*!
+*  @example    ColumnarRecording.h
+
+*  @page       columnar-recording-cpp ColumnarRecording.h
+
+*  @brief      Recorder captures with a name and type per channel, stored column by column so one channel can be read without the others.
+
+*  @details
+The recorder returns each record as 32-bit values, one per RecorderDataAddressSet() address.  Many of the values worth recording are
+64-bit doubles in controller memory (ACTUAL_POSITION, COMMAND_VELOCITY; see Memory.cpp's MemoryDoubleGet()), so they take two recorder values,
+the address and the address + 4.  Recorder.cpp used to copy records into an int32 array and print those halves with %lf.
+
+Here each channel has a name and a RecordingChannelType, and RecordingChannelsConfigure() sets two recorder addresses for each 64-bit channel.
+ColumnarRecordingWriter takes records straight from the recorder (it is a RecordSink for RecorderService) and stores them in chunks.
+Within a chunk each channel's values are contiguous, either as raw values or, with ColumnarCompressionDELTA_XOR, encoded as they arrive
+by a ColumnEncoder (RecordCompression.h: delta-of-delta varints for integers, XOR for floats and doubles).
+A column that does not get smaller encoded (a noisy torque, say) is stored raw in that chunk, flagged by COLUMNAR_COLUMN_RAW in its size:
+
+@code
+    offset 0                    ColumnarRecordingHeader (64 bytes)
+    64                          ColumnarRecordingChannel[channelCount] (64 bytes each: name, type, first recorder value)
+    ...                         chunk 0: channel 0 column, channel 1 column, ...
+    ...                         chunk 1: ...
+    chunkIndexOffset            per chunk: ColumnarRecordingChunk (file offset, record count), then uint64_t column bytes[channelCount],
+                                each with COLUMNAR_COLUMN_RAW set if that column is stored raw
+@endcode
+
+ColumnarRecordingReader reads the header, channel table and chunk index, then ChannelRead() seeks to one channel's column in every chunk,
+so loading one of 32 channels reads about 1/32 of the data.  Every chunk starts its encoders afresh, so each column decodes on its own.
+Values are little-endian, as they are in controller memory.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include ColumnarRecording.h
+
+*/
+#ifndef CPP_COLUMNAR_RECORDING
+#define CPP_COLUMNAR_RECORDING
+
+#include "RecordCompression.h"                      // Import the streaming channel encoders.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace SampleAppsCPP
+{
+    const char     COLUMNAR_RECORDING_MAGIC[8] = { 'R', 'S', 'I', 'C', 'O', 'L', 'R', '1' };
+    const uint32_t COLUMNAR_RECORDING_VERSION = 2;                      // the only version read
+    const int      COLUMNAR_RECORDING_NAME_SIZE = 48;
+    const uint64_t COLUMNAR_COLUMN_RAW = 1ull << 63;                    // in a chunk index column size: stored raw, not encoded
+    const uint32_t COLUMNAR_RECORDING_MAX_CHUNK_RECORDS = 1u << 24;     // a compressed column is not bounded by the file size, so this bounds it
+
+    enum RecordingChannelType
+    {
+        RecordingChannelTypeINT32 = 0,
+        RecordingChannelTypeUINT32 = 1,
+        RecordingChannelTypeFLOAT = 2,
+        RecordingChannelTypeDOUBLE = 3,                             // two recorder values: address, address + 4
+        RecordingChannelTypeINT64 = 4,                              // two recorder values: address, address + 4
+    };
+
+    inline int32_t RecordingChannelBytesGet(RecordingChannelType type)
+    {
+        return (type == RecordingChannelTypeDOUBLE || type == RecordingChannelTypeINT64) ? 8 : 4;
+    }
+
+    inline const char* RecordingChannelTypeNameGet(RecordingChannelType type)
+    {
+        static const char *names[] = { "int32", "uint32", "float", "double", "int64" };
+        return (type >= RecordingChannelTypeINT32 && type <= RecordingChannelTypeINT64) ? names[type] : "unknown";
+    }
+
+    /// <summary>
+    /// A channel to record: a name such as "axis0.actual_position" and the type of the value at its address.
+    /// </summary>
+    struct RecordingChannel
+    {
+        const char              *name;
+        RecordingChannelType    type;
+    };
+
+    /// <summary>
+    /// Recorder values the channels need: one per 32-bit channel, two per 64-bit channel.
+    /// </summary>
+    inline int32_t RecordingValueCountGet(const RecordingChannel *channels, int32_t channelCount)
+    {
+        int32_t values = 0;
+        for (int32_t i = 0; i < channelCount; i++)
+        {
+            values += RecordingChannelBytesGet(channels[i].type) / 4;
+        }
+        return values;
+    }
+
+    /// <summary>
+    /// RecorderDataCountSet() and RecorderDataAddressSet() for the channels, in order, with both halves of every 64-bit channel.
+    /// Returns the value count.
+    /// </summary>
+    template <class ControllerT>
+    int32_t RecordingChannelsConfigure(ControllerT *controller, const RecordingChannel *channels, const uint64_t *addresses, int32_t channelCount)
+    {
+        const int32_t valueCount = RecordingValueCountGet(channels, channelCount);
+        controller->RecorderDataCountSet(valueCount);
+        int32_t value = 0;
+        for (int32_t i = 0; i < channelCount; i++)
+        {
+            for (int32_t word = 0; word < RecordingChannelBytesGet(channels[i].type) / 4; word++)
+            {
+                controller->RecorderDataAddressSet(value++, addresses[i] + word * 4);
+            }
+        }
+        return valueCount;
+    }
+
+    /// <summary>
+    /// The encoder state and output of one channel's column: Append() each value, Finish() at the end of a chunk, then BytesGet().
+    /// </summary>
+    class ColumnEncoder
+    {
+    public:
+        explicit ColumnEncoder(RecordingChannelType type = RecordingChannelTypeINT32) : type(type) {}
+
+        /// <summary>
+        /// Add one value, RecordingChannelBytesGet(type) bytes as recorded.
+        /// </summary>
+        void Append(const void *value)
+        {
+            switch (type)
+            {
+            case RecordingChannelTypeFLOAT:  { uint32_t v; memcpy(&v, value, sizeof(v)); floats.Append(bytes, bits, v); break; }
+            case RecordingChannelTypeDOUBLE: { uint64_t v; memcpy(&v, value, sizeof(v)); doubles.Append(bytes, bits, v); break; }
+            case RecordingChannelTypeUINT32: { uint32_t v; memcpy(&v, value, sizeof(v)); integers.Append(bytes, (int64_t)v); break; }
+            case RecordingChannelTypeINT64:  { int64_t v;  memcpy(&v, value, sizeof(v)); integers.Append(bytes, v); break; }
+            default:                         { int32_t v;  memcpy(&v, value, sizeof(v)); integers.Append(bytes, (int64_t)v); break; }
+            }
+        }
+
+        /// <summary>
+        /// Write out the last partial byte of a bit stream or the last run of an integer column.  BytesGet() is then complete.
+        /// </summary>
+        void Finish()
+        {
+            bits.Flush(bytes);
+            integers.Flush(bytes);
+        }
+
+        const std::vector<uint8_t>& BytesGet() const { return bytes; }
+
+        /// <summary>
+        /// Start a new column: empty output and fresh state.
+        /// </summary>
+        void Reset()
+        {
+            bytes.clear();
+            bits.Reset();
+            integers.Reset();
+            floats.Reset();
+            doubles.Reset();
+        }
+
+    private:
+        RecordingChannelType    type;
+        std::vector<uint8_t>    bytes;
+        BitWriter               bits;
+        DeltaOfDeltaEncoder     integers;
+        XorEncoder<uint32_t>    floats;
+        XorEncoder<uint64_t>    doubles;
+    };
+
+    /// <summary>
+    /// Decode a column of count values written by ColumnEncoder, appending them to values (RecordingChannelBytesGet(type) bytes each).
+    /// values grows as they are decoded, so data that ends early stops it.  Returns false if the data ends early.
+    /// </summary>
+    inline bool ColumnDecode(RecordingChannelType type, const uint8_t *data, size_t size, int64_t count, std::vector<unsigned char>& values)
+    {
+        const uint8_t *end = data + size;
+        if (type == RecordingChannelTypeFLOAT || type == RecordingChannelTypeDOUBLE)
+        {
+            BitReader bits(data, end);
+            XorDecoder<uint32_t> floats;
+            XorDecoder<uint64_t> doubles;
+            for (int64_t i = 0; i < count && !bits.OverrunGet(); i++)
+            {
+                unsigned char bytes[sizeof(uint64_t)];
+                if (type == RecordingChannelTypeFLOAT)
+                {
+                    const uint32_t v = floats.Next(bits);
+                    memcpy(bytes, &v, sizeof(v));
+                    values.insert(values.end(), bytes, bytes + sizeof(v));
+                }
+                else
+                {
+                    const uint64_t v = doubles.Next(bits);
+                    memcpy(bytes, &v, sizeof(v));
+                    values.insert(values.end(), bytes, bytes + sizeof(v));
+                }
+            }
+            return !bits.OverrunGet();
+        }
+
+        DeltaOfDeltaDecoder integers;
+        for (int64_t i = 0; i < count; i++)
+        {
+            int64_t v;
+            if (!integers.Next(data, end, &v))
+            {
+                return false;
+            }
+            unsigned char bytes[sizeof(v)];
+            if (type == RecordingChannelTypeINT64)
+            {
+                memcpy(bytes, &v, sizeof(v));
+                values.insert(values.end(), bytes, bytes + sizeof(v));
+            }
+            else
+            {
+                const uint32_t low = (uint32_t)v;
+                memcpy(bytes, &low, sizeof(low));
+                values.insert(values.end(), bytes, bytes + sizeof(low));
+            }
+        }
+        return true;
+    }
+
+    enum ColumnarCompression
+    {
+        ColumnarCompressionNONE = 0,
+        ColumnarCompressionDELTA_XOR = 1,                           // ColumnEncoder
+    };
+
+    /// <summary>
+    /// On-disk header.  Little-endian, 64 bytes.
+    /// </summary>
+    struct ColumnarRecordingHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t channelCount;
+        uint32_t valuesPerRecord;
+        uint32_t chunkRecords;                                      // records per chunk, except the last (1 to COLUMNAR_RECORDING_MAX_CHUNK_RECORDS)
+        uint64_t recordCount;
+        uint64_t chunkCount;
+        uint64_t chunkIndexOffset;
+        uint32_t compression;                                       // ColumnarCompression
+        uint32_t reserved32;
+        uint64_t reserved;
+    };
+    static_assert(sizeof(ColumnarRecordingHeader) == 64, "ColumnarRecordingHeader must stay 64 bytes.");
+
+    struct ColumnarRecordingChannel
+    {
+        char     name[COLUMNAR_RECORDING_NAME_SIZE];
+        uint32_t type;                                              // RecordingChannelType
+        uint32_t valueIndex;                                        // first recorder value of the channel
+        uint32_t bytes;                                             // per value
+        uint32_t reserved;
+    };
+    static_assert(sizeof(ColumnarRecordingChannel) == 64, "ColumnarRecordingChannel must stay 64 bytes.");
+
+    struct ColumnarRecordingChunk
+    {
+        uint64_t offset;
+        uint64_t recordCount;
+    };
+
+    /// <summary>
+    /// Writes recorder records as a columnar recording, one chunk at a time.
+    /// </summary>
+    class ColumnarRecordingWriter
+    {
+    public:
+        ColumnarRecordingWriter() : file(nullptr), chunkFill(0), ok(false) { memset(&header, 0, sizeof(header)); }
+        ~ColumnarRecordingWriter() { Close(); }
+
+        /// <summary>
+        /// Create the file.  Channels are in recorder order, as given to RecordingChannelsConfigure().  Returns false if it could not be created.
+        /// </summary>
+        /// <param name="chunkRecords">Records buffered per chunk, up to COLUMNAR_RECORDING_MAX_CHUNK_RECORDS.  Larger chunks mean fewer seeks when a reader loads one channel.</param>
+        /// <param name="compression">ColumnarCompressionDELTA_XOR encodes every value as it is appended, on the drain thread.</param>
+        bool Open(const char *path, const RecordingChannel *channelList, int32_t channelCount, int32_t chunkRecords = 4096,
+            ColumnarCompression compression = ColumnarCompressionNONE)
+        {
+            Close();
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, COLUMNAR_RECORDING_MAGIC, sizeof(header.magic));
+            header.version = COLUMNAR_RECORDING_VERSION;
+            header.channelCount = (uint32_t)channelCount;
+            header.valuesPerRecord = (uint32_t)RecordingValueCountGet(channelList, channelCount);
+            header.chunkRecords = chunkRecords < 1 ? 1 : ((uint32_t)chunkRecords > COLUMNAR_RECORDING_MAX_CHUNK_RECORDS ? COLUMNAR_RECORDING_MAX_CHUNK_RECORDS : (uint32_t)chunkRecords);
+            header.compression = (uint32_t)compression;
+
+            channels.assign(channelCount, ColumnarRecordingChannel());
+            columns.assign(channelCount, std::vector<unsigned char>());
+            encoders.clear();
+            uint32_t value = 0;
+            for (int32_t i = 0; i < channelCount; i++)
+            {
+                memset(&channels[i], 0, sizeof(channels[i]));
+                strncpy(channels[i].name, channelList[i].name, COLUMNAR_RECORDING_NAME_SIZE - 1);
+                channels[i].type = (uint32_t)channelList[i].type;
+                channels[i].valueIndex = value;
+                channels[i].bytes = (uint32_t)RecordingChannelBytesGet(channelList[i].type);
+                value += channels[i].bytes / 4;
+                columns[i].resize((size_t)header.chunkRecords * channels[i].bytes);       // kept when compressing too, for columns that do not shrink
+                if (compression != ColumnarCompressionNONE)
+                {
+                    encoders.push_back(ColumnEncoder(channelList[i].type));
+                }
+            }
+            chunkIndex.clear();
+            chunkFill = 0;
+
+            file = fopen(path, "wb");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            ok = fwrite(&header, sizeof(header), 1, file) == 1;
+            ok = ok && fwrite(channels.data(), sizeof(ColumnarRecordingChannel), channels.size(), file) == channels.size();
+            return ok;
+        }
+
+        /// <summary>
+        /// Append recordCount records of valuesPerRecord 32-bit values each, as the recorder returns them.  Returns false on a write error.
+        /// </summary>
+        bool RecordsAppend(const int32_t *records, int32_t recordCount, int32_t valuesPerRecord)
+        {
+            if (file == nullptr || (uint32_t)valuesPerRecord != header.valuesPerRecord)
+            {
+                return false;
+            }
+            for (int32_t r = 0; r < recordCount; r++)
+            {
+                const int32_t *record = records + (size_t)r * valuesPerRecord;
+                for (size_t c = 0; c < channels.size(); c++)
+                {
+                    memcpy(&columns[c][(size_t)chunkFill * channels[c].bytes], record + channels[c].valueIndex, channels[c].bytes);
+                    if (!encoders.empty())
+                    {
+                        encoders[c].Append(record + channels[c].valueIndex);
+                    }
+                }
+                if (++chunkFill == header.chunkRecords)
+                {
+                    ChunkWrite();
+                }
+            }
+            return ok;
+        }
+
+        /// <summary>
+        /// RecordSink for RecorderService, with the writer as the context.
+        /// </summary>
+        static bool RecordsSink(void *writer, const int32_t *records, int32_t recordCount, int32_t valuesPerRecord)
+        {
+            return static_cast<ColumnarRecordingWriter *>(writer)->RecordsAppend(records, recordCount, valuesPerRecord);
+        }
+
+        /// <summary>
+        /// Write the last chunk and the chunk index, and finish the header.  Returns false if any write failed.
+        /// </summary>
+        bool Close()
+        {
+            if (file == nullptr)
+            {
+                return false;
+            }
+            ChunkWrite();
+            header.chunkCount = chunkIndex.size() / ChunkIndexEntryWordsGet(channels.size());
+            header.chunkIndexOffset = (uint64_t)Tell();
+            ok = ok && fwrite(chunkIndex.data(), sizeof(uint64_t), chunkIndex.size(), file) == chunkIndex.size();
+            ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+            ok = (fclose(file) == 0) && ok;
+            file = nullptr;
+            return ok;
+        }
+
+        uint64_t RecordCountGet() const { return header.recordCount + chunkFill; }
+
+        /// <summary>
+        /// uint64_t words per chunk index entry: the ColumnarRecordingChunk, then one column size per channel.
+        /// </summary>
+        static size_t ChunkIndexEntryWordsGet(size_t channelCount) { return sizeof(ColumnarRecordingChunk) / sizeof(uint64_t) + channelCount; }
+
+    private:
+        void ChunkWrite()
+        {
+            if (chunkFill == 0)
+            {
+                return;
+            }
+            chunkIndex.push_back((uint64_t)Tell());
+            chunkIndex.push_back(chunkFill);
+            for (size_t c = 0; c < channels.size(); c++)
+            {
+                const unsigned char *column = columns[c].data();
+                size_t size = (size_t)chunkFill * channels[c].bytes;
+                uint64_t flags = encoders.empty() ? 0 : COLUMNAR_COLUMN_RAW;
+                if (!encoders.empty())
+                {
+                    encoders[c].Finish();
+                    if (encoders[c].BytesGet().size() < size)
+                    {
+                        column = encoders[c].BytesGet().data();
+                        size = encoders[c].BytesGet().size();
+                        flags = 0;
+                    }
+                }
+                ok = ok && fwrite(column, 1, size, file) == size;
+                chunkIndex.push_back(size | flags);
+                if (!encoders.empty())
+                {
+                    encoders[c].Reset();
+                }
+            }
+            header.recordCount += chunkFill;
+            chunkFill = 0;
+        }
+
+        int64_t Tell() const
+        {
+#ifdef _WIN32
+            return _ftelli64(file);
+#else
+            return (int64_t)ftello(file);
+#endif
+        }
+
+        FILE                                    *file;
+        ColumnarRecordingHeader                 header;
+        std::vector<ColumnarRecordingChannel>   channels;
+        std::vector<std::vector<unsigned char>> columns;            // this chunk's raw values, per channel
+        std::vector<ColumnEncoder>              encoders;           // and, when compressing, its encoded values
+        std::vector<uint64_t>                   chunkIndex;
+        uint32_t                                chunkFill;
+        bool                                    ok;
+    };
+
+    /// <summary>
+    /// Reads single channels from a columnar recording.
+    /// </summary>
+    /// @code
+    ///     SampleAppsCPP::ColumnarRecordingReader recording;
+    ///     if (!recording.Open("recorder.rsicol")) { printf("%s\n", recording.ErrorGet()); }
+    ///     std::vector<double> positions;
+    ///     recording.ChannelRead(recording.ChannelIndexGet("axis0.actual_position"), positions);
+    /// @endcode
+    class ColumnarRecordingReader
+    {
+    public:
+        ColumnarRecordingReader() : file(nullptr), error("not open") { memset(&header, 0, sizeof(header)); }
+        ~ColumnarRecordingReader() { Close(); }
+
+        /// <summary>
+        /// Read the header, channel table and chunk index.  Returns false (see ErrorGet()) if the file is not a valid recording.
+        /// </summary>
+        bool Open(const char *path)
+        {
+            Close();
+            file = fopen(path, "rb");
+            if (file == nullptr)
+            {
+                error = "cannot open columnar recording";
+                return false;
+            }
+            if (!Validate())
+            {
+                Close();
+                return false;
+            }
+            error = nullptr;
+            return true;
+        }
+
+        void Close()
+        {
+            if (file != nullptr)
+            {
+                fclose(file);
+            }
+            file = nullptr;
+            channels.clear();
+            chunks.clear();
+            columnBytes.clear();
+            columnRaw.clear();
+        }
+
+        const char*             ErrorGet() const { return error; }              // nullptr if open and valid
+        int32_t                 ChannelCountGet() const { return (int32_t)channels.size(); }
+        int64_t                 RecordCountGet() const { return (int64_t)header.recordCount; }
+        const char*             ChannelNameGet(int32_t channel) const { return channels[channel].name; }
+        RecordingChannelType    ChannelTypeGet(int32_t channel) const { return (RecordingChannelType)channels[channel].type; }
+        ColumnarCompression     CompressionGet() const { return (ColumnarCompression)header.compression; }
+
+        /// <summary>
+        /// Bytes a channel takes in the file, over all chunks, encoded or (where encoding did not help) raw.
+        /// </summary>
+        uint64_t ChannelStoredBytesGet(int32_t channel) const
+        {
+            uint64_t bytes = 0;
+            for (size_t k = 0; k < chunks.size(); k++)
+            {
+                bytes += columnBytes[k * channels.size() + channel];
+            }
+            return bytes;
+        }
+
+        /// <summary>
+        /// Channel number of a name, or -1.
+        /// </summary>
+        int32_t ChannelIndexGet(const char *name) const
+        {
+            for (size_t i = 0; i < channels.size(); i++)
+            {
+                if (strncmp(channels[i].name, name, COLUMNAR_RECORDING_NAME_SIZE) == 0)
+                {
+                    return (int32_t)i;
+                }
+            }
+            return -1;
+        }
+
+        /// <summary>
+        /// Every value of one channel, converted to T.  Reads only that channel's columns.  Returns false on a read error or a bad channel.
+        /// </summary>
+        template <class T>
+        bool ChannelRead(int32_t channel, std::vector<T>& values)
+        {
+            values.clear();
+            if (file == nullptr || channel < 0 || channel >= (int32_t)channels.size())
+            {
+                return false;
+            }
+            std::vector<unsigned char> column;                              // grows as it is read or decoded, never from the header's counts
+            std::vector<unsigned char> stored;
+            for (size_t k = 0; k < chunks.size(); k++)
+            {
+                const uint64_t *sizes = &columnBytes[k * channels.size()];
+                uint64_t offset = chunks[k].offset;
+                for (int32_t c = 0; c < channel; c++)
+                {
+                    offset += sizes[c];
+                }
+                const bool raw = columnRaw[k * channels.size() + channel] != 0;
+                std::vector<unsigned char>& read = raw ? column : stored;
+                read.resize((size_t)sizes[channel]);                        // bounded by the file size; Validate() made raw sizes equal the column's
+                if (!Seek(offset) || fread(read.data(), 1, read.size(), file) != read.size())
+                {
+                    return false;
+                }
+                if (!raw)
+                {
+                    column.clear();
+                    if (!ColumnDecode((RecordingChannelType)channels[channel].type, stored.data(), stored.size(), (int64_t)chunks[k].recordCount, column))
+                    {
+                        return false;
+                    }
+                }
+                for (uint64_t r = 0; r < chunks[k].recordCount; r++)
+                {
+                    values.push_back(ValueGet<T>(&column[(size_t)(r * channels[channel].bytes)], (RecordingChannelType)channels[channel].type));
+                }
+            }
+            return true;
+        }
+
+    private:
+        template <class T>
+        static T ValueGet(const unsigned char *bytes, RecordingChannelType type)
+        {
+            switch (type)
+            {
+            case RecordingChannelTypeUINT32: { uint32_t v; memcpy(&v, bytes, sizeof(v)); return (T)v; }
+            case RecordingChannelTypeFLOAT:  { float v;    memcpy(&v, bytes, sizeof(v)); return (T)v; }
+            case RecordingChannelTypeDOUBLE: { double v;   memcpy(&v, bytes, sizeof(v)); return (T)v; }
+            case RecordingChannelTypeINT64:  { int64_t v;  memcpy(&v, bytes, sizeof(v)); return (T)v; }
+            default:                         { int32_t v;  memcpy(&v, bytes, sizeof(v)); return (T)v; }
+            }
+        }
+
+        bool Seek(uint64_t offset)
+        {
+#ifdef _WIN32
+            return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+            return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+        }
+
+        // Size of the file in bytes, or -1.  Leaves the position at the start.
+        int64_t FileSizeGet()
+        {
+#ifdef _WIN32
+            const int64_t size = _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+#else
+            const int64_t size = fseeko(file, 0, SEEK_END) == 0 ? (int64_t)ftello(file) : -1;
+#endif
+            return Seek(0) ? size : -1;
+        }
+
+        // Every count and size in the file is checked against the file size before it sizes a vector or a read.  Record counts are not:
+        // a compressed column holds many records in a few bytes, so they are capped by COLUMNAR_RECORDING_MAX_CHUNK_RECORDS instead.
+        bool Validate()
+        {
+            const int64_t fileSize = FileSizeGet();
+            if (fileSize < 0) { error = "cannot get columnar recording size"; return false; }
+            if (fread(&header, sizeof(header), 1, file) != 1) { error = "columnar recording is too small"; return false; }
+            if (memcmp(header.magic, COLUMNAR_RECORDING_MAGIC, sizeof(COLUMNAR_RECORDING_MAGIC)) != 0) { error = "not a columnar recording"; return false; }
+            if (header.version != COLUMNAR_RECORDING_VERSION) { error = "unsupported columnar recording version"; return false; }
+            if (header.compression > ColumnarCompressionDELTA_XOR) { error = "unsupported columnar recording compression"; return false; }
+            if (header.chunkIndexOffset == 0) { error = "columnar recording was not closed"; return false; }
+            if (header.chunkRecords == 0 || header.chunkRecords > COLUMNAR_RECORDING_MAX_CHUNK_RECORDS) { error = "columnar recording chunk size is corrupt"; return false; }
+            if (header.chunkIndexOffset > (uint64_t)fileSize) { error = "columnar recording chunk index is truncated"; return false; }
+            if (header.channelCount > ((uint64_t)fileSize - sizeof(header)) / sizeof(ColumnarRecordingChannel)) { error = "columnar recording channel table is truncated"; return false; }
+
+            channels.resize(header.channelCount);
+            if (fread(channels.data(), sizeof(ColumnarRecordingChannel), channels.size(), file) != channels.size()) { error = "columnar recording channel table is truncated"; return false; }
+            for (size_t i = 0; i < channels.size(); i++)
+            {
+                channels[i].name[COLUMNAR_RECORDING_NAME_SIZE - 1] = 0;
+                if (channels[i].bytes != (uint32_t)RecordingChannelBytesGet((RecordingChannelType)channels[i].type)) { error = "columnar recording channel table is corrupt"; return false; }
+            }
+
+            const size_t entryWords = ColumnarRecordingWriter::ChunkIndexEntryWordsGet(channels.size());
+            if (header.chunkCount > ((uint64_t)fileSize - header.chunkIndexOffset) / (entryWords * sizeof(uint64_t))) { error = "columnar recording chunk index is truncated"; return false; }
+            if (header.recordCount > header.chunkCount * header.chunkRecords) { error = "columnar recording record count is corrupt"; return false; }
+            std::vector<uint64_t> chunkIndex((size_t)header.chunkCount * entryWords);
+            if (!Seek(header.chunkIndexOffset) || fread(chunkIndex.data(), sizeof(uint64_t), chunkIndex.size(), file) != chunkIndex.size())
+            {
+                error = "columnar recording chunk index is truncated";
+                return false;
+            }
+            chunks.resize((size_t)header.chunkCount);
+            columnBytes.resize(chunks.size() * channels.size());
+            columnRaw.resize(chunks.size() * channels.size());
+            const uint64_t dataStart = sizeof(header) + channels.size() * sizeof(ColumnarRecordingChannel);
+            uint64_t records = 0;
+            for (size_t k = 0; k < chunks.size(); k++)
+            {
+                memcpy(&chunks[k], &chunkIndex[k * entryWords], sizeof(ColumnarRecordingChunk));
+                if (chunks[k].recordCount == 0 || chunks[k].recordCount > header.chunkRecords || chunks[k].offset < dataStart || chunks[k].offset > header.chunkIndexOffset)
+                {
+                    error = "columnar recording chunk index is corrupt";
+                    return false;
+                }
+
+                // the chunk's columns must lie between its offset and the chunk index, and raw columns hold exactly recordCount values
+                uint64_t end = chunks[k].offset;
+                for (size_t c = 0; c < channels.size(); c++)
+                {
+                    const uint64_t rawBytes = chunks[k].recordCount * channels[c].bytes;
+                    const uint64_t word = chunkIndex[k * entryWords + 2 + c];
+                    const uint64_t size = word & ~COLUMNAR_COLUMN_RAW;
+                    const bool raw = header.compression == ColumnarCompressionNONE || (word & COLUMNAR_COLUMN_RAW) != 0;
+                    if ((raw && size != rawBytes) || size > header.chunkIndexOffset - end)
+                    {
+                        error = "columnar recording chunk index is corrupt";
+                        return false;
+                    }
+                    columnBytes[k * channels.size() + c] = size;
+                    columnRaw[k * channels.size() + c] = raw ? 1 : 0;
+                    end += size;
+                }
+                records += chunks[k].recordCount;
+            }
+            if (records != header.recordCount) { error = "columnar recording chunk index is corrupt"; return false; }
+            return true;
+        }
+
+        FILE                                    *file;
+        const char                              *error;
+        ColumnarRecordingHeader                 header;
+        std::vector<ColumnarRecordingChannel>   channels;
+        std::vector<ColumnarRecordingChunk>     chunks;
+        std::vector<uint64_t>                   columnBytes;        // [chunk * channelCount + channel], without COLUMNAR_COLUMN_RAW
+        std::vector<uint8_t>                    columnRaw;          // [chunk * channelCount + channel], 1 if stored raw
+    };
+}
+#endif
@@ -21,62 +21,81 @@
 */
 
 #include "rsi.h"
+#include "Custom97Layout.h"
+#include "LatencyHistogram.h"
+#include "MissedSampleMonitor.h"
+#include "CycleLog.h"
+#include "CycleRecorder.h"
+#include "PhaseProfiler.h"
+#include "StreamingDepthController.h"
 
 using namespace RSI::RapidCode::SynqNet;
 
 //configurable
 #define SYNC_PERIOD				(1)		// interrupt every SynqNet/MotionController sample
 #define FIRMWARE_WAIT_TIME		(12000)  // 25 nanosecond cycles to delay the firmware foreground -- "tune" this value using VM3 and HostProcessTime
-#define DATA_READ_COUNT			(3)		// how many Rincon values to read
-#define DATA_WRITE_COUNT		(3)		// how many values to write to the Rincon buffer
+#define RECORD_PATH				(NULL)	// for example "custom97.cycles": record every cycle's read and write buffers, saved after the loop
+#define REPLAY_PATH				(NULL)	// for example "custom97.cycles": run a recording through CycleCompute() instead of the controller
+#define RECORD_MAX_CYCLES		(60000)	// cycles kept by the recorder
 
 
-// hard-coded addresses from VM3  -- these are the addresses we want to read/write in the SynqNet buffer
-#define ENCODER_X_ADDR			(0x1000180)
-#define ENCODER_Y_ADDR			(0x1000220)
-#define ENCODER_Z_ADDR			(0x1000260)
+// define your own Custom97 data -- one field per 32-bit value (up to 64 per buffer), with the
+// hard-coded address from VM3 we want to read/write in the SynqNet buffer
+struct EncoderX : SampleAppsCPP::Custom97Field<0x1000180> {};
+struct EncoderY : SampleAppsCPP::Custom97Field<0x1000220> {};
+struct EncoderZ : SampleAppsCPP::Custom97Field<0x1000260> {};
 
-#define TORQUE_X_ADDR			(0x1000184)
-#define TORQUE_Y_ADDR			(0x1000224)
-#define TORQUE_Z_ADDR			(0x1000264)
+struct TorqueX : SampleAppsCPP::Custom97Field<0x1000184> {};		// will write to torque outputs(ZMP)
+struct TorqueY : SampleAppsCPP::Custom97Field<0x1000224> {};
+struct TorqueZ : SampleAppsCPP::Custom97Field<0x1000264> {};
+
+// buffer order is list order; pointer registration and sizes follow from these
+typedef SampleAppsCPP::Custom97Layout<EncoderX, EncoderY, EncoderZ>	ReadData;
+typedef SampleAppsCPP::Custom97Layout<TorqueX, TorqueY, TorqueZ>	WriteData;
 
 //constants
 #define MS_PER_SECOND			(1000.0)
+#define NS_PER_MS				(1000000.0)
 
 
 
 // some global data for the sample code
 MotionController *controller;
 
-long			currentCounter = 0;
-long			previousCounter = 0;
+uint64_t		currentCounter = 0;
+uint64_t		previousCounter = 0;
 long			deltaSamples = 0;
 long			iterations = 0;
 unsigned long	cpuFreq = 0;
+static long		hostProcessTime = 0;	// microseconds
 double			deltaTime = 0.0;
 double			minTime = 1000000.0;
 double			maxTime = 0.0;
 
+static SampleAppsCPP::LatencyHistogram		periodHistogram;		// interrupt-to-interrupt period, ns
+static SampleAppsCPP::LatencyHistogram		wakeLatencyHistogram;	// host wake-up after the earliest possible wake-up, ns
+static SampleAppsCPP::WakeLatencyEstimator	*wakeLatency;
+static SampleAppsCPP::HostTickCounter		hostTimer;				// PerformanceTimerCountGet() is 32 bits and wraps, every timestamp goes through this
+static double	nsPerSample = 0.0;
 
-// define your own structures for storing the Custom97 data -- up to 64 32-bit values each
-typedef struct {
-	long encoderX;
-	long encoderY;
-	long encoderZ;
-} ReadData;
+// the loop queues its messages and a background thread prints them, so printf() never blocks the Sync interrupt
+static SampleAppsCPP::CycleLog<4096>		cycleLog;
 
+// where the host process time goes, phase by phase
+enum CyclePhase { PHASE_WAKE_UP, PHASE_READ, PHASE_COMPUTE, PHASE_WRITE, PHASE_FLAG_CLEAR, PHASE_COUNT };
+static const char	*phaseNames[PHASE_COUNT] = { "wake-up", "read", "compute", "write", "flag clear" };
+static SampleAppsCPP::PhaseProfiler		*profiler;
+#define PROFILE_WINDOW_CYCLES	(1000)
 
-typedef struct {
-	long torqueX;
-	long torqueY;
-	long torqueZ;
-} WriteData;
+// sync interrupts we slept through, found from the sample counter
+static SampleAppsCPP::MissedSampleMonitor	missedSamples(SYNC_PERIOD);
 
-long readSize;
-long writeSize; 
+// statically allocated, cache-line aligned Custom97 buffers
+static ReadData	readData;
+static WriteData	writeData;
 
-ReadData *readData;
-WriteData *writeData;
+// every cycle's read and write buffers, when RECORD_PATH is set
+static SampleAppsCPP::CycleRecorder		*recorder;
 
 
 
@@ -87,7 +106,8 @@ void CheckHostProcessTimeStatus()
 	// did we take too long processing the previous interrupt?
 	if(controller->SyncInterruptHostProcessStatusBitGet() == true)
 	{
-		printf("\n\n Oops, we took too long processing the last interrupt. \n");
+		cycleLog.Log("\n\n Oops, we took too long processing the last interrupt. \n");
+		profiler->OverrunConfirm();
 
 		// clear the Host Process Status Bit
 		controller->SyncInterruptHostProcessStatusClear();
@@ -95,10 +115,12 @@ void CheckHostProcessTimeStatus()
 }
 
 
-void PrintTimingInfo()
+// returns the wake-up latency in ns
+double PrintTimingInfo(int32 sample, uint64_t hostTicks)
 {
-	currentCounter = controller->OS->PerformanceTimerCountGet();
-	deltaSamples = currentCounter - previousCounter;
+	double latencySamples = wakeLatency->Update(sample, hostTicks);
+	currentCounter = hostTicks;
+	deltaSamples = (long)(currentCounter - previousCounter);
 	previousCounter = currentCounter;
 
 	deltaTime = (double)( deltaSamples * (double)(1/(double)cpuFreq)) * MS_PER_SECOND;
@@ -113,8 +135,11 @@ void PrintTimingInfo()
 		{
 		  minTime = deltaTime;
 		}
-		printf("IRQ %ld: %3.3lf ms  Min: %3.3lf  Max: %3.3lf \r", iterations, deltaTime, minTime, maxTime );
+		cycleLog.Log("IRQ %ld: %3.3lf ms  Min: %3.3lf  Max: %3.3lf \r", iterations, deltaTime, minTime, maxTime );
+		periodHistogram.Record((uint64_t)(deltaTime * NS_PER_MS));
+		wakeLatencyHistogram.Record((uint64_t)(latencySamples * nsPerSample));
 	}
+	return latencySamples * nsPerSample;
 }
 
 
@@ -127,29 +152,12 @@ void SetupCustom97()
 	controller->Custom97WaitTimeSet(FIRMWARE_WAIT_TIME);
 	controller->OS->Sleep(1); // wait a millisecond (multiple samples) for this to take effect
 
-	// setup read Ptrs
-	controller->Custom97ReadPtrSet(0, ENCODER_X_ADDR);   // from VM3
-	controller->Custom97ReadPtrSet(1, ENCODER_Y_ADDR);   // from VM3
-	controller->Custom97ReadPtrSet(2, ENCODER_Z_ADDR);   
-    
-	// once the read count > 0, the feature is enabled  (must have Ptrs setup already)
-	controller->Custom97ReadCountSet(DATA_READ_COUNT);
-
-    // setup write Ptrs
-	controller->Custom97WritePtrSet(0, TORQUE_X_ADDR);  // will write to torque outputs(ZMP)
-    controller->Custom97WritePtrSet(1, TORQUE_Y_ADDR); 
-    controller->Custom97WritePtrSet(2, TORQUE_Z_ADDR);  
-
-	// once the write count > 0, the feature is enabled
-    printf("Setting Write count");
-    controller->Custom97WriteCountSet(DATA_WRITE_COUNT);
-
-	// initialize our data structures
-	readData = new ReadData;
-	writeData = new WriteData;
-
-	readSize = sizeof(ReadData);
-	writeSize = sizeof(WriteData);
+	// setup read Ptrs, then the read count -- once the read count > 0, the feature is enabled
+	ReadData::ReadPointersRegister(controller);
+
+	// setup write Ptrs, then the write count -- once the write count > 0, the feature is enabled
+	printf("Setting Write count");
+	WriteData::WritePointersRegister(controller);
 }
 
 
@@ -158,14 +166,47 @@ void DisableCustom97()
 	// disable reading and writing
 	controller->Custom97ReadCountSet(0);
 	controller->Custom97WriteCountSet(0);
+}
+
+
+// Your real-time calculations here -- the live loop and the replay both call this, so keep any other input out of it
+void CycleCompute(const ReadData &inputs, WriteData &outputs)
+{
+	// create some dummy data
+	outputs.Set<TorqueX>(0);
+	outputs.Set<TorqueY>(1);
+	outputs.Set<TorqueZ>(2);
+}
+
 
-	delete readData;
-	delete writeData;
+// run a recording through CycleCompute() as fast as possible and compare the write buffers with the recorded ones -- needs no controller
+void Custom97Replay(const char *path)
+{
+	SampleAppsCPP::CycleReplay replay;
+	if(!replay.Load(path))
+	{
+		printf("%s: %s\n", path, replay.ErrorGet());
+		return;
+	}
+	WriteData outputs;
+	SampleAppsCPP::CycleReplayResult result = replay.Run<ReadData, int32_t>([&](int32 sample, const ReadData &inputs, int32_t *writeBuffer)
+	{
+		(void)sample;
+		CycleCompute(inputs, outputs);
+		memcpy(writeBuffer, outputs.DataGet(), WriteData::BYTES);			// Run() compares it with the recorded write buffer afterwards
+	}, 0.0);
+	replay.Print(stdout, result);
 }
 
 
 void custom97Main()
 {
+	if(REPLAY_PATH != NULL)
+	{
+		Custom97Replay(REPLAY_PATH);
+		return;
+	}
+
 	try
 	{
 		// create and initialize MotionController class (PCI board)
@@ -182,7 +223,21 @@ void custom97Main()
 		printf("CPU Frequency is: %u Hz\n", cpuFreq);
 
 		// See how much total time is available for Sync interrupt processing (before SynqNet buffer is DMA'd)
-		printf("Host will have %ld microseconds to process data.\n", controller->SyncInterruptHostProcessTimeGet() );
+		hostProcessTime = controller->SyncInterruptHostProcessTimeGet();
+		printf("Host will have %ld microseconds to process data.\n", hostProcessTime );
+
+		// wake-up latency from the sample counter and the host timer
+		wakeLatency = new SampleAppsCPP::WakeLatencyEstimator((double)cpuFreq / controller->SampleRateGet());
+		nsPerSample = NS_PER_MS * MS_PER_SECOND / controller->SampleRateGet();
+
+		// time each phase of the cycle against the host process time
+		profiler = new SampleAppsCPP::PhaseProfiler(phaseNames, PHASE_COUNT, cpuFreq, hostProcessTime, PROFILE_WINDOW_CYCLES);
+
+		// allocated here, not in the loop
+		recorder = new SampleAppsCPP::CycleRecorder(ReadData::BYTES, WriteData::BYTES, RECORD_PATH != NULL ? RECORD_MAX_CYCLES : 0);
+
+		cycleLog.Start(stdout);
+		profiler->Start();							// percentiles and resets of closed windows run on its thread, not in the loop
 
 		// configure a Sync interrupt for every sample
 		controller->SyncInterruptPeriodSet(SYNC_PERIOD);
@@ -194,34 +249,58 @@ void custom97Main()
 		while( controller->OS->KeyGet(RSIWaitPOLL) < 0)
 		{
 			// wait for the controller's Sync interrupt
-			controller->SyncInterruptWait();
+			int32 sample = controller->SyncInterruptWait();
+			uint64_t wakeTicks = hostTimer.Read(controller->OS);
 
 			// see if we exceeded our processing time during the previous interrupt
 			CheckHostProcessTimeStatus();
 
+			// did we sleep through any interrupts?  (register catch-up handlers for your integrators and filters with missedSamples.HandlerAdd())
+			int32 missedCycles = missedSamples.Update(sample, wakeTicks);
+			if(missedCycles > 0)
+			{
+				cycleLog.Log("\nMissed %d sync interrupt(s) before sample %d\n", missedCycles, sample);
+			}
+
 			// see how long it's been since last interrupt
-			PrintTimingInfo();
+			profiler->CycleBegin(wakeTicks, PrintTimingInfo(sample, wakeTicks));
 
 			// tell the controller firmware that we are going to do some calculations
 			controller->SyncInterruptHostProcessFlagSet(true);
+			profiler->PhaseEnd(hostTimer.Read(controller->OS));
 
 			// read SynqNet data from Custom97 read buffer
-			controller->Custom97ReadDataGet(readData, readSize);
+			controller->Custom97ReadDataGet(readData.DataGet(), ReadData::BYTES);
+			profiler->PhaseEnd(hostTimer.Read(controller->OS));
 	
 			//
-			// Your real-time calculations here
+			// Your real-time calculations here (in CycleCompute(), so a recording can replay them)
 			//
-
-			// create some dummy data
-			writeData->torqueX = 0;
-			writeData->torqueY = 1;
-			writeData->torqueZ = 2;
+			CycleCompute(readData, writeData);
+			if(RECORD_PATH != NULL)
+			{
+				recorder->Record(sample, readData.DataGet(), writeData.DataGet());
+			}
+			profiler->PhaseEnd(hostTimer.Read(controller->OS));
 
 			// write our datat to Custom97 write buffer
-			controller->Custom97WriteDataSet(writeData, writeSize);
+			controller->Custom97WriteDataSet(writeData.DataGet(), WriteData::BYTES);
+			profiler->PhaseEnd(hostTimer.Read(controller->OS));
 
 			// tell the controller firmware that we have finished our calculations
 			controller->SyncInterruptHostProcessFlagSet(false);
+			profiler->PhaseEnd(hostTimer.Read(controller->OS));
+
+			// name the phase that used up the budget, and queue the rolling table once per window
+			int overrunPhase = profiler->CycleEnd();
+			if(overrunPhase >= 0)
+			{
+				cycleLog.Log("\nOverrun in %s: %.1lf us used of %ld us\n", profiler->PhaseNameGet(overrunPhase), profiler->CycleMicrosecondsGet(), hostProcessTime);
+			}
+			if(profiler->IsWindowReadyGet())
+			{
+				profiler->WindowLog(cycleLog);
+			}
 
 			iterations++;  // used for printing info
 		}
@@ -231,6 +310,24 @@ void custom97Main()
 
 		// turn off Sync Interrupt
 		controller->SyncInterruptEnableSet(false);
+		cycleLog.Stop();
+		profiler->Stop();
+
+		// the whole distribution, not just min/max
+		periodHistogram.Print(stdout, "\nIRQ period", "us", 1000.0);
+		periodHistogram.BucketsPrint(stdout, 1000.0);
+		wakeLatencyHistogram.Print(stdout, "Wake-up latency", "us", 1000.0);
+		wakeLatencyHistogram.BucketsPrint(stdout, 1000.0);
+		profiler->Print(stdout);
+		missedSamples.Print(stdout, (double)cpuFreq);
+		if(RECORD_PATH != NULL)
+		{
+			printf("Recorded %lld cycles (%lld dropped) to %s: %s\n", (long long)recorder->FrameCountGet(), (long long)recorder->DroppedCountGet(),
+				RECORD_PATH, recorder->Save(RECORD_PATH, SYNC_PERIOD, controller->SampleRateGet()) ? "ok" : "FAILED");
+		}
+		delete recorder;
+		delete wakeLatency;
+		delete profiler;
 	}
 	catch (RsiError *err)
 	{
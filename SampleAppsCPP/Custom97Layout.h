@@ -0,0 +1,171 @@
+/*!
+*  @example    Custom97Layout.h
+
+*  @page       custom97-layout-cpp Custom97Layout.h
+
+*  @brief      Custom97 read/write buffers declared once as a list of (field, SynqNet address) types.
+
+*  @details
+Custom97.cpp describes each buffer three times: a struct with one member per value, a Custom97ReadPtrSet()/Custom97WritePtrSet() call per value,
+and a DATA_READ_COUNT/DATA_WRITE_COUNT define.  It also allocates both structs with new.
+
+Here each value is a type deriving from Custom97Field with its address, and a buffer is Custom97Layout of those types, in buffer order:
+@code
+    struct EncoderX : SampleAppsCPP::Custom97Field<0x1000180> {};
+    struct EncoderY : SampleAppsCPP::Custom97Field<0x1000220> {};
+    typedef SampleAppsCPP::Custom97Layout<EncoderX, EncoderY> ReadData;
+
+    ReadData readData;                                          // static storage, cache-line aligned
+    ReadData::ReadPointersRegister(controller);                 // every Custom97ReadPtrSet(), then Custom97ReadCountSet()
+    controller->Custom97ReadDataGet(readData.DataGet(), ReadData::BYTES);
+    int32_t x = readData.Get<EncoderX>();
+@endcode
+The 64 value limit and unique fields are checked at compile time, and Get()/Set() of a field that is not in the layout does not compile.
+Adding a value is one field type and one entry in the list.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include Custom97Layout.h
+
+*/
+#ifndef CPP_CUSTOM97_LAYOUT
+#define CPP_CUSTOM97_LAYOUT
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace SampleAppsCPP
+{
+    const int CUSTOM97_MAX_VALUES = 64;                     // 32-bit values per Custom97 buffer
+    const int CUSTOM97_ALIGNMENT = 64;                      // one cache line
+
+    /// <summary>
+    /// One 32-bit value of a Custom97 buffer.  Derive a named type from it for each value.
+    /// </summary>
+    /// <typeparam name="ADDRESS">SynqNet buffer address of the value (from VM3).</typeparam>
+    /// <typeparam name="T">int32_t, uint32_t or float.</typeparam>
+    template <uint64_t ADDRESS, class T = int32_t>
+    struct Custom97Field
+    {
+        static_assert(sizeof(T) == 4, "Custom97 values are 32 bits.");
+        static const uint64_t address = ADDRESS;
+        typedef T Type;
+    };
+
+    namespace Custom97LayoutDetail
+    {
+        // Position of Field in Fields..., or -1.
+        template <class Field, class... Fields>
+        struct IndexOf;
+
+        template <class Field>
+        struct IndexOf<Field> { static const int value = -1; };
+
+        template <class Field, class... Rest>
+        struct IndexOf<Field, Field, Rest...> { static const int value = 0; };
+
+        template <class Field, class First, class... Rest>
+        struct IndexOf<Field, First, Rest...>
+        {
+            static const int value = IndexOf<Field, Rest...>::value < 0 ? -1 : IndexOf<Field, Rest...>::value + 1;
+        };
+
+        // True if no type appears twice in Fields...
+        template <class... Fields>
+        struct AllUnique { static const bool value = true; };
+
+        template <class First, class... Rest>
+        struct AllUnique<First, Rest...>
+        {
+            static const bool value = IndexOf<First, Rest...>::value < 0 && AllUnique<Rest...>::value;
+        };
+    }
+
+    /// <summary>
+    /// A Custom97 read or write buffer with one 32-bit word per field, in the order given.  Use one instance per buffer, with static storage.
+    /// </summary>
+    template <class... Fields>
+    class Custom97Layout
+    {
+        static_assert(sizeof...(Fields) >= 1, "A Custom97 layout needs at least one field.");
+        static_assert(sizeof...(Fields) <= CUSTOM97_MAX_VALUES, "A Custom97 buffer holds at most 64 values.");
+        static_assert(Custom97LayoutDetail::AllUnique<Fields...>::value, "A field appears twice in the Custom97 layout.");
+
+    public:
+        static const int COUNT = sizeof...(Fields);
+        static const int BYTES = COUNT * 4;
+
+        Custom97Layout() { memset(words, 0, sizeof(words)); }
+
+        /// <summary>
+        /// Set every read pointer in layout order, then the read count, which enables the reads.
+        /// </summary>
+        template <class ControllerT>
+        static void ReadPointersRegister(ControllerT *controller)
+        {
+            const uint64_t addresses[COUNT] = { Fields::address... };
+            for (int i = 0; i < COUNT; i++)
+            {
+                controller->Custom97ReadPtrSet(i, addresses[i]);
+            }
+            controller->Custom97ReadCountSet(COUNT);
+        }
+
+        /// <summary>
+        /// Set every write pointer in layout order, then the write count, which enables the writes.
+        /// </summary>
+        template <class ControllerT>
+        static void WritePointersRegister(ControllerT *controller)
+        {
+            const uint64_t addresses[COUNT] = { Fields::address... };
+            for (int i = 0; i < COUNT; i++)
+            {
+                controller->Custom97WritePtrSet(i, addresses[i]);
+            }
+            controller->Custom97WriteCountSet(COUNT);
+        }
+
+        /// <summary>
+        /// Buffer position of a field.
+        /// </summary>
+        template <class Field>
+        static constexpr int IndexGet()
+        {
+            static_assert(Custom97LayoutDetail::IndexOf<Field, Fields...>::value >= 0, "The field is not in this Custom97 layout.");
+            return Custom97LayoutDetail::IndexOf<Field, Fields...>::value;
+        }
+
+        template <class Field>
+        typename Field::Type Get() const
+        {
+            typename Field::Type value;
+            memcpy(&value, &words[IndexGet<Field>()], sizeof(value));
+            return value;
+        }
+
+        template <class Field>
+        void Set(typename Field::Type value)
+        {
+            memcpy(&words[IndexGet<Field>()], &value, sizeof(value));
+        }
+
+        /// <summary>
+        /// The buffer to pass to Custom97ReadDataGet()/Custom97WriteDataSet() with BYTES.
+        /// </summary>
+        void* DataGet() { return words; }
+
+    private:
+        alignas(CUSTOM97_ALIGNMENT) uint32_t words[COUNT];
+    };
+}
+#endif
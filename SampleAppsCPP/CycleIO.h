@@ -0,0 +1,193 @@
+/*!
+*  @example    CycleIO.h
+
+*  @page       cycle-io-cpp CycleIO.h
+
+*  @brief      Resolve controller addresses once, then read all cycle inputs and write all cycle outputs in as few memory transfers as possible.
+
+*  @details
+SyncInterrupt.cpp calls EncoderPositionGet() and FilterCoeffSet() once per axis every cycle.  Each is a separate library round trip,
+so the host time grows with the axis count.
+
+CycleIO takes the controller addresses of the values the cycle needs (from Axis::AddressGet(), as in Memory.cpp and Gantry.cpp) once, before the loop.
+Build() sorts them and coalesces neighbours into runs:
+<ul>
+<li>Reads closer together than maxReadGapBytes are fetched in one MemoryBlockGet(), along with the bytes between them.
+Per-axis fields sit at a fixed stride, so with maxReadGapBytes at least the stride every axis comes back in a single transfer.</li>
+<li>Writes are only merged when they are exactly contiguous, because writing the gap would overwrite controller memory with stale values.</li>
+</ul>
+Snapshot() then makes one MemoryBlockGet() per read run into a host-side buffer, the cycle reads and writes that buffer, and Commit() makes one MemoryBlockSet() per write run.
+
+The memory object is a template parameter: MotionController with RapidCode, or SimulatedControllerMemory (MotionControllerStandIn.h) for CycleIOBenchmark.cpp.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include CycleIO.h
+
+*/
+#ifndef CPP_CYCLE_IO
+#define CPP_CYCLE_IO
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace SampleAppsCPP
+{
+    class CycleIO
+    {
+    public:
+        /// <param name="maxReadGapBytes">Read the bytes between two values rather than make another transfer when they are at most this far apart.</param>
+        explicit CycleIO(int32_t maxReadGapBytes = 0) : maxReadGap(maxReadGapBytes < 0 ? 0 : maxReadGapBytes), built(false) {}
+
+        /// <summary>
+        /// Add a value to read every cycle.  Returns its channel for ReadGet().  Call Build() after the last one.
+        /// </summary>
+        int32_t ReadAdd(uint64_t address, int32_t size) { return ChannelAdd(reads, address, size); }
+
+        /// <summary>
+        /// Add a value to write every cycle.  Returns its channel for WriteSet().  Call Build() after the last one.
+        /// </summary>
+        int32_t WriteAdd(uint64_t address, int32_t size) { return ChannelAdd(writes, address, size); }
+
+        /// <summary>
+        /// Coalesce the channels into transfers.  Allocates, so call it before the loop.
+        /// </summary>
+        void Build()
+        {
+            RunsBuild(reads, readRuns, readBuffer, maxReadGap);
+            RunsBuild(writes, writeRuns, writeBuffer, 0);
+            built = true;
+        }
+
+        /// <summary>
+        /// Read every input from the controller: one MemoryBlockGet() per read run.
+        /// </summary>
+        template <class MemoryT>
+        void Snapshot(MemoryT *memory)
+        {
+            for (size_t i = 0; i < readRuns.size(); i++)
+            {
+                memory->MemoryBlockGet(readRuns[i].address, &readBuffer[readRuns[i].offset], readRuns[i].size);
+            }
+        }
+
+        /// <summary>
+        /// Write every output to the controller: one MemoryBlockSet() per write run.
+        /// </summary>
+        template <class MemoryT>
+        void Commit(MemoryT *memory)
+        {
+            for (size_t i = 0; i < writeRuns.size(); i++)
+            {
+                memory->MemoryBlockSet(writeRuns[i].address, &writeBuffer[writeRuns[i].offset], writeRuns[i].size);
+            }
+        }
+
+        /// <summary>
+        /// Value of a read channel from the last Snapshot().  T must match the size given to ReadAdd().
+        /// </summary>
+        template <class T>
+        T ReadGet(int32_t channel) const
+        {
+            T value;
+            memcpy(&value, &readBuffer[reads[channel].offset], sizeof(T));
+            return value;
+        }
+
+        /// <summary>
+        /// Stage a value for the next Commit().  Outputs keep their last staged value, so set them before the first Commit().
+        /// </summary>
+        template <class T>
+        void WriteSet(int32_t channel, T value)
+        {
+            memcpy(&writeBuffer[writes[channel].offset], &value, sizeof(T));
+        }
+
+        double  ReadDoubleGet(int32_t channel) const { return ReadGet<double>(channel); }
+        void    WriteDoubleSet(int32_t channel, double value) { WriteSet<double>(channel, value); }
+
+        int32_t ReadRunCountGet() const { return (int32_t)readRuns.size(); }
+        int32_t WriteRunCountGet() const { return (int32_t)writeRuns.size(); }
+        int32_t ReadBytesGet() const { return (int32_t)readBuffer.size(); }
+        int32_t WriteBytesGet() const { return (int32_t)writeBuffer.size(); }
+        bool    IsBuiltGet() const { return built; }
+
+    private:
+        struct Channel
+        {
+            uint64_t    address;
+            int32_t     size;
+            int32_t     offset;                     // in the host buffer, set by Build()
+        };
+
+        struct Run
+        {
+            uint64_t    address;
+            int32_t     size;
+            int32_t     offset;
+        };
+
+        static int32_t ChannelAdd(std::vector<Channel>& channels, uint64_t address, int32_t size)
+        {
+            Channel channel = { address, size, 0 };
+            channels.push_back(channel);
+            return (int32_t)channels.size() - 1;
+        }
+
+        static void RunsBuild(std::vector<Channel>& channels, std::vector<Run>& runs, std::vector<unsigned char>& buffer, int32_t maxGap)
+        {
+            std::vector<int32_t> order(channels.size());
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                order[i] = (int32_t)i;
+            }
+            std::sort(order.begin(), order.end(), [&channels](int32_t a, int32_t b) { return channels[a].address < channels[b].address; });
+
+            runs.clear();
+            int32_t bytes = 0;
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                Channel& channel = channels[order[i]];
+                const uint64_t end = channel.address + channel.size;
+                if (!runs.empty() && channel.address <= runs.back().address + runs.back().size + maxGap)
+                {
+                    Run& run = runs.back();
+                    if (end > run.address + run.size)
+                    {
+                        bytes += (int32_t)(end - (run.address + run.size));
+                        run.size = (int32_t)(end - run.address);
+                    }
+                }
+                else
+                {
+                    Run run = { channel.address, channel.size, bytes };
+                    runs.push_back(run);
+                    bytes += channel.size;
+                }
+                channel.offset = runs.back().offset + (int32_t)(channel.address - runs.back().address);
+            }
+            buffer.assign(bytes, 0);
+        }
+
+        int32_t                     maxReadGap;
+        bool                        built;
+        std::vector<Channel>        reads;
+        std::vector<Channel>        writes;
+        std::vector<Run>            readRuns;
+        std::vector<Run>            writeRuns;
+        std::vector<unsigned char>  readBuffer;
+        std::vector<unsigned char>  writeBuffer;
+    };
+}
+#endif
@@ -0,0 +1,232 @@
+/*!
+@example    CycleIOBenchmark.cpp
+
+*  @page       cycle-io-benchmark-cpp CycleIOBenchmark.cpp
+
+*  @brief      Host time per sync cycle for per-axis reads and writes vs CycleIO bulk transfers, at 6, 32 and 64 axes.
+
+*  @details
+Each cycle reads one double of feedback and writes one double of output per axis, the way SyncInterrupt.cpp reads encoder positions and writes torques.
+Three ways of doing it are timed, per cycle:
+
+- per-axis calls: one MemoryDoubleGet() and one MemoryDoubleSet() per axis,
+- CycleIO with axis-strided fields: one MemoryBlockGet() spanning every axis (maxReadGapBytes = AXIS_STRIDE_BYTES), one MemoryBlockSet() per axis,
+- CycleIO with packed fields: one MemoryBlockGet() and one MemoryBlockSet() for all axes.
+
+The sweep runs against SimulatedControllerMemory (MotionControllerStandIn.h) with CALL_OVERHEAD_US per call and BYTE_OVERHEAD_NS per byte.
+Those are guesses; calibrate them from a hardware run.  The per-byte cost is what limits the strided bulk read, which also moves the bytes between axes.
+Build with SAMPLEAPPS_NO_RAPIDCODE defined to leave out rsi.h.  Without it, set RUN_ON_CONTROLLER to also time EncoderPositionGet() per axis
+against a CycleIO snapshot of ACTUAL_POSITION on a real controller (reads only, so nothing is written to the drives).
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include CycleIOBenchmark.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#endif
+#include "CycleIO.h"                                // Import the bulk cycle I/O layer.
+#include "MotionControllerStandIn.h"                // Import the software stand-in for controller memory.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int       AXIS_COUNTS[] = { 6, 32, 64 };
+    const int       MAX_AXES = 64;
+    const int       AXIS_STRIDE_BYTES = 256;                            // distance between two axes' copies of a field in the stand-in
+    const int       FEEDBACK_OFFSET = 0;                                // feedback field within an axis
+    const int       OUTPUT_OFFSET = 128;                                // output field within an axis
+    const int       PACKED_BASE = MAX_AXES * AXIS_STRIDE_BYTES;         // packed feedback, then packed outputs
+    const double    CALL_OVERHEAD_US = 1.0;                             // per memory call
+    const double    BYTE_OVERHEAD_NS = 0.5;                             // per byte moved
+    const int       CYCLES = 2000;                                      // cycles timed per combination
+    const bool      RUN_ON_CONTROLLER = false;                          // set true to also time reads on a real controller
+
+    struct CycleStats
+    {
+        double p50Us;
+        double p99Us;
+        double maxUs;
+    };
+
+    CycleStats Summarize(std::vector<double>& cycleUs)
+    {
+        CycleStats stats;
+        std::sort(cycleUs.begin(), cycleUs.end());
+        stats.p50Us = cycleUs[cycleUs.size() / 2];
+        stats.p99Us = cycleUs[(cycleUs.size() * 99) / 100];
+        stats.maxUs = cycleUs.back();
+        return stats;
+    }
+
+    // Time CYCLES calls of cycle(), which does one full read-compute-write pass.
+    template <class CycleFn>
+    CycleStats CyclesTime(CycleFn cycle)
+    {
+        std::vector<double> cycleUs(CYCLES);
+        for (int i = 0; i < CYCLES; i++)
+        {
+            Clock::time_point start = Clock::now();
+            cycle();
+            cycleUs[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+        return Summarize(cycleUs);
+    }
+
+    uint64_t StridedAddressGet(int axis, int field) { return SampleAppsCPP::SimulatedControllerMemory::BASE_ADDRESS + axis * AXIS_STRIDE_BYTES + field; }
+    uint64_t PackedAddressGet(int axis, int field)
+    {
+        return SampleAppsCPP::SimulatedControllerMemory::BASE_ADDRESS + PACKED_BASE + (field == OUTPUT_OFFSET ? MAX_AXES : 0) * sizeof(double) + axis * sizeof(double);
+    }
+
+    void StandInSweep()
+    {
+        SampleAppsCPP::SimulatedControllerMemory memory(PACKED_BASE + 2 * MAX_AXES * sizeof(double), CALL_OVERHEAD_US, BYTE_OVERHEAD_NS);
+        double feedback[MAX_AXES];
+        double outputs[MAX_AXES];
+
+        printf("\nSoftware stand-in: %.2lf us per call, %.2lf ns per byte, %d cycles per combination\n", CALL_OVERHEAD_US, BYTE_OVERHEAD_NS, CYCLES);
+        printf("%5s %-22s | %6s %7s | %9s %9s %9s\n", "axes", "method", "calls", "bytes", "p50 us", "p99 us", "max us");
+        for (size_t axisIndex = 0; axisIndex < sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]); axisIndex++)
+        {
+            const int axisCount = AXIS_COUNTS[axisIndex];
+
+            // one round trip per value, like EncoderPositionGet() and FilterCoeffSet()
+            int64_t calls = memory.CallCountGet();
+            int64_t bytes = memory.BytesTransferredGet();
+            CycleStats stats = CyclesTime([&]()
+            {
+                for (int i = 0; i < axisCount; i++)
+                {
+                    feedback[i] = memory.MemoryDoubleGet(StridedAddressGet(i, FEEDBACK_OFFSET));
+                }
+                for (int i = 0; i < axisCount; i++)
+                {
+                    memory.MemoryDoubleSet(StridedAddressGet(i, OUTPUT_OFFSET), -0.5 * feedback[i]);
+                }
+            });
+            printf("%5d %-22s | %6lld %7lld | %9.2f %9.2f %9.2f\n", axisCount, "per-axis calls",
+                (long long)((memory.CallCountGet() - calls) / CYCLES), (long long)((memory.BytesTransferredGet() - bytes) / CYCLES), stats.p50Us, stats.p99Us, stats.maxUs);
+
+            // the same fields through CycleIO: one read spans every axis, the writes are still one per axis
+            for (int packed = 0; packed <= 1; packed++)
+            {
+                SampleAppsCPP::CycleIO io(packed ? 0 : AXIS_STRIDE_BYTES);
+                int feedbackChannels[MAX_AXES];
+                int outputChannels[MAX_AXES];
+                for (int i = 0; i < axisCount; i++)
+                {
+                    feedbackChannels[i] = io.ReadAdd(packed ? PackedAddressGet(i, FEEDBACK_OFFSET) : StridedAddressGet(i, FEEDBACK_OFFSET), sizeof(double));
+                    outputChannels[i] = io.WriteAdd(packed ? PackedAddressGet(i, OUTPUT_OFFSET) : StridedAddressGet(i, OUTPUT_OFFSET), sizeof(double));
+                }
+                io.Build();
+
+                calls = memory.CallCountGet();
+                bytes = memory.BytesTransferredGet();
+                stats = CyclesTime([&]()
+                {
+                    io.Snapshot(&memory);
+                    for (int i = 0; i < axisCount; i++)
+                    {
+                        outputs[i] = -0.5 * io.ReadDoubleGet(feedbackChannels[i]);
+                        io.WriteDoubleSet(outputChannels[i], outputs[i]);
+                    }
+                    io.Commit(&memory);
+                });
+                printf("%5d %-22s | %6lld %7lld | %9.2f %9.2f %9.2f\n", axisCount, packed ? "CycleIO, packed" : "CycleIO, axis-strided",
+                    (long long)((memory.CallCountGet() - calls) / CYCLES), (long long)((memory.BytesTransferredGet() - bytes) / CYCLES), stats.p50Us, stats.p99Us, stats.maxUs);
+            }
+        }
+    }
+
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    using namespace RSI::RapidCode;
+
+    // EncoderPositionGet() per axis vs one CycleIO snapshot of every axis's ACTUAL_POSITION.  Reads only.
+    void ControllerSweep(MotionController *controller)
+    {
+        Axis *axes[MAX_AXES];
+        controller->AxisCountSet(MAX_AXES);                 // phantom axes are created for any axis not on the network
+        for (int i = 0; i < MAX_AXES; i++)
+        {
+            axes[i] = controller->AxisGet(i);
+            SampleAppsCPP::HelperFunctions::CheckErrors(axes[i]);
+        }
+
+        printf("\nController: %d cycles per combination, reads only\n", CYCLES);
+        printf("%5s %-22s | %6s %7s | %9s %9s %9s\n", "axes", "method", "calls", "bytes", "p50 us", "p99 us", "max us");
+        for (size_t axisIndex = 0; axisIndex < sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]); axisIndex++)
+        {
+            const int axisCount = AXIS_COUNTS[axisIndex];
+            double feedback[MAX_AXES];
+
+            CycleStats stats = CyclesTime([&]()
+            {
+                for (int i = 0; i < axisCount; i++)
+                {
+                    feedback[i] = axes[i]->EncoderPositionGet(RSIMotorFeedbackPRIMARY);
+                }
+            });
+            printf("%5d %-22s | %6d %7d | %9.2f %9.2f %9.2f\n", axisCount, "EncoderPositionGet()", axisCount, (int)(axisCount * sizeof(double)), stats.p50Us, stats.p99Us, stats.maxUs);
+
+            // the read gap covers one axis's memory, whatever its size on this firmware
+            const uint64_t stride = axisCount > 1 ? axes[1]->AddressGet(RSIAxisAddressTypeACTUAL_POSITION) - axes[0]->AddressGet(RSIAxisAddressTypeACTUAL_POSITION) : 0;
+            SampleAppsCPP::CycleIO io((int32_t)stride);
+            int channels[MAX_AXES];
+            for (int i = 0; i < axisCount; i++)
+            {
+                channels[i] = io.ReadAdd(axes[i]->AddressGet(RSIAxisAddressTypeACTUAL_POSITION), sizeof(double));
+            }
+            io.Build();
+            stats = CyclesTime([&]()
+            {
+                io.Snapshot(controller);
+                for (int i = 0; i < axisCount; i++)
+                {
+                    feedback[i] = io.ReadDoubleGet(channels[i]);
+                }
+            });
+            printf("%5d %-22s | %6d %7d | %9.2f %9.2f %9.2f\n", axisCount, "CycleIO snapshot", io.ReadRunCountGet(), io.ReadBytesGet(), stats.p50Us, stats.p99Us, stats.maxUs);
+        }
+    }
+#endif
+}
+
+void cycleIOBenchmarkMain()
+{
+    StandInSweep();
+
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    if (RUN_ON_CONTROLLER)
+    {
+        MotionController *controller = MotionController::CreateFromSoftware();
+        SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+        try
+        {
+            SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+            ControllerSweep(controller);
+        }
+        catch (RsiError const& err)
+        {
+            printf("\n%s\n", err.text);
+        }
+        controller->Delete();                               // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+    }
+#endif
+}
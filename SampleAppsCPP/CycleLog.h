@@ -0,0 +1,233 @@
+/*!
+*  @example    CycleLog.h
+
+*  @page       cycle-log-cpp CycleLog.h
+
+*  @brief      Asynchronous binary log for sync interrupt loops: the cycle stores a fixed-size record, a background thread formats and flushes it.
+
+*  @details
+SyncInterrupt.cpp, Custom97.cpp and UpdateBufferPoints.cpp call printf() inside their SyncInterruptWait() loops.
+A console write can block for milliseconds, which alone is enough to miss the host process time.
+
+CycleLog::Log() takes a printf format and up to MAX_ARGS scalar arguments and copies them, unformatted, into a 64 byte record
+in a StreamingPointRing (StreamingPointRing.h).  No locks, no allocations and no system calls: a few stores and a release.
+The record also holds a pointer to a formatter instantiated for the argument types, so the flush thread can call fprintf() later
+with exactly the arguments it was given.  When the ring is full the record is dropped and counted rather than blocking the cycle.
+
+The format string and any const char* arguments are stored as pointers, so they must be string literals or otherwise outlive the flush.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include CycleLog.h
+
+*/
+#ifndef CPP_CYCLE_LOG
+#define CPP_CYCLE_LOG
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "StreamingPointRing.h"                     // Import the lock-free single-producer/single-consumer ring.
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// One unformatted log call.  Every argument takes an 8 byte slot.
+    /// </summary>
+    struct CycleLogRecord
+    {
+        static const int MAX_ARGS = 6;
+        static const int SLOT_BYTES = 8;
+
+        void        (*formatter)(FILE *out, const char *format, const unsigned char *args);
+        const char  *format;
+        alignas(SLOT_BYTES) unsigned char args[MAX_ARGS * SLOT_BYTES];
+    };
+
+    /// <summary>
+    /// Lock-free log for one producer thread (the sync loop).
+    /// </summary>
+    /// <typeparam name="RECORD_COUNT">Records the ring holds before Log() starts dropping.  Must be a power of two.</typeparam>
+    /// @code
+    ///     static SampleAppsCPP::CycleLog<4096> cycleLog;         // 256 KB, keep it off the stack
+    ///     cycleLog.Start(stdout);                                 // before CyclicExecutor::Configure(), see Start()
+    ///     while (...)
+    ///     {
+    ///         controller->SyncInterruptWait();
+    ///         cycleLog.Log("IRQ %ld: %3.3lf ms\n", iterations, deltaTime);
+    ///     }
+    ///     cycleLog.Stop();                                        // flushes everything still queued
+    /// @endcode
+    template <int RECORD_COUNT>
+    class CycleLog
+    {
+    public:
+        CycleLog() : out(nullptr), flushPeriodMs(10), stopRequested(false), dropped(0), droppedReported(0), written(0) {}
+        ~CycleLog() { Stop(); }
+
+        /// <summary>
+        /// Start the flush thread.
+        /// New threads inherit the scheduling policy, priority and CPU affinity of the thread that creates them,
+        /// so call this before the sync thread raises its own priority (CyclicExecutor::Configure()), or the flush thread will compete with it.
+        /// </summary>
+        /// <param name="output">Where the records are written.</param>
+        /// <param name="flushPeriodMilliseconds">How long the flush thread sleeps when the ring is empty.</param>
+        void Start(FILE *output, int flushPeriodMilliseconds = 10)
+        {
+            if (flushThread.joinable())
+            {
+                return;
+            }
+            out = output;
+            flushPeriodMs = flushPeriodMilliseconds;
+            stopRequested.store(false);
+            flushThread = std::thread([this]() { FlushLoop(); });
+        }
+
+        /// <summary>
+        /// Stop the flush thread after it has written every queued record.
+        /// </summary>
+        void Stop()
+        {
+            if (!flushThread.joinable())
+            {
+                return;
+            }
+            stopRequested.store(true);
+            flushThread.join();
+            Drain();
+        }
+
+        /// <summary>
+        /// Queue one printf-style line.  Real-time safe.  Returns false if the ring was full and the record was dropped.
+        /// Arguments must be arithmetic types or pointers (at most 8 bytes each); they are formatted as given, so match the format like printf.
+        /// </summary>
+        template <class... Args>
+        bool Log(const char *format, Args... args)
+        {
+            static_assert(sizeof...(Args) <= CycleLogRecord::MAX_ARGS, "Too many arguments for one CycleLog record.");
+            CycleLogRecord *record = ring.ProducerBlockGet();
+            if (record == nullptr)
+            {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            record->formatter = &Format<Args...>;
+            record->format = format;
+            ArgsStore(record->args, args...);
+            ring.ProducerBlockCommit();
+            return true;
+        }
+
+        /// <summary>
+        /// Format and write everything queued so far.  The flush thread calls this; without Start() call it yourself outside the cycle.
+        /// Returns the number of records written.
+        /// </summary>
+        int32_t Drain()
+        {
+            int32_t count = 0;
+            CycleLogRecord *record;
+            while ((record = ring.ConsumerBlockGet()) != nullptr)
+            {
+                if (out != nullptr)
+                {
+                    record->formatter(out, record->format, record->args);
+                }
+                ring.ConsumerBlockRelease();
+                ++count;
+            }
+
+            const int64_t droppedNow = dropped.load(std::memory_order_relaxed);
+            if (droppedNow != droppedReported && out != nullptr)
+            {
+                fprintf(out, "[CycleLog: %lld records dropped, the flush thread is falling behind]\n", (long long)(droppedNow - droppedReported));
+                droppedReported = droppedNow;
+            }
+            if (count > 0 && out != nullptr)
+            {
+                fflush(out);
+            }
+            written += count;
+            return count;
+        }
+
+        int64_t DroppedCountGet() const { return dropped.load(std::memory_order_relaxed); }
+
+        /// <summary>
+        /// Records written so far.  Only meaningful on the thread that drains (or after Stop()).
+        /// </summary>
+        int64_t WrittenCountGet() const { return written; }
+
+        int32_t QueuedCountGet() const { return ring.CountGet(); }
+
+    private:
+        static const int SLOT_BYTES = CycleLogRecord::SLOT_BYTES;
+
+        static void ArgsStore(unsigned char *) {}
+
+        template <class T, class... Rest>
+        static void ArgsStore(unsigned char *slot, T value, Rest... rest)
+        {
+            static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value, "CycleLog arguments must be numbers or pointers.");
+            static_assert(sizeof(T) <= SLOT_BYTES, "CycleLog arguments must fit in 8 bytes.");
+            memcpy(slot, &value, sizeof(T));
+            ArgsStore(slot + SLOT_BYTES, rest...);
+        }
+
+        template <class T>
+        static T ArgGet(const unsigned char *args, size_t index)
+        {
+            T value;
+            memcpy(&value, args + index * SLOT_BYTES, sizeof(T));
+            return value;
+        }
+
+        template <class... Args, size_t... Index>
+        static void FormatIndexed(FILE *out, const char *format, const unsigned char *args, std::index_sequence<Index...>)
+        {
+            (void)args;                                     // unused when there are no arguments
+            fprintf(out, format, ArgGet<Args>(args, Index)...);
+        }
+
+        template <class... Args>
+        static void Format(FILE *out, const char *format, const unsigned char *args)
+        {
+            FormatIndexed<Args...>(out, format, args, std::index_sequence_for<Args...>());
+        }
+
+        void FlushLoop()
+        {
+            while (!stopRequested.load())
+            {
+                if (Drain() == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(flushPeriodMs));
+                }
+            }
+        }
+
+        StreamingPointRing<CycleLogRecord, RECORD_COUNT> ring;
+        FILE                    *out;
+        int                     flushPeriodMs;
+        std::thread             flushThread;
+        std::atomic<bool>       stopRequested;
+        std::atomic<int64_t>    dropped;                // written by the producer only
+        int64_t                 droppedReported;        // consumer's last reported drop count
+        int64_t                 written;
+    };
+}
+#endif
@@ -0,0 +1,345 @@
+/*!
+*  @example    CycleRecorder.h
+
+*  @page       cycle-recorder-cpp CycleRecorder.h
+
+*  @brief      Record every sync cycle's inputs and outputs to a compact binary file, then replay the inputs through the same calculation offline.
+
+*  @details
+Profiling or changing the calculations in SyncInterrupt.cpp or Custom97.cpp normally needs the machine running.
+CycleRecorder captures what the calculation saw and produced each cycle, and CycleReplay feeds the inputs back through the same function
+as fast as the CPU allows.  Replay needs no controller, so the calculation can be profiled, compared against the recorded outputs after a change,
+and benchmarked faster than real time on any host.
+
+A recording holds one fixed-size frame per cycle after a 64-byte header:
+@code
+    offset 0                    CycleRecordingHeader (64 bytes)
+    64 + n * frameBytes         int32_t sample                      SyncInterruptWait() counter
+                                unsigned char inputs[inputBytes]    for example the Custom97 read buffer or the encoder positions
+                                unsigned char outputs[outputBytes]  what the calculation produced from them
+@endcode
+
+Record() only copies into frames allocated by the constructor, so it is real-time safe.  When maxFrames are full the rest are counted as dropped.
+Save() writes the file after the loop.
+
+CycleReplay::Run() loads nothing while it runs: the whole recording is read by Load().  Each frame's inputs are copied to the start of an aligned InputT,
+the calculation is called with the recorded sample counter, and its outputs are compared element by element with the recorded ones.
+Replay is only bit-exact when the calculation is deterministic: keep wall-clock time and other hidden inputs out of it, or record them as inputs.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include CycleRecorder.h
+
+*/
+#ifndef CPP_CYCLE_RECORDER
+#define CPP_CYCLE_RECORDER
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "LatencyHistogram.h"                       // Import the latency histogram.
+
+namespace SampleAppsCPP
+{
+    const char     CYCLE_RECORDING_MAGIC[8] = { 'R', 'S', 'I', 'C', 'Y', 'C', 'L', '1' };
+    const uint32_t CYCLE_RECORDING_VERSION = 1;
+
+    /// <summary>
+    /// On-disk header.  Little-endian, 64 bytes.
+    /// </summary>
+    struct CycleRecordingHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t inputBytes;
+        uint32_t outputBytes;
+        int32_t  syncPeriod;                                        // samples per cycle (SyncInterruptPeriodSet())
+        double   sampleRate;                                        // Hz (SampleRateGet())
+        uint64_t frameCount;
+        uint64_t droppedCount;                                      // cycles not recorded because the recorder was full
+        uint64_t reserved[2];
+    };
+    static_assert(sizeof(CycleRecordingHeader) == 64, "CycleRecordingHeader must stay 64 bytes.");
+
+    /// <summary>
+    /// Captures sample counter, inputs and outputs of each cycle in memory for Save().
+    /// </summary>
+    class CycleRecorder
+    {
+    public:
+        /// <param name="inputBytes">Size of the inputs passed to Record(), for example sizeof(your input struct).</param>
+        /// <param name="outputBytes">Size of the outputs passed to Record().</param>
+        /// <param name="maxFrames">Cycles to keep.  Allocated here, so the loop never allocates.</param>
+        CycleRecorder(int32_t inputBytes, int32_t outputBytes, int64_t maxFrames)
+            : inputBytes(inputBytes), outputBytes(outputBytes), frameBytes(sizeof(int32_t) + inputBytes + outputBytes),
+              maxFrames(maxFrames), frameCount(0), droppedCount(0), frames((size_t)(maxFrames * frameBytes))
+        {
+        }
+
+        /// <summary>
+        /// Copy one cycle.  Real-time safe.  Returns false and counts a dropped cycle once maxFrames are recorded.
+        /// </summary>
+        bool Record(int32_t sample, const void *inputs, const void *outputs)
+        {
+            if (frameCount >= maxFrames)
+            {
+                ++droppedCount;
+                return false;
+            }
+            unsigned char *frame = &frames[(size_t)(frameCount * frameBytes)];
+            memcpy(frame, &sample, sizeof(sample));
+            memcpy(frame + sizeof(sample), inputs, inputBytes);
+            memcpy(frame + sizeof(sample) + inputBytes, outputs, outputBytes);
+            ++frameCount;
+            return true;
+        }
+
+        /// <summary>
+        /// Forget the recorded cycles, keeping the allocation.
+        /// </summary>
+        void Clear()
+        {
+            frameCount = 0;
+            droppedCount = 0;
+        }
+
+        /// <summary>
+        /// Write the recorded cycles to path.  Not real-time safe: call it after the loop.  Returns false on a file error.
+        /// </summary>
+        /// <param name="syncPeriod">Samples per cycle, stored so a replay knows the recorded cycle time.</param>
+        /// <param name="sampleRate">Controller sample rate in Hz.</param>
+        bool Save(const char *path, int32_t syncPeriod, double sampleRate) const
+        {
+            CycleRecordingHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, CYCLE_RECORDING_MAGIC, sizeof(header.magic));
+            header.version = CYCLE_RECORDING_VERSION;
+            header.inputBytes = (uint32_t)inputBytes;
+            header.outputBytes = (uint32_t)outputBytes;
+            header.syncPeriod = syncPeriod;
+            header.sampleRate = sampleRate;
+            header.frameCount = (uint64_t)frameCount;
+            header.droppedCount = (uint64_t)droppedCount;
+
+            FILE *file = fopen(path, "wb");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+            ok = ok && fwrite(frames.data(), (size_t)frameBytes, (size_t)frameCount, file) == (size_t)frameCount;
+            ok = (fclose(file) == 0) && ok;
+            return ok;
+        }
+
+        int64_t FrameCountGet() const { return frameCount; }
+        int64_t DroppedCountGet() const { return droppedCount; }
+
+    private:
+        int32_t                     inputBytes;
+        int32_t                     outputBytes;
+        int32_t                     frameBytes;
+        int64_t                     maxFrames;
+        int64_t                     frameCount;
+        int64_t                     droppedCount;
+        std::vector<unsigned char>  frames;
+    };
+
+    struct CycleReplayResult
+    {
+        int64_t frames;                                             // frames replayed
+        int64_t mismatchedFrames;                                   // frames with any output further than the tolerance from the recording
+        int64_t firstMismatchFrame;                                 // -1 if none
+        int32_t firstMismatchOutput;                                // output element index in that frame
+        double  maxDifference;                                      // largest |replayed - recorded| over all outputs
+        double  wallSeconds;                                        // time spent in the calculation
+        double  recordedSeconds;                                    // real time the recording covered
+    };
+
+    /// <summary>
+    /// Reads a recording and runs its inputs through a calculation.  Holds the whole recording in memory.
+    /// </summary>
+    /// @code
+    ///     SampleAppsCPP::CycleReplay replay;
+    ///     if (!replay.Load("syncInterrupt.cycles")) { printf("%s\n", replay.ErrorGet()); }
+    ///     SampleAppsCPP::CycleReplayResult result = replay.Run<MyInputs, double>([&](int32_t sample, const MyInputs& in, double *out) { ... }, 0.0);
+    ///     replay.Print(stdout, result);
+    /// @endcode
+    class CycleReplay
+    {
+    public:
+        CycleReplay() : error("not loaded") { memset(&header, 0, sizeof(header)); }
+
+        /// <summary>
+        /// Read a recording.  Returns false (see ErrorGet()) if it cannot be read or is not a valid recording.
+        /// </summary>
+        bool Load(const char *path)
+        {
+            frames.clear();
+            error = "not loaded";
+            FILE *file = fopen(path, "rb");
+            if (file == nullptr)
+            {
+                error = "cannot open cycle recording";
+                return false;
+            }
+            const bool ok = LoadFrom(file);
+            fclose(file);
+            if (ok)
+            {
+                error = nullptr;
+            }
+            return ok;
+        }
+
+        const char* ErrorGet() const { return error; }              // nullptr if loaded
+        int64_t     FrameCountGet() const { return (int64_t)header.frameCount; }
+        int64_t     DroppedCountGet() const { return (int64_t)header.droppedCount; }
+        int32_t     InputBytesGet() const { return (int32_t)header.inputBytes; }
+        int32_t     OutputBytesGet() const { return (int32_t)header.outputBytes; }
+        int32_t     SyncPeriodGet() const { return header.syncPeriod; }
+        double      SampleRateGet() const { return header.sampleRate; }
+
+        /// <summary>
+        /// Run every frame through compute(sample, const InputT& inputs, OutputT *outputs) and compare the outputs with the recording.
+        /// The recording's inputs must fit in InputT (they are copied to its start) and its outputs be a whole number of OutputT; otherwise no frames run.
+        /// Each call's time goes into CycleTimesGet(), in ns.
+        /// </summary>
+        /// <param name="tolerance">Largest |replayed - recorded| that still counts as a match.  0 for bit-exact integer outputs.</param>
+        template <class InputT, class OutputT, class ComputeFn>
+        CycleReplayResult Run(ComputeFn compute, double tolerance)
+        {
+            typedef std::chrono::steady_clock Clock;
+            CycleReplayResult result;
+            memset(&result, 0, sizeof(result));
+            result.firstMismatchFrame = -1;
+            cycleTimes.Reset();
+            if (error != nullptr || header.inputBytes > sizeof(InputT) || header.outputBytes % sizeof(OutputT) != 0)
+            {
+                return result;
+            }
+
+            const size_t frameBytes = sizeof(int32_t) + header.inputBytes + header.outputBytes;
+            const int32_t outputCount = (int32_t)(header.outputBytes / sizeof(OutputT));
+            InputT inputs = InputT();
+            std::vector<OutputT> outputs(outputCount > 0 ? outputCount : 1);
+            std::vector<OutputT> recorded(outputCount > 0 ? outputCount : 1);
+            double wallNs = 0.0;
+            for (uint64_t f = 0; f < header.frameCount; f++)
+            {
+                const unsigned char *frame = &frames[(size_t)(f * frameBytes)];
+                int32_t sample;
+                memcpy(&sample, frame, sizeof(sample));
+                memcpy(&inputs, frame + sizeof(sample), header.inputBytes);
+                memcpy(recorded.data(), frame + sizeof(sample) + header.inputBytes, header.outputBytes);
+
+                const Clock::time_point start = Clock::now();
+                compute(sample, (const InputT&)inputs, outputs.data());
+                const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+                cycleTimes.Record((uint64_t)ns);
+                wallNs += ns;
+
+                bool mismatch = false;
+                for (int32_t i = 0; i < outputCount; i++)
+                {
+                    const double difference = std::fabs((double)outputs[i] - (double)recorded[i]);
+                    if (difference > result.maxDifference)
+                    {
+                        result.maxDifference = difference;
+                    }
+                    if (!(difference <= tolerance) && !mismatch)
+                    {
+                        mismatch = true;
+                        if (result.firstMismatchFrame < 0)
+                        {
+                            result.firstMismatchFrame = (int64_t)f;
+                            result.firstMismatchOutput = i;
+                        }
+                    }
+                }
+                result.mismatchedFrames += mismatch ? 1 : 0;
+                ++result.frames;
+            }
+            result.wallSeconds = wallNs * 1e-9;
+            result.recordedSeconds = header.sampleRate > 0.0 ? (double)header.frameCount * header.syncPeriod / header.sampleRate : 0.0;
+            return result;
+        }
+
+        /// <summary>
+        /// Per-cycle calculation times of the last Run(), in ns.
+        /// </summary>
+        const LatencyHistogram& CycleTimesGet() const { return cycleTimes; }
+
+        void Print(FILE *out, const CycleReplayResult& result) const
+        {
+            fprintf(out, "Replayed %lld of %lld recorded cycles (%lld dropped while recording)\n",
+                (long long)result.frames, (long long)header.frameCount, (long long)header.droppedCount);
+            fprintf(out, "  outputs: %s, %lld mismatched frames, max difference %g",
+                result.mismatchedFrames == 0 ? "MATCH" : "DIFFER", (long long)result.mismatchedFrames, result.maxDifference);
+            if (result.firstMismatchFrame >= 0)
+            {
+                fprintf(out, ", first at frame %lld output %d", (long long)result.firstMismatchFrame, result.firstMismatchOutput);
+            }
+            fprintf(out, "\n  %.3lf s of recorded time computed in %.3lf ms (%.0fx real time)\n", result.recordedSeconds, result.wallSeconds * 1000.0,
+                result.wallSeconds > 0.0 ? result.recordedSeconds / result.wallSeconds : 0.0);
+            cycleTimes.Print(out, "  calculation time", "us", 1000.0);
+        }
+
+    private:
+        bool LoadFrom(FILE *file)
+        {
+            if (fread(&header, sizeof(header), 1, file) != 1) { error = "cycle recording is too small"; return false; }
+            if (memcmp(header.magic, CYCLE_RECORDING_MAGIC, sizeof(CYCLE_RECORDING_MAGIC)) != 0) { error = "not a cycle recording"; return false; }
+            if (header.version != CYCLE_RECORDING_VERSION) { error = "unsupported cycle recording version"; return false; }
+
+            // trust frameCount only as far as the file backs it, so a corrupt header cannot size the buffer (or overflow frameCount * frameBytes)
+            const uint64_t frameBytes = sizeof(int32_t) + (uint64_t)header.inputBytes + header.outputBytes;
+            const int64_t fileSize = FileSizeGet(file);
+            if (fileSize < 0) { error = "cannot get cycle recording size"; return false; }
+            if (header.frameCount > ((uint64_t)fileSize - sizeof(header)) / frameBytes) { error = "cycle recording is truncated"; return false; }
+            if (header.frameCount * frameBytes > SIZE_MAX) { error = "cycle recording is too large to load"; return false; }
+
+            frames.resize((size_t)(header.frameCount * frameBytes));
+            if (fread(frames.data(), (size_t)frameBytes, (size_t)header.frameCount, file) != (size_t)header.frameCount)
+            {
+                error = "cycle recording is truncated";
+                return false;
+            }
+            return true;
+        }
+
+        // Size of the file in bytes, or -1.  Leaves the position where it was.
+        static int64_t FileSizeGet(FILE *file)
+        {
+#ifdef _WIN32
+            const int64_t position = _ftelli64(file);
+            const bool ok = position >= 0 && _fseeki64(file, 0, SEEK_END) == 0;
+            const int64_t size = ok ? _ftelli64(file) : -1;
+            return _fseeki64(file, position, SEEK_SET) == 0 ? size : -1;
+#else
+            const int64_t position = (int64_t)ftello(file);
+            const bool ok = position >= 0 && fseeko(file, 0, SEEK_END) == 0;
+            const int64_t size = ok ? (int64_t)ftello(file) : -1;
+            return fseeko(file, (off_t)position, SEEK_SET) == 0 ? size : -1;
+#endif
+        }
+
+        CycleRecordingHeader        header;
+        const char                  *error;
+        std::vector<unsigned char>  frames;
+        LatencyHistogram            cycleTimes;
+    };
+}
+#endif
@@ -0,0 +1,375 @@
+/*!
+*  @example    CyclicExecutor.h
+
+*  @page       cyclic-executor-cpp CyclicExecutor.h
+
+*  @brief      Real-time setup and a jitter self-check for the thread that runs the SyncInterruptWait() loop.
+
+*  @details
+SyncInterrupt.cpp only raises the Windows thread priority.  On Linux, a bounded-jitter sync loop needs more than that:
+
+- SCHED_FIFO at a fixed priority, so only higher real-time threads and interrupts can preempt it,
+- pinning to one CPU, ideally one removed from the general scheduler with isolcpus= (and nohz_full=),
+- mlockall() so no page of the process is ever swapped out or faulted in lazily,
+- a prefaulted stack and heap, with mallopt() keeping freed heap in the process, so malloc() after start does not reach the kernel,
+- holding /dev/cpu_dma_latency at 0 so the CPU does not drop into deep idle states between interrupts,
+- a PREEMPT_RT kernel.
+
+Configure() applies all of this to the calling thread and records what worked in a CyclicExecutorReport.
+SelfCheck() then runs the wait function (for example SyncInterruptWait()) for a number of cycles and measures the wake-up period and jitter,
+so the report proves, at startup, whether this host meets the jitter limit.
+Run() is the cyclic loop itself: wait, call the cycle function, repeat until it returns false or Stop() is called.
+None of them allocate memory.
+
+On Windows, Configure() falls back to SetThreadPriority(THREAD_PRIORITY_TIME_CRITICAL) and SetThreadAffinityMask().
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include CyclicExecutor.h
+
+*/
+#ifndef CPP_CYCLIC_EXECUTOR
+#define CPP_CYCLIC_EXECUTOR
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "MissedSampleMonitor.h"                    // Import the sample counter gap check.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+namespace SampleAppsCPP
+{
+    struct CyclicExecutorConfig
+    {
+        int32_t priority;                           // SCHED_FIFO priority, 1 (lowest) to 99.  Keep it below the kernel threads serving the controller's interrupt.
+        int32_t cpu;                                // CPU to pin the thread to, -1 to leave the affinity alone
+        int64_t stackPrefaultBytes;                 // stack touched up front; must be below the thread's stack size
+        int64_t heapPrefaultBytes;                  // heap touched up front and kept by the process
+        bool    lockMemory;                         // mlockall(MCL_CURRENT | MCL_FUTURE)
+        bool    holdCpuDmaLatency;                  // keep /dev/cpu_dma_latency at 0 while the executor exists
+        double  jitterLimitUs;                      // SelfCheck() passes if every period is within this of the expected period
+
+        CyclicExecutorConfig()
+            : priority(80), cpu(-1), stackPrefaultBytes(256 * 1024), heapPrefaultBytes(8 * 1024 * 1024),
+              lockMemory(true), holdCpuDmaLatency(true), jitterLimitUs(100.0) {}
+    };
+
+    struct CyclicExecutorReport
+    {
+        // Configure()
+        bool    priorityOk;
+        int     priorityError;                      // errno, 0 on success
+        bool    affinityOk;
+        int     affinityError;
+        bool    memoryLocked;
+        int     memoryLockError;
+        bool    heapKept;                           // mallopt() accepted
+        int64_t stackPrefaulted;
+        int64_t heapPrefaulted;
+        bool    cpuDmaLatencyHeld;
+        bool    kernelRealtime;                     // PREEMPT_RT kernel
+        bool    cpuIsolated;                        // the pinned CPU is in isolcpus=
+        char    governor[32];                       // cpufreq governor of the pinned CPU, "performance" is best
+
+        // SelfCheck()
+        int64_t checkCycles;
+        double  expectedPeriodUs;
+        double  periodMeanUs;
+        double  periodMinUs;
+        double  periodMaxUs;
+        double  jitterMaxUs;                        // largest |period - expected period|
+        int64_t missedSamples;                      // sample counter steps larger than expected
+        bool    jitterOk;
+    };
+
+    class CyclicExecutor
+    {
+    public:
+        explicit CyclicExecutor(const CyclicExecutorConfig& config = CyclicExecutorConfig()) : config(config), stopRequested(false), dmaLatencyHandle(-1)
+        {
+            memset(&report, 0, sizeof(report));
+        }
+
+        ~CyclicExecutor()
+        {
+#ifndef _WIN32
+            if (dmaLatencyHandle >= 0)
+            {
+                close(dmaLatencyHandle);                    // releases the latency request
+            }
+#endif
+        }
+
+        /// <summary>
+        /// Apply the real-time settings to the calling thread.  Call from the thread that will run the loop, before SelfCheck() or Run().
+        /// Returns true if the scheduling priority was applied; the rest is in ReportGet().
+        /// </summary>
+        bool Configure()
+        {
+#ifdef _WIN32
+            report.priorityOk = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+            report.priorityError = report.priorityOk ? 0 : (int)GetLastError();
+            if (config.cpu >= 0)
+            {
+                report.affinityOk = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << config.cpu) != 0;
+                report.affinityError = report.affinityOk ? 0 : (int)GetLastError();
+            }
+            strcpy_s(report.governor, sizeof(report.governor), "n/a");
+#else
+            // memory first, so the stack and heap we touch next stay resident
+            if (config.lockMemory)
+            {
+                report.memoryLocked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+                report.memoryLockError = report.memoryLocked ? 0 : errno;
+            }
+            report.heapKept = mallopt(M_TRIM_THRESHOLD, -1) != 0 && mallopt(M_MMAP_MAX, 0) != 0;
+            report.heapPrefaulted = HeapPrefault(config.heapPrefaultBytes);
+            report.stackPrefaulted = StackPrefault(config.stackPrefaultBytes);
+
+            if (config.cpu >= 0)
+            {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(config.cpu, &cpus);
+                report.affinityError = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+                report.affinityOk = report.affinityError == 0;
+                report.cpuIsolated = CpuListContains("/sys/devices/system/cpu/isolated", config.cpu);
+                char path[96];
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", config.cpu);
+                FirstLineRead(path, report.governor, sizeof(report.governor));
+            }
+
+            sched_param parameters;
+            memset(&parameters, 0, sizeof(parameters));
+            parameters.sched_priority = config.priority;
+            report.priorityError = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+            report.priorityOk = report.priorityError == 0;
+
+            if (config.holdCpuDmaLatency && dmaLatencyHandle < 0)
+            {
+                dmaLatencyHandle = open("/dev/cpu_dma_latency", O_WRONLY);
+                const int32_t zero = 0;
+                report.cpuDmaLatencyHeld = dmaLatencyHandle >= 0 && write(dmaLatencyHandle, &zero, sizeof(zero)) == sizeof(zero);
+            }
+            report.kernelRealtime = KernelRealtimeGet();
+#endif
+            return report.priorityOk;
+        }
+
+        /// <summary>
+        /// Run waitFunction for cycles cycles and measure the period between wake-ups.
+        /// waitFunction returns the controller sample counter, like SyncInterruptWait().  Returns true if the jitter is within the limit.
+        /// </summary>
+        /// <param name="syncPeriodSamples">Samples between wake-ups (SyncInterruptPeriodSet()).</param>
+        /// <param name="samplePeriodUs">Controller sample period (1e6 / SampleRateGet()).</param>
+        template <class WaitFunction>
+        bool SelfCheck(WaitFunction waitFunction, int64_t cycles, int32_t syncPeriodSamples, double samplePeriodUs)
+        {
+            typedef std::chrono::steady_clock Clock;
+            const double expectedUs = syncPeriodSamples * samplePeriodUs;
+            double sumUs = 0, minUs = 1e30, maxUs = 0, jitterUs = 0;
+            int64_t measured = 0;
+            MissedSampleMonitor missedSamples(syncPeriodSamples);
+
+            missedSamples.Update(waitFunction(), 0);
+            Clock::time_point previous = Clock::now();
+            for (int64_t i = 0; i < cycles; i++)
+            {
+                const int32_t sample = waitFunction();
+                const Clock::time_point now = Clock::now();
+                const double periodUs = std::chrono::duration<double, std::micro>(now - previous).count();
+                previous = now;
+                missedSamples.Update(sample, (uint64_t)now.time_since_epoch().count());
+
+                sumUs += periodUs;
+                minUs = periodUs < minUs ? periodUs : minUs;
+                maxUs = periodUs > maxUs ? periodUs : maxUs;
+                jitterUs = std::fabs(periodUs - expectedUs) > jitterUs ? std::fabs(periodUs - expectedUs) : jitterUs;
+                ++measured;
+            }
+
+            report.checkCycles = measured;
+            report.expectedPeriodUs = expectedUs;
+            report.periodMeanUs = measured > 0 ? sumUs / measured : 0;
+            report.periodMinUs = measured > 0 ? minUs : 0;
+            report.periodMaxUs = maxUs;
+            report.jitterMaxUs = jitterUs;
+            report.missedSamples = missedSamples.MissedCycleCountGet();
+            report.jitterOk = measured > 0 && jitterUs <= config.jitterLimitUs && report.missedSamples == 0;
+            return report.jitterOk;
+        }
+
+        /// <summary>
+        /// The cyclic loop: sample = waitFunction(), then cycleFunction(sample), until cycleFunction returns false or Stop() is called.
+        /// </summary>
+        template <class WaitFunction, class CycleFunction>
+        void Run(WaitFunction waitFunction, CycleFunction cycleFunction)
+        {
+            stopRequested.store(false, std::memory_order_relaxed);
+            while (!stopRequested.load(std::memory_order_relaxed))
+            {
+                const int32_t sample = waitFunction();
+                if (!cycleFunction(sample))
+                {
+                    break;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Ask Run() to return after the current cycle.  Safe to call from any thread.
+        /// </summary>
+        void Stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+        const CyclicExecutorReport& ReportGet() const { return report; }
+
+        /// <summary>
+        /// Print the report.  Not real-time safe: call it before or after the loop.
+        /// </summary>
+        void ReportPrint(FILE *out) const
+        {
+            fprintf(out, "Cyclic executor setup:\n");
+#ifdef _WIN32
+            fprintf(out, "  priority TIME_CRITICAL: %s\n", report.priorityOk ? "ok" : "FAILED");
+#else
+            fprintf(out, "  SCHED_FIFO priority %d:  %s\n", config.priority, report.priorityOk ? "ok" : strerror(report.priorityError));
+            fprintf(out, "  mlockall:                %s\n", !config.lockMemory ? "off" : report.memoryLocked ? "ok" : strerror(report.memoryLockError));
+            fprintf(out, "  heap kept in process:    %s, %lld bytes prefaulted\n", report.heapKept ? "ok" : "FAILED", (long long)report.heapPrefaulted);
+            fprintf(out, "  stack prefaulted:        %lld bytes\n", (long long)report.stackPrefaulted);
+            fprintf(out, "  cpu_dma_latency 0:       %s\n", !config.holdCpuDmaLatency ? "off" : report.cpuDmaLatencyHeld ? "ok" : "FAILED (needs root)");
+            fprintf(out, "  PREEMPT_RT kernel:       %s\n", report.kernelRealtime ? "yes" : "NO");
+#endif
+            if (config.cpu >= 0)
+            {
+                fprintf(out, "  pinned to CPU %d:         %s\n", config.cpu, report.affinityOk ? "ok" : "FAILED");
+#ifndef _WIN32
+                fprintf(out, "  CPU %d isolated:          %s, governor %s\n", config.cpu, report.cpuIsolated ? "yes" : "NO", report.governor[0] ? report.governor : "unknown");
+#endif
+            }
+            if (report.checkCycles > 0)
+            {
+                fprintf(out, "Self-check over %lld cycles: period %.1lf us expected, %.1lf mean, %.1lf min, %.1lf max\n",
+                    (long long)report.checkCycles, report.expectedPeriodUs, report.periodMeanUs, report.periodMinUs, report.periodMaxUs);
+                fprintf(out, "  max jitter %.1lf us (limit %.1lf), %lld missed samples: %s\n",
+                    report.jitterMaxUs, config.jitterLimitUs, (long long)report.missedSamples, report.jitterOk ? "PASS" : "FAIL");
+            }
+        }
+
+    private:
+#ifndef _WIN32
+        static const int STACK_CHUNK = 8 * 1024;
+
+        // Touch stackBytes of stack below the caller, one chunk per call level.
+        static int64_t StackPrefault(int64_t stackBytes)
+        {
+            if (stackBytes <= 0)
+            {
+                return 0;
+            }
+            volatile unsigned char chunk[STACK_CHUNK];
+            for (int i = 0; i < STACK_CHUNK; i += 512)
+            {
+                chunk[i] = 0;
+            }
+            return STACK_CHUNK + StackPrefault(stackBytes - STACK_CHUNK) + chunk[0];
+        }
+
+        // Touch heapBytes of heap and free it.  With M_TRIM_THRESHOLD -1 and M_MMAP_MAX 0 the pages stay in the process.
+        static int64_t HeapPrefault(int64_t heapBytes)
+        {
+            if (heapBytes <= 0)
+            {
+                return 0;
+            }
+            volatile unsigned char *heap = (volatile unsigned char *)malloc((size_t)heapBytes);
+            if (heap == nullptr)
+            {
+                return 0;
+            }
+            const long pageSize = sysconf(_SC_PAGESIZE);
+            for (int64_t i = 0; i < heapBytes; i += pageSize)
+            {
+                heap[i] = 0;
+            }
+            free((void *)heap);
+            return heapBytes;
+        }
+
+        static bool FirstLineRead(const char *path, char *text, size_t size)
+        {
+            text[0] = 0;
+            FILE *file = fopen(path, "r");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            bool ok = fgets(text, (int)size, file) != nullptr;
+            fclose(file);
+            text[strcspn(text, "\n")] = 0;
+            return ok;
+        }
+
+        // True if cpu is in a kernel CPU list like "2-3,6".
+        static bool CpuListContains(const char *path, int cpu)
+        {
+            char list[256];
+            if (!FirstLineRead(path, list, sizeof(list)))
+            {
+                return false;
+            }
+            for (char *range = strtok(list, ","); range != nullptr; range = strtok(nullptr, ","))
+            {
+                int first = 0, last = 0;
+                const int fields = sscanf(range, "%d-%d", &first, &last);
+                if (fields >= 1 && cpu >= first && cpu <= (fields == 2 ? last : first))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static bool KernelRealtimeGet()
+        {
+            char flag[8];
+            if (FirstLineRead("/sys/kernel/realtime", flag, sizeof(flag)) && flag[0] == '1')
+            {
+                return true;
+            }
+            utsname name;
+            return uname(&name) == 0 && strstr(name.version, "PREEMPT_RT") != nullptr;
+        }
+#endif
+
+        CyclicExecutorConfig    config;
+        CyclicExecutorReport    report;
+        std::atomic<bool>       stopRequested;
+        int                     dmaLatencyHandle;
+    };
+}
+#endif
@@ -0,0 +1,128 @@
+/*!
+@example    GeneratorTrajectorySource.cpp
+
+*  @page       generator-trajectory-source-cpp GeneratorTrajectorySource.cpp
+
+*  @brief      Streaming PVT motion from an on-demand trajectory source.
+
+*  @details
+PVTmotionMultiAxis.cpp computes the whole quarter circle into stack arrays before it calls MovePVT() once.
+This sample streams the same circle from a QuarterCircleSource: each block of BUFFER_SZ points is computed only when the
+streaming loop needs it, so memory use is one block no matter how large POINTS is.
+It also prints how long the first block took to compute, which is the delay before the controller receives its first point.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include GeneratorTrajectorySource.cpp
+*/
+
+#include <chrono>
+#include <cmath>
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "TrajectorySource.h"                       // Import the on-demand trajectory sources.
+
+using namespace RSI::RapidCode;
+
+void generatorTrajectorySourceMain()
+{
+    const int       AXIS_X = (0);
+    const int       AXIS_Y = (1);
+    const int       AXIS_COUNT = (2);                                   // two axis computation (X & Y)
+    const long      POINTS = (100000);                                  // total points, more than fit on the stack as arrays
+    const double    TIME_SLICE = (0.001);                               // each point processed within 1ms
+    const double    RADIUS = (1000);                                    // radius of circle
+    const int       BUFFER_SZ = (100);                                  // points computed and sent per MovePVT() call
+    const int       EMPTY_CT = (10);                                    // Number of points that remains in the buffer before an e-stop
+    const int       USER_UNITS = 1;                                     // Specify USER UNITS
+
+    // one block of storage, reused for every call
+    double positions[BUFFER_SZ * AXIS_COUNT];
+    double velocities[BUFFER_SZ * AXIS_COUNT];
+    double times[BUFFER_SZ];
+
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    try
+    {
+        SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+        controller->AxisCountSet(AXIS_COUNT);
+
+        Axis *axisX = controller->AxisGet(AXIS_X);
+        Axis *axisY = controller->AxisGet(AXIS_Y);
+        SampleAppsCPP::HelperFunctions::CheckErrors(axisX);
+        SampleAppsCPP::HelperFunctions::CheckErrors(axisY);
+        axisX->UserUnitsSet(USER_UNITS);
+        axisY->UserUnitsSet(USER_UNITS);
+
+        // Initialize a MultiAxis, using the last MotionSupervisor.
+        MultiAxis *multiAxisXY = controller->MultiAxisGet(controller->MotionCountGet() - 1);
+        SampleAppsCPP::HelperFunctions::CheckErrors(multiAxisXY);
+        multiAxisXY->AxisAdd(axisX);
+        multiAxisXY->AxisAdd(axisY);
+
+        multiAxisXY->Abort();
+        multiAxisXY->ClearFaults();
+        multiAxisXY->AmpEnableSet(true);
+
+        axisX->PositionSet(RADIUS);
+        axisY->PositionSet(0);
+        multiAxisXY->MotionIdSet(0);
+
+        SampleAppsCPP::QuarterCircleSource source(RADIUS, POINTS, TIME_SLICE);
+
+        // compute and queue the first two blocks, timing the first one
+        int finalMotionID = 0;
+        bool exitCondition = false;
+        for (int i = 0; i < 2 && !exitCondition; ++i)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            int count = source.PointsNext(positions, velocities, times, BUFFER_SZ);
+            if (i == 0)
+            {
+                printf("First block of %d points computed in %.1lf us.\n", count, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+            exitCondition = source.IsDoneGet();
+            multiAxisXY->MovePVT(positions, velocities, times, count, EMPTY_CT, false, exitCondition);
+            ++finalMotionID;
+        }
+
+        controller->SyncInterruptPeriodSet(10); // this generates an interrupt every x cycles of a 1KHz sample rate
+        controller->SyncInterruptEnableSet(true);
+
+        while (!exitCondition)
+        {
+            controller->SyncInterruptWait();
+            int curMotionID = multiAxisXY->MotionIdExecutingGet();
+
+            // keep two blocks queued, computing each one only when it is needed
+            if (std::abs(finalMotionID - curMotionID) < 2)
+            {
+                int count = source.PointsNext(positions, velocities, times, BUFFER_SZ);
+                exitCondition = source.IsDoneGet();
+                multiAxisXY->MovePVT(positions, velocities, times, count, EMPTY_CT, false, exitCondition);
+                ++finalMotionID;
+            }
+        }
+        controller->SyncInterruptEnableSet(false);
+
+        printf("Updates Done. Waiting to finish motion.\n");
+        multiAxisXY->MotionDoneWait();
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
@@ -0,0 +1,301 @@
+/*!
+*  @example    HostControlLaw.h
+
+*  @page       host-control-law-cpp HostControlLaw.h
+
+*  @brief      Structure-of-arrays PID with feed-forward, filters and limits for every axis in one SIMD pass.
+
+*  @details
+SyncInterrupt.cpp leaves a "do calculations here" slot between reading positions and writing OUTPUT_OFFSET torques.
+HostControlLaw fills it.  Every gain, limit, input and state is an array indexed by axis, so one Update() runs the same arithmetic
+over four axes per AVX instruction (two with SSE2, one otherwise) with no per-axis branches.  Per axis and per cycle:
+
+<ul>
+<li>error = command position - actual position</li>
+<li>integral += KI * error * dt, clamped to +/- integral limit (anti-windup)</li>
+<li>derivative = low-pass filtered (error - previous error) / dt</li>
+<li>output = KP * error + integral + KD * derivative + KVFF * command velocity + KAFF * command acceleration + offset</li>
+<li>output is low-pass filtered, then clamped to +/- output limit</li>
+</ul>
+
+Arrays are padded to a multiple of four axes; unused lanes have zero gains and always output 0.
+Limits start at 0, so an axis outputs nothing until LimitsSet() gives it an output limit.
+After missed sync interrupts, CatchUp() (a MissedSampleMonitor handler) makes the next Update() integrate and differentiate over the whole elapsed time
+instead of one period.  The filters still advance one step.
+UpdateScalar() is the same law one axis at a time, for checking and for HostControlLawBenchmark.cpp.
+The SIMD path is chosen with the SAMPLEAPPS_SIMD_AVX/SAMPLEAPPS_SIMD_SSE2 selection in PointTranspose.h.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include HostControlLaw.h
+
+*/
+#ifndef CPP_HOST_CONTROL_LAW
+#define CPP_HOST_CONTROL_LAW
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "MissedSampleMonitor.h"                    // Import the missed-sample event.
+#include "PointTranspose.h"                         // Import the SIMD selection.
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// Host-side control law for up to MAX_AXES axes.  Holds about 130 bytes per axis, so give large instances static storage.
+    /// </summary>
+    template <int MAX_AXES>
+    class HostControlLaw
+    {
+    public:
+        static const int LANES = (MAX_AXES + 3) / 4 * 4;       // padded to whole AVX vectors
+
+        /// <param name="axisCount">Axes to compute, up to MAX_AXES.</param>
+        /// <param name="cyclePeriod">Seconds between Update() calls (SYNC_PERIOD / SampleRateGet()).</param>
+        HostControlLaw(int32_t axisCount, double cyclePeriod)
+            : axisCount(axisCount < MAX_AXES ? axisCount : MAX_AXES), dt(cyclePeriod), elapsedCycles(1)
+        {
+            double *parameters[] = { kp, ki, kd, kvff, kaff, offset, integralLimit, outputLimit };
+            for (size_t i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++)
+            {
+                memset(parameters[i], 0, sizeof(double) * LANES);
+            }
+            for (int i = 0; i < LANES; i++)
+            {
+                derivativeAlpha[i] = 1.0;
+                outputAlpha[i] = 1.0;
+            }
+            double *inputs[] = { commandPositions, commandVelocities, commandAccelerations, actualPositions };
+            for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+            {
+                memset(inputs[i], 0, sizeof(double) * LANES);
+            }
+            Reset();
+        }
+
+        /// <summary>
+        /// Clear the integrators, filters and outputs, for example after an amp enable.
+        /// </summary>
+        void Reset()
+        {
+            double *states[] = { integral, previousError, derivative, filteredOutput, outputs };
+            for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); i++)
+            {
+                memset(states[i], 0, sizeof(double) * LANES);
+            }
+            hasPrevious = false;
+            elapsedCycles = 1;
+        }
+
+        /// <summary>
+        /// The next Update() covers missedCycles + 1 periods: the integral gets the whole elapsed time and the derivative divides by it.
+        /// </summary>
+        void CatchUp(int32_t missedCycles) { elapsedCycles += missedCycles > 0 ? missedCycles : 0; }
+
+        /// <summary>
+        /// MissedSampleMonitor handler: register with HandlerAdd(HostControlLaw::MissedSamplesHandle, &law).
+        /// </summary>
+        static void MissedSamplesHandle(void *law, const MissedSampleEvent& event) { static_cast<HostControlLaw *>(law)->CatchUp(event.missedCycles); }
+
+        void GainsSet(int32_t axis, double proportional, double integralGain, double derivativeGain, double velocityFeedForward, double accelerationFeedForward)
+        {
+            kp[axis] = proportional;
+            ki[axis] = integralGain;
+            kd[axis] = derivativeGain;
+            kvff[axis] = velocityFeedForward;
+            kaff[axis] = accelerationFeedForward;
+        }
+
+        /// <summary>
+        /// First-order low-pass cutoffs in Hz for the derivative and the output.  0 turns a filter off.
+        /// </summary>
+        void FiltersSet(int32_t axis, double derivativeCutoffHz, double outputCutoffHz)
+        {
+            derivativeAlpha[axis] = AlphaGet(derivativeCutoffHz);
+            outputAlpha[axis] = AlphaGet(outputCutoffHz);
+        }
+
+        /// <summary>
+        /// Symmetric clamps on the integral term and on the output, and a constant output offset.
+        /// </summary>
+        void LimitsSet(int32_t axis, double integralLimitValue, double outputLimitValue, double outputOffset = 0.0)
+        {
+            integralLimit[axis] = integralLimitValue;
+            outputLimit[axis] = outputLimitValue;
+            offset[axis] = outputOffset;
+        }
+
+        // Inputs, one value per axis.  Fill them before each Update().
+        double* CommandPositionsGet() { return commandPositions; }
+        double* CommandVelocitiesGet() { return commandVelocities; }
+        double* CommandAccelerationsGet() { return commandAccelerations; }
+        double* ActualPositionsGet() { return actualPositions; }
+
+        /// <summary>
+        /// Outputs of the last Update(), one per axis.
+        /// </summary>
+        const double* OutputsGet() const { return outputs; }
+
+        int32_t AxisCountGet() const { return axisCount; }
+
+        /// <summary>
+        /// Change how many axes Update() computes, up to MAX_AXES.  Axes beyond the count keep their settings.
+        /// </summary>
+        void AxisCountSet(int32_t count) { axisCount = count < MAX_AXES ? count : MAX_AXES; }
+
+        /// <summary>
+        /// Run the law for every axis, several axes per instruction.  Real-time safe.
+        /// </summary>
+        void Update()
+        {
+            const int32_t lanes = (axisCount + 3) / 4 * 4;
+            const double cycleDt = dt * elapsedCycles;
+            const double derivativeScale = hasPrevious ? 1.0 / cycleDt : 0.0;   // no derivative kick on the first cycle
+            int32_t i = 0;
+#if defined(SAMPLEAPPS_SIMD_AVX)
+            const __m256d vdt = _mm256_set1_pd(cycleDt), vds = _mm256_set1_pd(derivativeScale);
+            const __m256d signMask = _mm256_set1_pd(-0.0);
+            for (; i < lanes; i += 4)
+            {
+                const __m256d error = _mm256_sub_pd(_mm256_load_pd(commandPositions + i), _mm256_load_pd(actualPositions + i));
+
+                __m256d sum = _mm256_add_pd(_mm256_load_pd(integral + i), _mm256_mul_pd(_mm256_mul_pd(_mm256_load_pd(ki + i), error), vdt));
+                const __m256d iLimit = _mm256_load_pd(integralLimit + i);
+                sum = _mm256_min_pd(_mm256_max_pd(sum, _mm256_xor_pd(iLimit, signMask)), iLimit);
+                _mm256_store_pd(integral + i, sum);
+
+                const __m256d rate = _mm256_mul_pd(_mm256_sub_pd(error, _mm256_load_pd(previousError + i)), vds);
+                __m256d d = _mm256_load_pd(derivative + i);
+                d = _mm256_add_pd(d, _mm256_mul_pd(_mm256_load_pd(derivativeAlpha + i), _mm256_sub_pd(rate, d)));
+                _mm256_store_pd(derivative + i, d);
+                _mm256_store_pd(previousError + i, error);
+
+                __m256d u = _mm256_add_pd(_mm256_mul_pd(_mm256_load_pd(kp + i), error), sum);
+                u = _mm256_add_pd(u, _mm256_mul_pd(_mm256_load_pd(kd + i), d));
+                u = _mm256_add_pd(u, _mm256_mul_pd(_mm256_load_pd(kvff + i), _mm256_load_pd(commandVelocities + i)));
+                u = _mm256_add_pd(u, _mm256_mul_pd(_mm256_load_pd(kaff + i), _mm256_load_pd(commandAccelerations + i)));
+                u = _mm256_add_pd(u, _mm256_load_pd(offset + i));
+
+                __m256d f = _mm256_load_pd(filteredOutput + i);
+                f = _mm256_add_pd(f, _mm256_mul_pd(_mm256_load_pd(outputAlpha + i), _mm256_sub_pd(u, f)));
+                _mm256_store_pd(filteredOutput + i, f);
+                const __m256d oLimit = _mm256_load_pd(outputLimit + i);
+                _mm256_store_pd(outputs + i, _mm256_min_pd(_mm256_max_pd(f, _mm256_xor_pd(oLimit, signMask)), oLimit));
+            }
+#elif defined(SAMPLEAPPS_SIMD_SSE2)
+            const __m128d vdt = _mm_set1_pd(cycleDt), vds = _mm_set1_pd(derivativeScale);
+            const __m128d signMask = _mm_set1_pd(-0.0);
+            for (; i < lanes; i += 2)
+            {
+                const __m128d error = _mm_sub_pd(_mm_load_pd(commandPositions + i), _mm_load_pd(actualPositions + i));
+
+                __m128d sum = _mm_add_pd(_mm_load_pd(integral + i), _mm_mul_pd(_mm_mul_pd(_mm_load_pd(ki + i), error), vdt));
+                const __m128d iLimit = _mm_load_pd(integralLimit + i);
+                sum = _mm_min_pd(_mm_max_pd(sum, _mm_xor_pd(iLimit, signMask)), iLimit);
+                _mm_store_pd(integral + i, sum);
+
+                const __m128d rate = _mm_mul_pd(_mm_sub_pd(error, _mm_load_pd(previousError + i)), vds);
+                __m128d d = _mm_load_pd(derivative + i);
+                d = _mm_add_pd(d, _mm_mul_pd(_mm_load_pd(derivativeAlpha + i), _mm_sub_pd(rate, d)));
+                _mm_store_pd(derivative + i, d);
+                _mm_store_pd(previousError + i, error);
+
+                __m128d u = _mm_add_pd(_mm_mul_pd(_mm_load_pd(kp + i), error), sum);
+                u = _mm_add_pd(u, _mm_mul_pd(_mm_load_pd(kd + i), d));
+                u = _mm_add_pd(u, _mm_mul_pd(_mm_load_pd(kvff + i), _mm_load_pd(commandVelocities + i)));
+                u = _mm_add_pd(u, _mm_mul_pd(_mm_load_pd(kaff + i), _mm_load_pd(commandAccelerations + i)));
+                u = _mm_add_pd(u, _mm_load_pd(offset + i));
+
+                __m128d f = _mm_load_pd(filteredOutput + i);
+                f = _mm_add_pd(f, _mm_mul_pd(_mm_load_pd(outputAlpha + i), _mm_sub_pd(u, f)));
+                _mm_store_pd(filteredOutput + i, f);
+                const __m128d oLimit = _mm_load_pd(outputLimit + i);
+                _mm_store_pd(outputs + i, _mm_min_pd(_mm_max_pd(f, _mm_xor_pd(oLimit, signMask)), oLimit));
+            }
+#endif
+            for (; i < lanes; i++)
+            {
+                AxisUpdate(i, cycleDt, derivativeScale);
+            }
+            hasPrevious = true;
+            elapsedCycles = 1;
+        }
+
+        /// <summary>
+        /// The same law one axis at a time.  Matches Update() to rounding (compilers may fuse the scalar multiply-adds).
+        /// </summary>
+        void UpdateScalar()
+        {
+            const int32_t lanes = (axisCount + 3) / 4 * 4;
+            const double cycleDt = dt * elapsedCycles;
+            const double derivativeScale = hasPrevious ? 1.0 / cycleDt : 0.0;
+            for (int32_t i = 0; i < lanes; i++)
+            {
+                AxisUpdate(i, cycleDt, derivativeScale);
+            }
+            hasPrevious = true;
+            elapsedCycles = 1;
+        }
+
+    private:
+        double AlphaGet(double cutoffHz) const
+        {
+            const double pi = 3.14159265358979323846;
+            return cutoffHz > 0.0 ? 1.0 - std::exp(-2.0 * pi * cutoffHz * dt) : 1.0;
+        }
+
+        static double Clamp(double value, double limit) { return value < -limit ? -limit : (value > limit ? limit : value); }
+
+        void AxisUpdate(int32_t i, double cycleDt, double derivativeScale)
+        {
+            const double error = commandPositions[i] - actualPositions[i];
+            integral[i] = Clamp(integral[i] + ki[i] * error * cycleDt, integralLimit[i]);
+            derivative[i] += derivativeAlpha[i] * ((error - previousError[i]) * derivativeScale - derivative[i]);
+            previousError[i] = error;
+
+            const double u = kp[i] * error + integral[i] + kd[i] * derivative[i] + kvff[i] * commandVelocities[i] + kaff[i] * commandAccelerations[i] + offset[i];
+            filteredOutput[i] += outputAlpha[i] * (u - filteredOutput[i]);
+            outputs[i] = Clamp(filteredOutput[i], outputLimit[i]);
+        }
+
+        int32_t     axisCount;
+        double      dt;
+        int32_t     elapsedCycles;                  // periods covered by the next Update(), see CatchUp()
+        bool        hasPrevious;
+
+        // parameters
+        alignas(32) double kp[LANES];
+        alignas(32) double ki[LANES];
+        alignas(32) double kd[LANES];
+        alignas(32) double kvff[LANES];
+        alignas(32) double kaff[LANES];
+        alignas(32) double offset[LANES];
+        alignas(32) double integralLimit[LANES];
+        alignas(32) double outputLimit[LANES];
+        alignas(32) double derivativeAlpha[LANES];
+        alignas(32) double outputAlpha[LANES];
+
+        // inputs
+        alignas(32) double commandPositions[LANES];
+        alignas(32) double commandVelocities[LANES];
+        alignas(32) double commandAccelerations[LANES];
+        alignas(32) double actualPositions[LANES];
+
+        // state and outputs
+        alignas(32) double integral[LANES];
+        alignas(32) double previousError[LANES];
+        alignas(32) double derivative[LANES];
+        alignas(32) double filteredOutput[LANES];
+        alignas(32) double outputs[LANES];
+    };
+}
+#endif
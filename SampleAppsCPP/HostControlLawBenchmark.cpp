@@ -0,0 +1,195 @@
+/*!
+@example    HostControlLawBenchmark.cpp
+
+*  @page       host-control-law-benchmark-cpp HostControlLawBenchmark.cpp
+
+*  @brief      Cycle cost of HostControlLaw vs axis count, and how many axes fit the host process time at 1, 4 and 8 kHz.
+
+*  @details
+Times HostControlLaw::Update() (SIMD) and UpdateScalar() over AXIS_COUNTS axes with changing inputs, and checks that both give the same outputs.
+Then, for each sample rate in SAMPLE_RATES, it prints how many axes fit in the host budget: the largest tested axis count whose p99 fits,
+and an estimate from the p99 cost per axis at the largest count.  The estimate is capped at the largest tested count offline, and at
+AxisCountGet() on a controller, because the per-axis cost is not measured past them; a capped estimate prints as "1024 (cap)".
+
+Offline, the budget is HOST_PROCESS_FRACTION of the sample period.  On a controller the budget is SyncInterruptHostProcessTimeGet():
+without SAMPLEAPPS_NO_RAPIDCODE, set RUN_ON_CONTROLLER to also print the fit at the controller's own sample rate and host process time.
+The control law shares that budget with the cycle I/O (CycleIOBenchmark.cpp), so subtract the I/O time before relying on these numbers.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include HostControlLawBenchmark.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#endif
+#include "HostControlLaw.h"                         // Import the SIMD host control law.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int       AXIS_COUNTS[] = { 4, 8, 16, 32, 64, 128, 256, 512, 1024 };
+    const int       MAX_AXES = 1024;
+    const double    SAMPLE_RATES[] = { 1000.0, 4000.0, 8000.0 };          // Hz
+    const double    HOST_PROCESS_FRACTION = 0.5;                            // offline budget: this share of the sample period
+    const int       CYCLES = 5000;                                          // Update() calls timed per axis count
+    const bool      RUN_ON_CONTROLLER = false;                              // set true to also use a controller's host process time
+
+    typedef SampleAppsCPP::HostControlLaw<MAX_AXES> ControlLaw;
+
+    // 130 KB each, so keep them off the stack
+    ControlLaw simdLaw(MAX_AXES, 1.0 / SAMPLE_RATES[0]);
+    ControlLaw scalarLaw(MAX_AXES, 1.0 / SAMPLE_RATES[0]);
+
+    struct CostStats
+    {
+        double p50Us;
+        double p99Us;
+        double maxUs;
+    };
+
+    double p99UsByCount[sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0])];
+
+    void LawsConfigure(int axisCount)
+    {
+        ControlLaw *laws[] = { &simdLaw, &scalarLaw };
+        for (int l = 0; l < 2; l++)
+        {
+            laws[l]->AxisCountSet(axisCount);
+            laws[l]->Reset();
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                laws[l]->GainsSet(axis, 10.0 + axis, 2.0, 0.05, 0.9, 0.01);
+                laws[l]->FiltersSet(axis, 200.0, 400.0);
+                laws[l]->LimitsSet(axis, 5.0, 10.0 + axis % 3);
+            }
+        }
+    }
+
+    // Move every axis along a different sine and feed both laws the same inputs.
+    void InputsSet(ControlLaw& law, int axisCount, int cycle)
+    {
+        for (int axis = 0; axis < axisCount; axis++)
+        {
+            const double phase = 0.001 * cycle + 0.1 * axis;
+            law.CommandPositionsGet()[axis] = std::sin(phase);
+            law.CommandVelocitiesGet()[axis] = std::cos(phase);
+            law.CommandAccelerationsGet()[axis] = -std::sin(phase);
+            law.ActualPositionsGet()[axis] = std::sin(phase - 0.01);
+        }
+    }
+
+    template <class UpdateFn>
+    CostStats CostTime(int axisCount, bool simd, UpdateFn update)
+    {
+        ControlLaw& law = simd ? simdLaw : scalarLaw;
+        std::vector<double> cycleUs(CYCLES);
+        for (int cycle = 0; cycle < CYCLES; cycle++)
+        {
+            InputsSet(law, axisCount, cycle);
+            Clock::time_point start = Clock::now();
+            update(law);
+            cycleUs[cycle] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+        std::sort(cycleUs.begin(), cycleUs.end());
+        CostStats stats;
+        stats.p50Us = cycleUs[cycleUs.size() / 2];
+        stats.p99Us = cycleUs[(cycleUs.size() * 99) / 100];
+        stats.maxUs = cycleUs.back();
+        return stats;
+    }
+
+    // maxAxes caps the estimate: the per-axis cost says nothing about counts past what was tested, or what the controller has
+    void FitPrint(double sampleRate, double budgetUs, int maxAxes)
+    {
+        const int countCount = sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]);
+        int largest = 0;
+        for (int i = 0; i < countCount; i++)
+        {
+            if (p99UsByCount[i] <= budgetUs)
+            {
+                largest = AXIS_COUNTS[i];
+            }
+        }
+        const double usPerAxis = p99UsByCount[countCount - 1] / AXIS_COUNTS[countCount - 1];
+        const double estimate = budgetUs / usPerAxis;
+        char estimated[32];
+        if (estimate >= maxAxes)
+        {
+            snprintf(estimated, sizeof(estimated), "%d (cap)", maxAxes);
+        }
+        else
+        {
+            snprintf(estimated, sizeof(estimated), "%.0f", estimate);
+        }
+        printf("%7.0f Hz %10.1f | %12d %14s\n", sampleRate, budgetUs, largest, estimated);
+    }
+}
+
+void hostControlLawBenchmarkMain()
+{
+    const int countCount = sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]);
+
+    printf("\nHostControlLaw::Update() cost, %d cycles per axis count (%s)\n", CYCLES, SampleAppsCPP::PointTransposeInstructionSetGet());
+    printf("%5s | %9s %9s %9s | %9s %9s %9s | %8s %12s\n", "axes", "SIMD p50", "p99 us", "max us", "scalar p50", "p99 us", "max us", "speed-up", "max diff");
+    for (int c = 0; c < countCount; c++)
+    {
+        const int axisCount = AXIS_COUNTS[c];
+        LawsConfigure(axisCount);
+        CostStats simd = CostTime(axisCount, true, [](ControlLaw& law) { law.Update(); });
+        CostStats scalar = CostTime(axisCount, false, [](ControlLaw& law) { law.UpdateScalar(); });
+        p99UsByCount[c] = simd.p99Us;
+
+        // both paths saw the same inputs for the same number of cycles
+        double maxDiff = 0.0;
+        for (int axis = 0; axis < axisCount; axis++)
+        {
+            maxDiff = std::max(maxDiff, std::fabs(simdLaw.OutputsGet()[axis] - scalarLaw.OutputsGet()[axis]));
+        }
+        printf("%5d | %9.3f %9.3f %9.3f | %10.3f %9.3f %9.3f | %7.2fx %12.3g\n", axisCount, simd.p50Us, simd.p99Us, simd.maxUs,
+            scalar.p50Us, scalar.p99Us, scalar.maxUs, scalar.p50Us / simd.p50Us, maxDiff);
+    }
+
+    printf("\nAxes that fit, offline budget = %.0f%% of the sample period (control law only, no cycle I/O)\n", HOST_PROCESS_FRACTION * 100.0);
+    printf("%10s %10s | %12s %14s\n", "rate", "budget us", "tested p99", "estimated");
+    for (size_t r = 0; r < sizeof(SAMPLE_RATES) / sizeof(SAMPLE_RATES[0]); r++)
+    {
+        FitPrint(SAMPLE_RATES[r], HOST_PROCESS_FRACTION * 1e6 / SAMPLE_RATES[r], AXIS_COUNTS[countCount - 1]);
+    }
+
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    if (RUN_ON_CONTROLLER)
+    {
+        using namespace RSI::RapidCode;
+        MotionController *controller = MotionController::CreateFromSoftware();
+        SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+        try
+        {
+            printf("\nAxes that fit, controller budget = SyncInterruptHostProcessTimeGet()\n");
+            const int axisCount = std::min(controller->AxisCountGet(), AXIS_COUNTS[countCount - 1]);
+            FitPrint(controller->SampleRateGet(), controller->SyncInterruptHostProcessTimeGet(), axisCount);
+        }
+        catch (RsiError const& err)
+        {
+            printf("\n%s\n", err.text);
+        }
+        controller->Delete();                               // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+    }
+#endif
+}
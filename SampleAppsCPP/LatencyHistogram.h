@@ -0,0 +1,212 @@
+/*!
+*  @example    LatencyHistogram.h
+
+*  @page       latency-histogram-cpp LatencyHistogram.h
+
+*  @brief      Fixed-memory, allocation-free latency histogram with percentiles, cheap enough to record every sync interrupt.
+
+*  @details
+SyncInterrupt.cpp and Custom97.cpp only track the min and max deltaTime, so one outlier hides the whole distribution.
+
+LatencyHistogram records non-negative integer values (nanoseconds in the samples) in HDR-style buckets:
+a power-of-two range chosen from the highest set bit, split into SUB_BUCKETS linear sub-buckets.
+Every bucket is within 1 / SUB_BUCKETS (0.4%, 4 us of a 1 ms period) of its value up to 2^40, in 66 KB of counters.
+Record() is a bit scan, a shift and an increment.
+
+PercentileGet() returns the upper edge of the bucket holding the percentile, so it never under-reports.
+Print() prints count, min, mean, p50, p99, p99.9 and max, and BucketsPrint() dumps every non-empty bucket.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include LatencyHistogram.h
+
+*/
+#ifndef CPP_LATENCY_HISTOGRAM
+#define CPP_LATENCY_HISTOGRAM
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace SampleAppsCPP
+{
+    class LatencyHistogram
+    {
+    public:
+        static const int SUB_BUCKET_BITS = 8;
+        static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;                           // linear steps per power of two
+        static const int VALUE_BITS = 40;                                               // values from 2^40 (about 18 minutes in ns) share the last bucket
+        static const int BUCKET_COUNT = (VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        LatencyHistogram() { Reset(); }
+
+        void Reset()
+        {
+            memset(counts, 0, sizeof(counts));
+            count = 0;
+            sum = 0;
+            min = UINT64_MAX;
+            max = 0;
+        }
+
+        /// <summary>
+        /// Add one value.  Real-time safe.
+        /// </summary>
+        void Record(uint64_t value)
+        {
+            counts[IndexGet(value)]++;
+            ++count;
+            sum += value;
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+        }
+
+        /// <summary>
+        /// Add one signed value, clamping negative values to 0.
+        /// </summary>
+        void Record(int64_t value) { Record(value < 0 ? (uint64_t)0 : (uint64_t)value); }
+
+        /// <summary>
+        /// Add everything recorded in another histogram, for example one per thread.
+        /// </summary>
+        void Merge(const LatencyHistogram& other)
+        {
+            for (int i = 0; i < BUCKET_COUNT; i++)
+            {
+                counts[i] += other.counts[i];
+            }
+            count += other.count;
+            sum += other.sum;
+            min = other.min < min ? other.min : min;
+            max = other.max > max ? other.max : max;
+        }
+
+        uint64_t CountGet() const { return count; }
+        uint64_t MinGet() const { return count > 0 ? min : 0; }
+        uint64_t MaxGet() const { return max; }
+        double   MeanGet() const { return count > 0 ? (double)sum / count : 0.0; }
+
+        /// <summary>
+        /// Smallest bucket edge that at least percent of the values are at or below, capped at the max.
+        /// </summary>
+        uint64_t PercentileGet(double percent) const
+        {
+            uint64_t value;
+            PercentilesGet(&percent, 1, &value);
+            return value;
+        }
+
+        /// <summary>
+        /// Several percentiles in one pass over the buckets.  percents must be in ascending order.
+        /// </summary>
+        void PercentilesGet(const double *percents, int percentCount, uint64_t *values) const
+        {
+            int next = 0;
+            uint64_t seen = 0;
+            for (int i = 0; i < BUCKET_COUNT && next < percentCount && count > 0; i++)
+            {
+                seen += counts[i];
+                while (next < percentCount && seen >= TargetGet(percents[next]))
+                {
+                    const uint64_t edge = UpperEdgeGet(i);
+                    values[next++] = edge < max ? edge : max;
+                }
+            }
+            for (; next < percentCount; next++)
+            {
+                values[next] = max;                     // 0 when empty
+            }
+        }
+
+        /// <summary>
+        /// One-line summary.  Values are divided by unitScale, e.g. 1000.0 to print nanoseconds as microseconds.
+        /// Not real-time safe: call it outside the loop.
+        /// </summary>
+        void Print(FILE *out, const char *name, const char *unit, double unitScale) const
+        {
+            fprintf(out, "%s: %llu values, min %.3lf, mean %.3lf, p50 %.3lf, p99 %.3lf, p99.9 %.3lf, max %.3lf %s\n", name, (unsigned long long)count,
+                MinGet() / unitScale, MeanGet() / unitScale, PercentileGet(50.0) / unitScale, PercentileGet(99.0) / unitScale,
+                PercentileGet(99.9) / unitScale, MaxGet() / unitScale, unit);
+        }
+
+        /// <summary>
+        /// Every non-empty bucket with its range, count and cumulative percentage.
+        /// </summary>
+        void BucketsPrint(FILE *out, double unitScale) const
+        {
+            uint64_t seen = 0;
+            for (int i = 0; i < BUCKET_COUNT; i++)
+            {
+                if (counts[i] == 0) continue;
+                seen += counts[i];
+                fprintf(out, "    %12.3lf - %-12.3lf : %10llu  %8.4lf%%\n", LowerEdgeGet(i) / unitScale, UpperEdgeGet(i) / unitScale,
+                    (unsigned long long)counts[i], 100.0 * seen / count);
+            }
+        }
+
+        static int IndexGet(uint64_t value)
+        {
+            if (value < (uint64_t)SUB_BUCKETS)
+            {
+                return (int)value;
+            }
+            if (value >> VALUE_BITS)
+            {
+                return BUCKET_COUNT - 1;
+            }
+            const int shift = HighestBitGet(value) - SUB_BUCKET_BITS;                   // value >> shift is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+            return (shift + 1) * SUB_BUCKETS + (int)((value >> shift) - SUB_BUCKETS);
+        }
+
+        static uint64_t LowerEdgeGet(int index)
+        {
+            const int range = index / SUB_BUCKETS;
+            const uint64_t sub = (uint64_t)(index % SUB_BUCKETS);
+            return range == 0 ? sub : (SUB_BUCKETS + sub) << (range - 1);
+        }
+
+        static uint64_t UpperEdgeGet(int index)
+        {
+            const int range = index / SUB_BUCKETS;
+            return range == 0 ? LowerEdgeGet(index) : LowerEdgeGet(index) + ((uint64_t)1 << (range - 1)) - 1;
+        }
+
+    private:
+        uint64_t TargetGet(double percent) const
+        {
+            const uint64_t target = (uint64_t)(percent / 100.0 * count + 0.5);
+            return target < 1 ? 1 : target;
+        }
+
+        static int HighestBitGet(uint64_t value)
+        {
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanReverse64(&bit, value);
+            return (int)bit;
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+        uint64_t counts[BUCKET_COUNT];
+        uint64_t count;
+        uint64_t sum;
+        uint64_t min;
+        uint64_t max;
+    };
+}
+#endif
@@ -0,0 +1,197 @@
+/*!
+*  @example    MissedSampleMonitor.h
+
+*  @page       missed-sample-monitor-cpp MissedSampleMonitor.h
+
+*  @brief      Detect skipped sync interrupts from the controller sample counter, count and timestamp them, and run catch-up handlers.
+
+*  @details
+SyncInterruptWait() returns the controller sample counter.  Consecutive wake-ups should be exactly SyncInterruptPeriodGet() samples apart.
+A larger step means the host slept through one or more interrupts.  Integrators, filters and derivative terms then see one period of change
+that actually took several periods, and drift without any error being reported.
+
+Call Update() with the counter and the host timer right after every SyncInterruptWait().  When the step is larger than the sync period it:
+<ul>
+<li>counts the missed cycles and the event, and keeps the largest gap,</li>
+<li>stores the sample, host timer and missed cycle count in a ring of the last EVENT_HISTORY events,</li>
+<li>calls every handler registered with HandlerAdd(), in order, before the cycle's calculations, so they can account for the elapsed time.</li>
+</ul>
+A step of 0 or less (counter repeated or went backwards, for example after a controller restart) is counted separately and resynchronizes
+without calling the handlers.  The counter wraps through uint32, so a 32-bit wrap is a normal step.
+
+Handlers are plain function pointers with a context pointer, so registering and calling them never allocates.
+HostControlLaw::CatchUp() is a ready-made handler target: it stretches the next Update()'s integral and derivative time step over the missed cycles.
+CyclicExecutor::SelfCheck() counts its missed samples with this class.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include MissedSampleMonitor.h
+
+*/
+#ifndef CPP_MISSED_SAMPLE_MONITOR
+#define CPP_MISSED_SAMPLE_MONITOR
+
+#include <cstdint>
+#include <cstdio>
+
+namespace SampleAppsCPP
+{
+    struct MissedSampleEvent
+    {
+        int32_t     sample;                         // counter at the wake-up that found the gap
+        uint64_t    hostTicks;                      // host performance timer at that wake-up
+        int32_t     elapsedSamples;                 // samples since the previous wake-up
+        int32_t     missedCycles;                   // sync interrupts slept through
+    };
+
+    /// <summary>
+    /// Called from the sync loop when interrupts were missed.  Must be real-time safe.
+    /// </summary>
+    typedef void (*MissedSampleHandler)(void *context, const MissedSampleEvent& event);
+
+    class MissedSampleMonitor
+    {
+    public:
+        static const int MAX_HANDLERS = 8;
+        static const int EVENT_HISTORY = 64;
+
+        /// <param name="syncPeriodSamples">Samples between wake-ups (SyncInterruptPeriodSet()).</param>
+        explicit MissedSampleMonitor(int32_t syncPeriodSamples) : syncPeriod(syncPeriodSamples > 0 ? syncPeriodSamples : 1), handlerCount(0)
+        {
+            Reset();
+        }
+
+        /// <summary>
+        /// Clear the counts and history and wait for a first sample again.  Keeps the handlers.
+        /// </summary>
+        void Reset()
+        {
+            hasPrevious = false;
+            previousSample = 0;
+            cycleCount = 0;
+            missedCycleCount = 0;
+            eventCount = 0;
+            resyncCount = 0;
+            largestMissed = 0;
+        }
+
+        /// <summary>
+        /// Register a catch-up handler.  Call before the loop.  Returns false if MAX_HANDLERS are already registered.
+        /// </summary>
+        bool HandlerAdd(MissedSampleHandler handler, void *context)
+        {
+            if (handlerCount >= MAX_HANDLERS || handler == nullptr)
+            {
+                return false;
+            }
+            handlers[handlerCount].function = handler;
+            handlers[handlerCount].context = context;
+            ++handlerCount;
+            return true;
+        }
+
+        /// <summary>
+        /// Check the step since the last wake-up, and run the handlers if interrupts were missed.  Real-time safe.
+        /// Returns the number of missed cycles (0 on the first call and on a normal step).
+        /// </summary>
+        /// <param name="hostTicks">HostTickCounter::Read() (StreamingDepthController.h), so event times survive the 32-bit timer wrapping.</param>
+        int32_t Update(int32_t sample, uint64_t hostTicks)
+        {
+            const int32_t elapsed = (int32_t)((uint32_t)sample - (uint32_t)previousSample);
+            const bool first = !hasPrevious;
+            hasPrevious = true;
+            previousSample = sample;
+            if (first)
+            {
+                return 0;
+            }
+            ++cycleCount;
+            if (elapsed <= 0)
+            {
+                ++resyncCount;
+                return 0;
+            }
+            if (elapsed <= syncPeriod)
+            {
+                return 0;
+            }
+
+            MissedSampleEvent& event = events[eventCount % EVENT_HISTORY];
+            event.sample = sample;
+            event.hostTicks = hostTicks;
+            event.elapsedSamples = elapsed;
+            event.missedCycles = (elapsed + syncPeriod - 1) / syncPeriod - 1;
+            ++eventCount;
+            missedCycleCount += event.missedCycles;
+            largestMissed = event.missedCycles > largestMissed ? event.missedCycles : largestMissed;
+
+            for (int i = 0; i < handlerCount; i++)
+            {
+                handlers[i].function(handlers[i].context, event);
+            }
+            return event.missedCycles;
+        }
+
+        int64_t CycleCountGet() const { return cycleCount; }
+        int64_t MissedCycleCountGet() const { return missedCycleCount; }
+        int64_t EventCountGet() const { return eventCount; }
+        int64_t ResyncCountGet() const { return resyncCount; }
+        int32_t LargestMissedGet() const { return largestMissed; }
+
+        /// <summary>
+        /// Number of events in the history, at most EVENT_HISTORY.
+        /// </summary>
+        int32_t EventHistoryCountGet() const { return (int32_t)(eventCount < EVENT_HISTORY ? eventCount : EVENT_HISTORY); }
+
+        /// <summary>
+        /// An event from the history, 0 being the most recent.
+        /// </summary>
+        const MissedSampleEvent& EventGet(int32_t index) const { return events[(eventCount - 1 - index) % EVENT_HISTORY]; }
+
+        /// <summary>
+        /// Print the counts and the recent events.  Not real-time safe: call it after the loop.
+        /// </summary>
+        /// <param name="hostTicksPerSecond">Host performance timer frequency, to print event times relative to the oldest one.</param>
+        void Print(FILE *out, double hostTicksPerSecond) const
+        {
+            fprintf(out, "Missed samples: %lld sync interrupts missed in %lld events over %lld cycles, largest gap %d, %lld counter resyncs\n",
+                (long long)missedCycleCount, (long long)eventCount, (long long)cycleCount, largestMissed, (long long)resyncCount);
+            const int32_t count = EventHistoryCountGet();
+            for (int32_t i = count - 1; i >= 0; i--)
+            {
+                const MissedSampleEvent& event = EventGet(i);
+                fprintf(out, "  sample %11d  +%10.3lf ms  %6d samples elapsed, %5d missed\n", event.sample,
+                    (double)(event.hostTicks - EventGet(count - 1).hostTicks) * 1000.0 / hostTicksPerSecond, event.elapsedSamples, event.missedCycles);
+            }
+        }
+
+    private:
+        struct Handler
+        {
+            MissedSampleHandler function;
+            void                *context;
+        };
+
+        int32_t             syncPeriod;
+        bool                hasPrevious;
+        int32_t             previousSample;
+        int64_t             cycleCount;
+        int64_t             missedCycleCount;
+        int64_t             eventCount;
+        int64_t             resyncCount;
+        int32_t             largestMissed;
+        int                 handlerCount;
+        Handler             handlers[MAX_HANDLERS];
+        MissedSampleEvent   events[EVENT_HISTORY];
+    };
+}
+#endif
@@ -0,0 +1,436 @@
+/*!
+*  @example    MotionControllerStandIn.h
+
+*  @page       motion-controller-stand-in-cpp MotionControllerStandIn.h
+
+*  @brief      Software stand-ins for a streaming MultiAxis, controller memory and the recorder, for benchmarks on machines without a controller.
+
+*  @details
+SimulatedMultiAxis has the streaming calls the samples use (MovePT(), MovePVT(), MotionIdExecutingGet(),
+MotionElementIdExecutingGet(), MotionIdSet()) with the same arguments as MultiAxis.  Points are copied into a
+controller-side queue on every call, the way the library copies them, and SamplesAdvance() consumes them according to their times.
+Like the real controller, it e-stops if a non-final motion drains to EMPTY_CT points.
+
+SimulatedControllerMemory has MemoryBlockGet(), MemoryBlockSet(), MemoryDoubleGet() and MemoryDoubleSet() on a plain byte array,
+with the same per-call and per-byte overhead knobs.
+
+SimulatedRecorder has the MotionController recorder calls.  Records appear at the sample rate divided by the recorder period, in real time,
+into a buffer of a fixed number of records.  With the circular buffer on, records the host has not read in time are overwritten and counted,
+so a drain loop can be checked for losses.  Besides RecorderRecordDataGet(), RecorderRecordDataSpanGet() hands out many records per call.
+A value whose address is SAMPLE_COUNTER_ADDRESS records the sample counter; any other address records address + sample.
+
+None of them include rsi.h, so benchmarks built on it run on any Linux or Windows box.
+The call overhead of the real transport is not known offline.  Use callOverheadUs and pointOverheadNs to add it, calibrated from a hardware run.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include MotionControllerStandIn.h
+
+*/
+#ifndef CPP_MOTION_CONTROLLER_STAND_IN
+#define CPP_MOTION_CONTROLLER_STAND_IN
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// Spin for the given time, standing in for the cost of a call to the controller.
+    /// </summary>
+    inline void StandInBusyWait(double nanoseconds)
+    {
+        if (nanoseconds <= 0)
+        {
+            return;
+        }
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::nanoseconds((int64_t)nanoseconds);
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    }
+
+    class SimulatedMultiAxis
+    {
+    public:
+        /// <param name="axisCount">Axes in the simulated MultiAxis.</param>
+        /// <param name="capacityPoints">Size of the simulated controller point queue.</param>
+        /// <param name="samplePeriod">Controller sample period in seconds (1.0 / SampleRateGet()).</param>
+        /// <param name="callOverheadUs">Busy time added to every MovePT()/MovePVT() call.</param>
+        /// <param name="pointOverheadNs">Busy time added per point sent.</param>
+        SimulatedMultiAxis(int32_t axisCount, int32_t capacityPoints, double samplePeriod, double callOverheadUs = 0, double pointOverheadNs = 0)
+            : axisCount(axisCount), capacity(capacityPoints), samplePeriod(samplePeriod), callOverheadUs(callOverheadUs), pointOverheadNs(pointOverheadNs),
+              positions((size_t)capacityPoints * axisCount), velocities((size_t)capacityPoints * axisCount), times(capacityPoints),
+              motionIds(capacityPoints), elementIds(capacityPoints)
+        {
+            Abort();
+            nextMotionId = 0;
+        }
+
+        /// <summary>
+        /// Same arguments as MultiAxis::MovePT().  The motion type is accepted but ignored.
+        /// </summary>
+        template <class MotionTypeT>
+        void MovePT(MotionTypeT /*type*/, const double *pointPositions, const double *pointTimes, int32_t pointCount, int32_t emptyCount, bool /*retain*/, bool final)
+        {
+            Append(pointPositions, nullptr, pointTimes, pointCount, emptyCount, final);
+        }
+
+        /// <summary>
+        /// Same arguments as MultiAxis::MovePVT().
+        /// </summary>
+        void MovePVT(const double *pointPositions, const double *pointVelocities, const double *pointTimes, int32_t pointCount, int32_t emptyCount, bool /*retain*/, bool final)
+        {
+            Append(pointPositions, pointVelocities, pointTimes, pointCount, emptyCount, final);
+        }
+
+        /// <summary>
+        /// Same arguments as the mask form of MultiAxis::StreamingOutputAdd().  Only counted; no output is driven.
+        /// </summary>
+        void StreamingOutputAdd(int32_t /*onMask*/, int32_t /*offMask*/, uint64_t /*address*/, int32_t /*elementId*/) { ++streamingOutputsAdded; }
+
+        int32_t MotionIdExecutingGet() const { return executingMotionId; }
+        int32_t MotionElementIdExecutingGet() const { return executingElementId; }
+        void    MotionIdSet(int32_t id) { nextMotionId = id; }
+        int32_t AxisCountGet() const { return axisCount; }
+
+        int64_t QueuedPointsGet() const { return count; }
+        int64_t PointsExecutedGet() const { return pointsExecuted; }
+        bool    IsEStoppedGet() const { return eStopped; }
+        bool    IsOverflowedGet() const { return overflowed; }      // a call sent more points than the queue could hold
+        bool    IsMotionDoneGet() const { return count == 0 && finalSent; }
+        int64_t StreamingOutputCountGet() const { return streamingOutputsAdded; }
+
+        void Abort()
+        {
+            head = 0;
+            count = 0;
+            sampleTime = 0;
+            pointTimeRemaining = 0;
+            pointsExecuted = 0;
+            executingMotionId = 0;
+            executingElementId = 0;
+            currentEmptyCount = -1;
+            finalSent = false;
+            eStopped = false;
+            overflowed = false;
+            streamingOutputsAdded = 0;
+        }
+
+        /// <summary>
+        /// Let the simulated controller run for some samples, consuming points by their times.
+        /// </summary>
+        void SamplesAdvance(int32_t samples)
+        {
+            sampleTime += samples * samplePeriod;
+            while (count > 0 && !eStopped)
+            {
+                if (pointTimeRemaining <= 0)
+                {
+                    pointTimeRemaining = times[head];                   // start executing the point at the head of the queue
+                    executingMotionId = motionIds[head];
+                    executingElementId = elementIds[head];
+                }
+                if (pointTimeRemaining > sampleTime + TIME_TOLERANCE)
+                {
+                    pointTimeRemaining -= sampleTime;
+                    sampleTime = 0;
+                    break;
+                }
+                sampleTime -= pointTimeRemaining;
+                pointTimeRemaining = 0;
+                head = (head + 1) % capacity;
+                --count;
+                ++pointsExecuted;
+
+                if (!finalSent && currentEmptyCount >= 0 && count <= currentEmptyCount)
+                {
+                    eStopped = true;                                    // the controller ran dry before the final block arrived
+                }
+            }
+            if (count == 0)
+            {
+                sampleTime = 0;
+            }
+        }
+
+    private:
+        static constexpr double TIME_TOLERANCE = 1e-9;                  // seconds; absorbs rounding in sums of point times
+
+        void Append(const double *pointPositions, const double *pointVelocities, const double *pointTimes, int32_t pointCount, int32_t emptyCount, bool final)
+        {
+            StandInBusyWait(callOverheadUs * 1000.0 + pointOverheadNs * pointCount);
+
+            if (count + pointCount > capacity)
+            {
+                overflowed = true;
+                return;
+            }
+            const int32_t motionId = nextMotionId++;
+            int32_t tail = (int32_t)((head + count) % capacity);
+            for (int32_t i = 0; i < pointCount; )
+            {
+                // copy in contiguous runs up to the end of the ring
+                int32_t run = capacity - tail;
+                if (run > pointCount - i) run = pointCount - i;
+                memcpy(&positions[(size_t)tail * axisCount], pointPositions + (size_t)i * axisCount, sizeof(double) * run * axisCount);
+                if (pointVelocities != nullptr)
+                {
+                    memcpy(&velocities[(size_t)tail * axisCount], pointVelocities + (size_t)i * axisCount, sizeof(double) * run * axisCount);
+                }
+                memcpy(&times[tail], pointTimes + i, sizeof(double) * run);
+                for (int32_t k = 0; k < run; k++)
+                {
+                    motionIds[tail + k] = motionId;
+                    elementIds[tail + k] = i + k;
+                }
+                i += run;
+                tail = (tail + run) % capacity;
+            }
+            count += pointCount;
+            currentEmptyCount = emptyCount;
+            finalSent = final;
+        }
+
+        int32_t axisCount;
+        int32_t capacity;
+        double  samplePeriod;
+        double  callOverheadUs;
+        double  pointOverheadNs;
+
+        std::vector<double>  positions;
+        std::vector<double>  velocities;
+        std::vector<double>  times;
+        std::vector<int32_t> motionIds;
+        std::vector<int32_t> elementIds;
+
+        int32_t head;
+        int64_t count;
+        double  sampleTime;
+        double  pointTimeRemaining;
+        int64_t pointsExecuted;
+        int32_t nextMotionId;
+        int32_t executingMotionId;
+        int32_t executingElementId;
+        int32_t currentEmptyCount;
+        bool    finalSent;
+        bool    eStopped;
+        bool    overflowed;
+        int64_t streamingOutputsAdded;
+    };
+
+    /// <summary>
+    /// A block of controller memory with the MotionController memory calls.  Addresses start at BASE_ADDRESS.
+    /// </summary>
+    class SimulatedControllerMemory
+    {
+    public:
+        static const uint64_t BASE_ADDRESS = 0x10000;
+
+        /// <param name="sizeBytes">Bytes of simulated memory.</param>
+        /// <param name="callOverheadUs">Busy time added to every call.</param>
+        /// <param name="byteOverheadNs">Busy time added per byte transferred.</param>
+        SimulatedControllerMemory(int32_t sizeBytes, double callOverheadUs = 0, double byteOverheadNs = 0)
+            : memory(sizeBytes), callOverheadUs(callOverheadUs), byteOverheadNs(byteOverheadNs), calls(0), bytes(0)
+        {
+        }
+
+        void MemoryBlockGet(uint64_t address, void *data, int32_t size)
+        {
+            Transfer(size);
+            memcpy(data, &memory[address - BASE_ADDRESS], size);
+        }
+
+        void MemoryBlockSet(uint64_t address, const void *data, int32_t size)
+        {
+            Transfer(size);
+            memcpy(&memory[address - BASE_ADDRESS], data, size);
+        }
+
+        double MemoryDoubleGet(uint64_t address)
+        {
+            double value;
+            MemoryBlockGet(address, &value, sizeof(value));
+            return value;
+        }
+
+        void MemoryDoubleSet(uint64_t address, double value) { MemoryBlockSet(address, &value, sizeof(value)); }
+
+        int32_t SizeGet() const { return (int32_t)memory.size(); }
+        int64_t CallCountGet() const { return calls; }
+        int64_t BytesTransferredGet() const { return bytes; }
+
+    private:
+        void Transfer(int32_t size)
+        {
+            StandInBusyWait(callOverheadUs * 1000.0 + byteOverheadNs * size);
+            ++calls;
+            bytes += size;
+        }
+
+        std::vector<unsigned char>  memory;
+        double                      callOverheadUs;
+        double                      byteOverheadNs;
+        int64_t                     calls;
+        int64_t                     bytes;
+    };
+
+    /// <summary>
+    /// The controller recorder, producing records in real time from RecorderStart().  Use it from one thread at a time.
+    /// </summary>
+    class SimulatedRecorder
+    {
+    public:
+        static const uint64_t SAMPLE_COUNTER_ADDRESS = 0x1;
+        static const int MAX_VALUES = 64;
+
+        /// <param name="sampleRate">Controller samples per second.</param>
+        /// <param name="bufferRecords">Records the controller buffer holds.</param>
+        /// <param name="callOverheadUs">Busy time added to every call.</param>
+        SimulatedRecorder(double sampleRate, int32_t bufferRecords, double callOverheadUs = 0)
+            : sampleRate(sampleRate), bufferRecords(bufferRecords), callOverheadUs(callOverheadUs), period(1), valueCount(0), circular(false),
+              running(false), stopSample(0), consumed(0), overwritten(0), calls(0)
+        {
+            memset(addresses, 0, sizeof(addresses));
+            memset(record, 0, sizeof(record));
+        }
+
+        double  SampleRateGet() const { return sampleRate; }
+        void    RecorderPeriodSet(int32_t samples) { Call(); period = samples > 0 ? samples : 1; }
+        void    RecorderCircularBufferSet(bool enable) { Call(); circular = enable; }
+        void    RecorderDataCountSet(int32_t count) { Call(); valueCount = count < MAX_VALUES ? count : MAX_VALUES; }
+        void    RecorderDataAddressSet(int32_t index, uint64_t address) { Call(); if (index >= 0 && index < MAX_VALUES) addresses[index] = address; }
+
+        void RecorderStart()
+        {
+            Call();
+            start = std::chrono::steady_clock::now();
+            running = true;
+            consumed = 0;
+            overwritten = 0;
+        }
+
+        void RecorderStop()
+        {
+            Call();
+            stopSample = SampleGet();
+            running = false;
+        }
+
+        /// <summary>
+        /// Records waiting to be read.  Overwrites (circular) or stops producing (not circular) once the buffer is full.
+        /// </summary>
+        int32_t RecorderRecordCountGet()
+        {
+            Call();
+            return (int32_t)AvailableUpdate();
+        }
+
+        /// <summary>
+        /// The oldest waiting record, valid until the next call.  Returns the last record again if none is waiting.
+        /// </summary>
+        int32_t* RecorderRecordDataGet()
+        {
+            Call();
+            if (AvailableUpdate() > 0)
+            {
+                const int64_t sample = (consumed + overwritten + 1) * period;
+                for (int32_t i = 0; i < valueCount; i++)
+                {
+                    record[i] = addresses[i] == SAMPLE_COUNTER_ADDRESS ? (int32_t)sample : (int32_t)(addresses[i] + sample);
+                }
+                ++consumed;
+            }
+            return record;
+        }
+
+        /// <summary>
+        /// Up to maxRecords of the oldest waiting records in one call, contiguous and in order, valid until the next call.
+        /// A bulk transfer a controller could offer instead of one RecorderRecordDataGet() per record; see RecorderRecordsSpanGet().
+        /// </summary>
+        const int32_t* RecorderRecordDataSpanGet(int32_t maxRecords, int32_t *recordCount)
+        {
+            Call();
+            const int64_t available = AvailableUpdate();
+            const int32_t count = (int32_t)(maxRecords < available ? maxRecords : available);
+            block.resize((size_t)(count > 0 ? count : 0) * valueCount);
+            for (int32_t r = 0; r < count; r++)
+            {
+                const int64_t sample = (consumed + overwritten + 1) * period;
+                for (int32_t i = 0; i < valueCount; i++)
+                {
+                    block[(size_t)r * valueCount + i] = addresses[i] == SAMPLE_COUNTER_ADDRESS ? (int32_t)sample : (int32_t)(addresses[i] + sample);
+                }
+                ++consumed;
+            }
+            *recordCount = count > 0 ? count : 0;
+            return block.data();
+        }
+
+        /// <summary>
+        /// Records overwritten before they were read: the ground truth a drain loop's loss count should match.
+        /// </summary>
+        int64_t OverwrittenCountGet() const { return overwritten; }
+        int64_t CallCountGet() const { return calls; }
+
+    private:
+        void Call()
+        {
+            StandInBusyWait(callOverheadUs * 1000.0);
+            ++calls;
+        }
+
+        int64_t SampleGet() const
+        {
+            return (int64_t)(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * sampleRate);
+        }
+
+        int64_t AvailableUpdate()
+        {
+            const int64_t produced = (running ? SampleGet() : stopSample) / period;
+            int64_t available = produced - consumed - overwritten;
+            if (available > bufferRecords)
+            {
+                if (circular)
+                {
+                    overwritten += available - bufferRecords;       // the oldest records are gone
+                }
+                else
+                {
+                    stopSample = (consumed + overwritten + bufferRecords) * period;
+                    running = false;                                // a full linear buffer stops recording
+                }
+                available = bufferRecords;
+            }
+            return available;
+        }
+
+        double      sampleRate;
+        int32_t     bufferRecords;
+        double      callOverheadUs;
+        int32_t     period;
+        int32_t     valueCount;
+        bool        circular;
+        bool        running;
+        int64_t     stopSample;
+        int64_t     consumed;
+        int64_t     overwritten;
+        int64_t     calls;
+        uint64_t    addresses[MAX_VALUES];
+        int32_t     record[MAX_VALUES];
+        std::vector<int32_t> block;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+#endif
@@ -0,0 +1,301 @@
+/*!
+@example    MovePTBenchmark.cpp
+
+*  @page       move-pt-benchmark-cpp MovePTBenchmark.cpp
+
+*  @brief      Benchmark of MovePT()/MovePVT() host cost across block size, axis count and motion type.
+
+*  @details
+Streams points with the UpdateBufferPoints.cpp pattern (keep two blocks queued, send the next one when there is room),
+sweeping BUFFER_SZ, AXIS_COUNT and PT vs PVT.  Only the MovePT()/MovePVT() calls are timed.  For every combination it prints:
+
+- the host throughput in points per second of call time,
+- the p50/p90/p99/max latency of a single call in microseconds.
+
+The sweep always runs against SimulatedMultiAxis (MotionControllerStandIn.h), so it works on a Linux CI box with no hardware.
+Build with SAMPLEAPPS_NO_RAPIDCODE defined to leave out rsi.h entirely.  Without it, set RUN_ON_CONTROLLER to also run
+the sweep on a real controller and compare the two tables.  Use phantom axes there: the benchmark points are not a smooth path.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include MovePTBenchmark.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#endif
+#include "MotionControllerStandIn.h"                // Import the software stand-in for the controller.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int       BUFFER_SIZES[] = { 1, 10, 50, 100, 250, 500, 1000 };
+    const int       AXIS_COUNTS[] = { 1, 2, 4, 8 };
+    const int       MAX_BUFFER_SZ = 1000;
+    const int       MAX_AXES = 8;
+    const int       EMPTY_CT = -1;                                      // the stand-in and the hardware run never starve, so no e-stop
+    const double    TIME_SLICE = 0.001;                                 // one point per 1kHz sample
+    const int       STAND_IN_POINTS = 200000;                           // points streamed per combination on the stand-in
+    const int       CONTROLLER_POINTS = 2000;                           // points streamed per combination on a controller (2 seconds of motion)
+    const bool      RUN_ON_CONTROLLER = false;                          // set true to also sweep a real controller
+
+    struct CallStats
+    {
+        double pointsPerSecond;
+        double p50Us;
+        double p90Us;
+        double p99Us;
+        double maxUs;
+    };
+
+    // one block of points, reused for every call
+    double blockPositions[MAX_BUFFER_SZ * MAX_AXES];
+    double blockVelocities[MAX_BUFFER_SZ * MAX_AXES];
+    double blockTimes[MAX_BUFFER_SZ];
+
+    void BlockPrepare()
+    {
+        for (int i = 0; i < MAX_BUFFER_SZ * MAX_AXES; i++)
+        {
+            blockPositions[i] = i * 0.001;
+            blockVelocities[i] = 1.0;
+        }
+        for (int i = 0; i < MAX_BUFFER_SZ; i++)
+        {
+            blockTimes[i] = TIME_SLICE;
+        }
+    }
+
+    CallStats Summarize(std::vector<double>& callUs, int64_t points)
+    {
+        CallStats stats;
+        double total = 0;
+        for (size_t i = 0; i < callUs.size(); i++)
+        {
+            total += callUs[i];
+        }
+        std::sort(callUs.begin(), callUs.end());
+        stats.pointsPerSecond = points / (total * 1e-6);
+        stats.p50Us = callUs[callUs.size() / 2];
+        stats.p90Us = callUs[(callUs.size() * 90) / 100];
+        stats.p99Us = callUs[(callUs.size() * 99) / 100];
+        stats.maxUs = callUs.back();
+        return stats;
+    }
+
+    // Stream totalPoints in blocks of bufferSize and time each call.
+    // Target needs Start(axisCount), Send(pvt, count, final) and WaitForRoom(bufferSize).
+    template <class Target>
+    CallStats StreamAndTime(Target& target, int bufferSize, int axisCount, bool pvt, int totalPoints)
+    {
+        std::vector<double> callUs;
+        callUs.reserve(totalPoints / bufferSize + 1);
+
+        target.Start(axisCount);
+        int sent = 0;
+        while (sent < totalPoints)
+        {
+            int count = (totalPoints - sent < bufferSize) ? (totalPoints - sent) : bufferSize;
+            bool final = (sent + count >= totalPoints);
+
+            Clock::time_point start = Clock::now();
+            target.Send(pvt, count, final);
+            callUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+            sent += count;
+            if (!final)
+            {
+                target.WaitForRoom(bufferSize);
+            }
+        }
+        target.Finish();
+        return Summarize(callUs, sent);
+    }
+
+    // Streams into a SimulatedMultiAxis, letting it consume one block of samples between calls.
+    class StandInTarget
+    {
+    public:
+        StandInTarget() : multiAxis(nullptr) {}
+        ~StandInTarget() { delete multiAxis; }
+
+        void Start(int axisCount)
+        {
+            delete multiAxis;
+            multiAxis = new SampleAppsCPP::SimulatedMultiAxis(axisCount, 4 * MAX_BUFFER_SZ, TIME_SLICE);
+        }
+
+        void Send(bool pvt, int count, bool final)
+        {
+            if (pvt)
+                multiAxis->MovePVT(blockPositions, blockVelocities, blockTimes, count, EMPTY_CT, false, final);
+            else
+                multiAxis->MovePT(0, blockPositions, blockTimes, count, EMPTY_CT, false, final);
+        }
+
+        void WaitForRoom(int bufferSize)
+        {
+            // the controller keeps running while we wait; keep roughly two blocks queued
+            while (multiAxis->QueuedPointsGet() >= 2 * bufferSize)
+            {
+                multiAxis->SamplesAdvance(bufferSize);
+            }
+        }
+
+        void Finish()
+        {
+            if (multiAxis->IsOverflowedGet() || multiAxis->IsEStoppedGet())
+            {
+                printf("Stand-in reported an %s.\n", multiAxis->IsOverflowedGet() ? "overflow" : "e-stop");
+            }
+        }
+
+    private:
+        SampleAppsCPP::SimulatedMultiAxis *multiAxis;
+    };
+
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    using namespace RSI::RapidCode;
+
+    // Streams into a real MultiAxis, waiting on the sync interrupt like UpdateBufferPoints.cpp.
+    class ControllerTarget
+    {
+    public:
+        explicit ControllerTarget(MotionController *controller) : controller(controller), multiAxis(nullptr), finalMotionID(0)
+        {
+            // one MultiAxis per axis count, each on its own motion supervisor after the axes
+            const int multiAxisCount = sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]);
+            controller->AxisCountSet(MAX_AXES);                     // phantom axes are created for any axis not on the network
+            controller->MotionCountSet(MAX_AXES + multiAxisCount);
+            for (int i = 0; i < multiAxisCount; i++)
+            {
+                multiAxes[i] = controller->MultiAxisGet(MAX_AXES + i);
+                SampleAppsCPP::HelperFunctions::CheckErrors(multiAxes[i]);
+                for (int axis = 0; axis < AXIS_COUNTS[i]; axis++)
+                {
+                    multiAxes[i]->AxisAdd(controller->AxisGet(axis));
+                }
+            }
+            controller->SyncInterruptPeriodSet(1);
+            controller->SyncInterruptEnableSet(true);
+        }
+
+        ~ControllerTarget()
+        {
+            controller->SyncInterruptEnableSet(false);
+        }
+
+        void Start(int axisCount)
+        {
+            for (size_t i = 0; i < sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]); i++)
+            {
+                if (AXIS_COUNTS[i] == axisCount)
+                {
+                    multiAxis = multiAxes[i];
+                }
+            }
+            multiAxis->Abort();
+            multiAxis->ClearFaults();
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                multiAxis->AxisGet(axis)->PositionSet(0);
+            }
+            multiAxis->AmpEnableSet(true);
+            multiAxis->MotionIdSet(0);
+            finalMotionID = 0;
+        }
+
+        void Send(bool pvt, int count, bool final)
+        {
+            if (pvt)
+                multiAxis->MovePVT(blockPositions, blockVelocities, blockTimes, count, EMPTY_CT, false, final);
+            else
+                multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, blockPositions, blockTimes, count, EMPTY_CT, false, final);
+            ++finalMotionID;
+        }
+
+        void WaitForRoom(int /*bufferSize*/)
+        {
+            // keep at least two motion IDs queued, exactly like UpdateBufferPoints.cpp
+            while (std::abs(finalMotionID - multiAxis->MotionIdExecutingGet()) >= 2)
+            {
+                controller->SyncInterruptWait();
+            }
+        }
+
+        void Finish()
+        {
+            multiAxis->MotionDoneWait();
+            multiAxis->AmpEnableSet(false);
+        }
+
+    private:
+        MotionController    *controller;
+        MultiAxis           *multiAxes[sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0])];
+        MultiAxis           *multiAxis;
+        int                 finalMotionID;
+    };
+#endif
+
+    template <class Target>
+    void Sweep(Target& target, const char *name, int totalPoints)
+    {
+        printf("\n%s: %d points per combination\n", name, totalPoints);
+        printf("%4s %5s %9s | %14s %9s %9s %9s %9s\n", "type", "axes", "BUFFER_SZ", "points/s", "p50 us", "p90 us", "p99 us", "max us");
+        for (int pvt = 0; pvt <= 1; pvt++)
+        {
+            for (size_t axisIndex = 0; axisIndex < sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]); axisIndex++)
+            {
+                for (size_t sizeIndex = 0; sizeIndex < sizeof(BUFFER_SIZES) / sizeof(BUFFER_SIZES[0]); sizeIndex++)
+                {
+                    CallStats stats = StreamAndTime(target, BUFFER_SIZES[sizeIndex], AXIS_COUNTS[axisIndex], pvt != 0, totalPoints);
+                    printf("%4s %5d %9d | %14.0f %9.2f %9.2f %9.2f %9.2f\n", pvt ? "PVT" : "PT", AXIS_COUNTS[axisIndex], BUFFER_SIZES[sizeIndex],
+                        stats.pointsPerSecond, stats.p50Us, stats.p90Us, stats.p99Us, stats.maxUs);
+                }
+            }
+        }
+    }
+}
+
+void movePTBenchmarkMain()
+{
+    BlockPrepare();
+
+    StandInTarget standIn;
+    Sweep(standIn, "Software stand-in", STAND_IN_POINTS);
+
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    if (RUN_ON_CONTROLLER)
+    {
+        MotionController *controller = MotionController::CreateFromSoftware();
+        SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+        try
+        {
+            SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+            ControllerTarget hardware(controller);
+            Sweep(hardware, "Controller", CONTROLLER_POINTS);
+        }
+        catch (RsiError const& err)
+        {
+            printf("\n%s\n", err.text);
+        }
+        controller->Delete();                               // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+    }
+#endif
+}
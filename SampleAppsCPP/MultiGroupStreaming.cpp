@@ -0,0 +1,113 @@
+/*!
+@example    MultiGroupStreaming.cpp
+
+*  @page       multi-group-streaming-cpp MultiGroupStreaming.cpp
+
+*  @brief      Streams eight independent two-axis groups from one SyncInterruptWait() loop.
+
+*  @details
+Each group is a MultiAxis on its own motion supervisor with its own StreamingSession (StreamingSession.h) and trajectory source.
+One StreamingScheduler services all of them every sync interrupt, refilling the group with the fewest queued points first
+and making at most MAX_CALLS_PER_CYCLE MovePT() calls per cycle.  No thread is created per group.
+At the end it prints the fewest points each group ever had queued and how often a refill had to wait a cycle.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.  Axes not on the network are created as phantom axes.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include MultiGroupStreaming.cpp
+*/
+
+#include <vector>
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "StreamingSession.h"                       // Import the streaming sessions and scheduler.
+
+using namespace RSI::RapidCode;
+
+void multiGroupStreamingMain()
+{
+    typedef SampleAppsCPP::StreamingSession<MultiAxis, RSIMotionType> Session;
+
+    const int       GROUP_COUNT = (8);                                  // independent gantry groups
+    const int       AXES_PER_GROUP = (2);
+    const long      POINTS = (10000);                                   // points per group, 10 seconds of motion
+    const double    TIME_SLICE = (0.001);                               // one point per 1kHz sample
+    const int       BUFFER_SZ = (50);                                   // points per MovePT() call
+    const int       TARGET_QUEUED = (3 * BUFFER_SZ);                    // refill a group when fewer points than this are queued
+    const int       EMPTY_CT = (10);                                    // Number of points that remains in the buffer before an e-stop
+    const int       SYNC_PERIOD = (10);                                 // samples between sync interrupts
+    const int       MAX_CALLS_PER_CYCLE = (GROUP_COUNT);                // bound on MovePT() calls per sync interrupt
+
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    try
+    {
+        SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+        const int axisCount = GROUP_COUNT * AXES_PER_GROUP;
+        controller->AxisCountSet(axisCount);                            // A phantom axis will be created for any axis not on the network.
+        controller->MotionCountSet(axisCount + GROUP_COUNT);            // one motion supervisor per axis, then one per group
+
+        // sources and sessions hold references to each other, so reserve before adding
+        std::vector<SampleAppsCPP::ConstantVelocitySource> sources;
+        std::vector<Session> sessions;
+        sources.reserve(GROUP_COUNT);
+        sessions.reserve(GROUP_COUNT);
+        SampleAppsCPP::StreamingScheduler<Session, GROUP_COUNT> scheduler;
+
+        for (int group = 0; group < GROUP_COUNT; group++)
+        {
+            MultiAxis *multiAxis = controller->MultiAxisGet(axisCount + group);
+            SampleAppsCPP::HelperFunctions::CheckErrors(multiAxis);
+            for (int axis = 0; axis < AXES_PER_GROUP; axis++)
+            {
+                Axis *member = controller->AxisGet(group * AXES_PER_GROUP + axis);
+                SampleAppsCPP::HelperFunctions::CheckErrors(member);
+                member->PositionSet(0);
+                multiAxis->AxisAdd(member);
+            }
+            multiAxis->Abort();
+            multiAxis->ClearFaults();
+            multiAxis->AmpEnableSet(true);
+
+            sources.push_back(SampleAppsCPP::ConstantVelocitySource(AXES_PER_GROUP, POINTS, TIME_SLICE, 0.5 + 0.25 * group));  // each group at its own speed
+            sessions.push_back(Session(multiAxis, RSIMotionType::RSIMotionTypePT, sources.back(), TARGET_QUEUED, BUFFER_SZ, EMPTY_CT));
+            sessions.back().Start();
+            scheduler.SessionAdd(&sessions.back());
+        }
+
+        // queue the first blocks of every group before the interrupts start
+        scheduler.Service(GROUP_COUNT * (TARGET_QUEUED / BUFFER_SZ + 1));
+
+        controller->SyncInterruptPeriodSet(SYNC_PERIOD);
+        controller->SyncInterruptEnableSet(true);
+        while (scheduler.Service(MAX_CALLS_PER_CYCLE) > 0)
+        {
+            controller->SyncInterruptWait();
+        }
+        controller->SyncInterruptEnableSet(false);
+
+        printf("Updates Done. Waiting to finish motion.\n");
+        for (int group = 0; group < GROUP_COUNT; group++)
+        {
+            sessions[group].MultiAxisGet()->MotionDoneWait();
+            printf("Group %d: %lld points sent, fewest queued %lld\n", group, (long long)sessions[group].PointsSentGet(), (long long)sessions[group].MinQueuedPointsGet());
+            sessions[group].MultiAxisGet()->AmpEnableSet(false);
+        }
+        printf("%lld cycles, %lld refills deferred to the next cycle\n", (long long)scheduler.CycleCountGet(), (long long)scheduler.DeferredRefillCountGet());
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
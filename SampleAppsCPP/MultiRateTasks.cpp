@@ -0,0 +1,200 @@
+/*!
+@example    MultiRateTasks.cpp
+
+*  @page       multi-rate-tasks-cpp MultiRateTasks.cpp
+
+*  @brief      1 kHz control-law compute, 100 Hz supervision and 10 Hz HMI tasks run by one rate-monotonic scheduler on the controller's Sync interrupt.
+
+*  @details
+Instead of one thread per rate, every task runs from the SyncInterruptWait() loop through RateMonotonicScheduler:
+
+- compute, every Sync interrupt: one CycleIO read of all axis positions, then the host control law.  It only computes, to load the cycle
+the way a control task would: the outputs are not written to the drives.  SyncInterrupt.cpp shows how to write them as torques,
+- supervision, at SUPERVISION_HZ: checks every axis for an error state or amp fault and logs changes,
+- HMI, at HMI_HZ: queues the positions for display on the cycle log.
+
+The divisors come from the controller sample rate, so the rates hold for any SYNC_PERIOD that divides them.
+The scheduler spreads supervision and HMI onto different cycles, and defers them to the next cycle if the compute task has already used
+BUDGET_FRACTION of SyncInterruptHostProcessTimeGet().  After the loop it prints each task's rate, phase, runs, deferrals and execution times.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include MultiRateTasks.cpp
+*/
+
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "CyclicExecutor.h"                         // Import the real-time thread setup and self-check.
+#include "CycleIO.h"                                // Import the bulk cycle I/O layer.
+#include "CycleLog.h"                               // Import the asynchronous cycle log.
+#include "HostControlLaw.h"                         // Import the SIMD host control law.
+#include "RateMonotonicScheduler.h"                 // Import the multi-rate task scheduler.
+using namespace RSI::RapidCode;
+
+namespace
+{
+    const int       SYNC_PERIOD = 1;                    // interrupt every SynqNet/MotionController sample
+    const int       AXIS_COUNT = 6;                     // how many axes the tasks look at
+    const double    SUPERVISION_HZ = 100.0;
+    const double    HMI_HZ = 10.0;
+    const double    BUDGET_FRACTION = 0.8;              // share of the host process time the tasks may use before slower ones are deferred
+    const int       RT_CPU = -1;                        // CPU to pin the sync thread to, -1 for any
+
+    typedef SampleAppsCPP::HostControlLaw<AXIS_COUNT> ControlLaw;
+
+    // everything the tasks share; they all run on the sync thread, so no locking
+    struct TaskState
+    {
+        MotionController    *controller;
+        Axis                *axes[AXIS_COUNT];
+        SampleAppsCPP::CycleIO *cycleIO;
+        int                 positionChannels[AXIS_COUNT];
+        double              positions[AXIS_COUNT];
+        ControlLaw          *controlLaw;
+        bool                faulted[AXIS_COUNT];
+    };
+
+    SampleAppsCPP::CycleLog<1024> taskLog;
+
+    // computes the law's outputs and leaves them in controlLaw; nothing is written to the controller
+    void ComputeTask(void *context, int32_t sample)
+    {
+        TaskState& state = *static_cast<TaskState *>(context);
+        (void)sample;
+        state.cycleIO->Snapshot(state.controller);
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            state.positions[i] = state.cycleIO->ReadDoubleGet(state.positionChannels[i]);
+            state.controlLaw->ActualPositionsGet()[i] = state.positions[i];
+        }
+        state.controlLaw->Update();
+    }
+
+    void SupervisionTask(void *context, int32_t sample)
+    {
+        TaskState& state = *static_cast<TaskState *>(context);
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            const bool faulted = state.axes[i]->StateGet() == RSIState::RSIStateERROR || state.axes[i]->StatusBitGet(RSIEventType::RSIEventTypeAMP_FAULT);
+            if (faulted != state.faulted[i])
+            {
+                taskLog.Log("sample %d: axis %d %s\n", sample, i, faulted ? "faulted" : "fault cleared");
+                state.faulted[i] = faulted;
+            }
+        }
+    }
+
+    void HmiTask(void *context, int32_t sample)
+    {
+        TaskState& state = *static_cast<TaskState *>(context);
+        taskLog.Log("sample %d: positions %.0lf %.0lf %.0lf\n", sample, state.positions[0], state.positions[1], state.positions[2]);
+    }
+}
+
+void multiRateTasksMain()
+{
+    static_assert(AXIS_COUNT >= 3, "HmiTask() prints three axes.");
+    TaskState state = TaskState();
+
+    // create and Initialize MotionController class.
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    state.controller = controller;
+    try
+    {
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            state.axes[i] = controller->AxisGet(i);
+            SampleAppsCPP::HelperFunctions::CheckErrors(state.axes[i]);
+        }
+
+        // one bulk read of every axis position per control cycle
+        const uint64 axisStride = AXIS_COUNT > 1 ? state.axes[1]->AddressGet(RSIAxisAddressTypeACTUAL_POSITION) - state.axes[0]->AddressGet(RSIAxisAddressTypeACTUAL_POSITION) : 0;
+        SampleAppsCPP::CycleIO cycleIO((int32)axisStride);
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            state.positionChannels[i] = cycleIO.ReadAdd(state.axes[i]->AddressGet(RSIAxisAddressTypeACTUAL_POSITION), sizeof(double));
+        }
+        cycleIO.Build();
+        state.cycleIO = &cycleIO;
+
+        // compute the law against every axis's starting position.  Its outputs are never applied, so nothing moves.
+        ControlLaw controlLaw(AXIS_COUNT, SYNC_PERIOD / controller->SampleRateGet());
+        cycleIO.Snapshot(controller);
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            controlLaw.CommandPositionsGet()[i] = cycleIO.ReadDoubleGet(state.positionChannels[i]);
+        }
+        state.controlLaw = &controlLaw;
+
+        // one task per rate: the divisor is how many Sync interrupts apart it runs
+        const double cycleHz = controller->SampleRateGet() / SYNC_PERIOD;
+        const double hostProcessTime = controller->SyncInterruptHostProcessTimeGet();
+        SampleAppsCPP::RateMonotonicScheduler scheduler(SYNC_PERIOD, controller->SampleRateGet(), BUDGET_FRACTION * hostProcessTime);
+        scheduler.TaskAdd("compute", 1, ComputeTask, &state, 10.0);
+        scheduler.TaskAdd("supervision", (int32)(cycleHz / SUPERVISION_HZ + 0.5), SupervisionTask, &state, 20.0);
+        scheduler.TaskAdd("HMI", (int32)(cycleHz / HMI_HZ + 0.5), HmiTask, &state, 5.0);
+        scheduler.Build();
+        printf("Host will have %.0lf microseconds per cycle, the tasks may use %.0lf (planned peak %.1lf)\n",
+            hostProcessTime, BUDGET_FRACTION * hostProcessTime, scheduler.PlannedPeakUsGet());
+
+        // disable the service thread if using the controller Sync interrupt
+        controller->ServiceThreadEnableSet(false);
+
+        // start the log's flush thread before the real-time setup, so it does not inherit it
+        taskLog.Start(stdout);
+        SampleAppsCPP::CyclicExecutorConfig rtConfig;
+        rtConfig.cpu = RT_CPU;
+        SampleAppsCPP::CyclicExecutor executor(rtConfig);
+        executor.Configure();
+
+        controller->SyncInterruptPeriodSet(SYNC_PERIOD);
+        controller->SyncInterruptEnableSet(true);
+
+        printf("Press a key to exit the Sync Interrupt processing loop...\n");
+        while (controller->OS->KeyGet(RSIWaitPOLL) < 0)
+        {
+            // wait for the controller's Sync interrupt
+            int32 sample = controller->SyncInterruptWait();
+
+            // did we take too long processing the previous interrupt?
+            if (controller->SyncInterruptHostProcessStatusBitGet() == true)
+            {
+                taskLog.Log("sample %d: took too long processing the last interrupt\n", sample);
+                controller->SyncInterruptHostProcessStatusClear();
+            }
+
+            // run every task due this cycle, fastest first
+            controller->SyncInterruptHostProcessFlagSet(true);
+            scheduler.Dispatch(sample);
+            controller->SyncInterruptHostProcessFlagSet(false);
+        }
+
+        // turn off Sync Interrupt
+        controller->SyncInterruptEnableSet(false);
+        taskLog.Stop();
+        scheduler.Print(stdout);
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+
+    printf("Press a key to exit.\n");
+    while (controller->OS->KeyGet(RSIWaitPOLL) < 0)
+    {
+        controller->OS->Sleep(100); //ms
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
@@ -0,0 +1,437 @@
+/*!
+*  @example    PVTBuilder.h
+
+*  @page       pvt-builder-cpp PVTBuilder.h
+
+*  @brief      Heap-backed PVT point builder with central-difference and cubic-spline velocities.
+
+*  @details
+PVTmotionMultiAxis.cpp keeps its points in stack arrays of POINTS * AXIS_COUNT doubles, which overflows the stack long before
+a million-point path.  It also uses a forward difference for the velocities, so each velocity belongs to the segment after its point.
+PVTBuilder keeps the points on the heap in MovePVT() order (x0,y0,x1,y1...).  Clear() keeps the capacity, so a builder reused
+for path after path stops allocating once it has grown to the largest one.  VelocitiesCompute() fills the velocities with one of:
+
+- ForwardDifference: the PVTmotionMultiAxis.cpp loop, for comparison,
+- CentralDifference: the time-weighted three-point derivative at every point,
+- CubicSpline: the velocities of the clamped cubic spline through the points, which is continuous in acceleration
+  (one tridiagonal solve shared by all axes).
+
+The first point is measured from the start position set with StartSet(), because MovePVT() times are the duration of the segment
+that ends at each point.  The start velocity (default 0) clamps the spline and the end velocity (default 0) is given to the last point.
+Both kernels are vectorized across the flat point array when the time slice is constant, and across axes otherwise,
+using the instruction set chosen in PointTranspose.h.  The spline solve runs sequentially along the path, so it is several times
+slower than the differences, but its velocity error is orders of magnitude smaller (see PVTBuilderBenchmark.cpp).
+
+PVTBuilderSource streams the result in blocks through the TrajectorySource interface (TrajectorySource.h).
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include PVTBuilder.h
+
+*/
+#ifndef CPP_PVT_BUILDER
+#define CPP_PVT_BUILDER
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "PointTranspose.h"                         // Import the SIMD selection and the point interleave utility.
+#include "TrajectorySource.h"                       // Import the streaming trajectory source interface.
+
+namespace SampleAppsCPP
+{
+    enum class PVTVelocityMethod
+    {
+        ForwardDifference,                          // slope of the segment after each point (PVTmotionMultiAxis.cpp)
+        CentralDifference,                          // time-weighted slope of the segments on both sides of each point
+        CubicSpline,                                // clamped cubic spline, continuous acceleration
+    };
+
+    /// <summary>
+    /// out[j] = a * p[j - stride] + b * p[j] + c * p[j + stride] for j in [0, count).
+    /// </summary>
+    inline void ThreePointApply(const double *p, int64_t stride, int64_t count, double a, double b, double c, double *out)
+    {
+        int64_t j = 0;
+#if defined(SAMPLEAPPS_SIMD_AVX)
+        const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b), vc = _mm256_set1_pd(c);
+        for (; j + 4 <= count; j += 4)
+        {
+            __m256d sum = _mm256_mul_pd(va, _mm256_loadu_pd(p + j - stride));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(vb, _mm256_loadu_pd(p + j)));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(vc, _mm256_loadu_pd(p + j + stride)));
+            _mm256_storeu_pd(out + j, sum);
+        }
+#endif
+#if defined(SAMPLEAPPS_SIMD_SSE2) || defined(SAMPLEAPPS_SIMD_AVX)
+        const __m128d sa = _mm_set1_pd(a), sb = _mm_set1_pd(b), sc = _mm_set1_pd(c);
+        for (; j + 2 <= count; j += 2)
+        {
+            __m128d sum = _mm_mul_pd(sa, _mm_loadu_pd(p + j - stride));
+            sum = _mm_add_pd(sum, _mm_mul_pd(sb, _mm_loadu_pd(p + j)));
+            sum = _mm_add_pd(sum, _mm_mul_pd(sc, _mm_loadu_pd(p + j + stride)));
+            _mm_storeu_pd(out + j, sum);
+        }
+#endif
+        for (; j < count; j++)
+        {
+            out[j] = a * p[j - stride] + b * p[j] + c * p[j + stride];
+        }
+    }
+
+    /// <summary>
+    /// out[j] = (r[j] - coefficient * other[j]) * scale for j in [0, count).  out may be r.
+    /// </summary>
+    inline void SubtractScale(const double *r, const double *other, double coefficient, double scale, int64_t count, double *out)
+    {
+        int64_t j = 0;
+#if defined(SAMPLEAPPS_SIMD_AVX)
+        const __m256d vk = _mm256_set1_pd(coefficient), vs = _mm256_set1_pd(scale);
+        for (; j + 4 <= count; j += 4)
+        {
+            __m256d value = _mm256_sub_pd(_mm256_loadu_pd(r + j), _mm256_mul_pd(vk, _mm256_loadu_pd(other + j)));
+            _mm256_storeu_pd(out + j, _mm256_mul_pd(value, vs));
+        }
+#endif
+#if defined(SAMPLEAPPS_SIMD_SSE2) || defined(SAMPLEAPPS_SIMD_AVX)
+        const __m128d sk = _mm_set1_pd(coefficient), ss = _mm_set1_pd(scale);
+        for (; j + 2 <= count; j += 2)
+        {
+            __m128d value = _mm_sub_pd(_mm_loadu_pd(r + j), _mm_mul_pd(sk, _mm_loadu_pd(other + j)));
+            _mm_storeu_pd(out + j, _mm_mul_pd(value, ss));
+        }
+#endif
+        for (; j < count; j++)
+        {
+            out[j] = (r[j] - coefficient * other[j]) * scale;
+        }
+    }
+
+    class PVTBuilder
+    {
+    public:
+        explicit PVTBuilder(int32_t axisCount)
+            : axisCount(axisCount), startPositions(axisCount, 0.0), startVelocities(axisCount, 0.0), endVelocities(axisCount, 0.0), uniformTimes(true) {}
+
+        int32_t AxisCountGet() const { return axisCount; }
+        int64_t PointCountGet() const { return (int64_t)times.size(); }
+
+        /// <summary>
+        /// Forget the points but keep the memory for the next path.
+        /// </summary>
+        void Clear()
+        {
+            positions.clear();
+            velocities.clear();
+            times.clear();
+            uniformTimes = true;
+        }
+
+        void Reserve(int64_t pointCount)
+        {
+            positions.reserve((size_t)(pointCount * axisCount));
+            velocities.reserve((size_t)(pointCount * axisCount));
+            times.reserve((size_t)pointCount);
+        }
+
+        /// <summary>
+        /// Axis positions before the first point (what PositionSet() or the previous motion left) and the velocity there.
+        /// </summary>
+        void StartSet(const double *positionsAtStart, const double *velocitiesAtStart = nullptr)
+        {
+            for (int32_t axis = 0; axis < axisCount; axis++)
+            {
+                startPositions[axis] = positionsAtStart[axis];
+                startVelocities[axis] = velocitiesAtStart ? velocitiesAtStart[axis] : 0.0;
+            }
+        }
+
+        /// <summary>
+        /// Velocities at the last point.  Leave them at 0 to stop there.
+        /// </summary>
+        void EndVelocitiesSet(const double *velocitiesAtEnd)
+        {
+            for (int32_t axis = 0; axis < axisCount; axis++)
+            {
+                endVelocities[axis] = velocitiesAtEnd[axis];
+            }
+        }
+
+        /// <summary>
+        /// Append interleaved positions (MovePVT() order) with their segment times.
+        /// </summary>
+        void PointsAppend(const double *pointPositions, const double *pointTimes, int32_t pointCount)
+        {
+            positions.insert(positions.end(), pointPositions, pointPositions + (size_t)pointCount * axisCount);
+            for (int32_t i = 0; i < pointCount; i++)
+            {
+                TimeAppend(pointTimes[i]);
+            }
+        }
+
+        /// <summary>
+        /// Append interleaved positions that are all timeSlice apart.
+        /// </summary>
+        void PointsAppend(const double *pointPositions, double timeSlice, int32_t pointCount)
+        {
+            positions.insert(positions.end(), pointPositions, pointPositions + (size_t)pointCount * axisCount);
+            for (int32_t i = 0; i < pointCount; i++)
+            {
+                TimeAppend(timeSlice);
+            }
+        }
+
+        /// <summary>
+        /// Append positions given as one array per axis, all timeSlice apart.
+        /// </summary>
+        void PointsAppend(const double *const *axisPositions, double timeSlice, int32_t pointCount)
+        {
+            const size_t first = positions.size();
+            positions.resize(first + (size_t)pointCount * axisCount);
+            PointsInterleave(axisPositions, axisCount, pointCount, &positions[first]);
+            for (int32_t i = 0; i < pointCount; i++)
+            {
+                TimeAppend(timeSlice);
+            }
+        }
+
+        /// <summary>
+        /// Fill the velocities of every point.  Call after the last PointsAppend().
+        /// </summary>
+        void VelocitiesCompute(PVTVelocityMethod method)
+        {
+            const int64_t pointCount = PointCountGet();
+            velocities.resize(positions.size());
+            if (pointCount == 0)
+            {
+                return;
+            }
+            switch (method)
+            {
+            case PVTVelocityMethod::ForwardDifference:  ForwardDifferenceCompute(pointCount); break;
+            case PVTVelocityMethod::CentralDifference:  CentralDifferenceCompute(pointCount); break;
+            case PVTVelocityMethod::CubicSpline:        CubicSplineCompute(pointCount); break;
+            }
+            memcpy(&velocities[(size_t)(pointCount - 1) * axisCount], &endVelocities[0], sizeof(double) * axisCount);
+        }
+
+        const double* PositionsGet(int64_t point) const { return &positions[(size_t)(point * axisCount)]; }
+        const double* VelocitiesGet(int64_t point) const { return &velocities[(size_t)(point * axisCount)]; }
+        const double* TimesGet(int64_t point) const { return &times[(size_t)point]; }
+
+    private:
+        void TimeAppend(double time)
+        {
+            if (!times.empty() && time != times[0])
+            {
+                uniformTimes = false;
+            }
+            times.push_back(time);
+        }
+
+        // Position of point k, where point -1 is the start position.
+        double PositionGet(int64_t k, int32_t axis) const
+        {
+            return k < 0 ? startPositions[axis] : positions[(size_t)(k * axisCount + axis)];
+        }
+
+        // v[k] = (p[k+1] - p[k]) / t[k+1], the PVTmotionMultiAxis.cpp loop.
+        void ForwardDifferenceCompute(int64_t pointCount)
+        {
+            if (uniformTimes)
+            {
+                SubtractScale(&positions[(size_t)axisCount], &positions[0], 1.0, 1.0 / times[0], (pointCount - 1) * axisCount, &velocities[0]);
+                return;
+            }
+            for (int64_t k = 0; k + 1 < pointCount; k++)
+            {
+                const double *point = &positions[(size_t)(k * axisCount)];
+                SubtractScale(point + axisCount, point, 1.0, 1.0 / times[(size_t)(k + 1)], axisCount, &velocities[(size_t)(k * axisCount)]);
+            }
+        }
+
+        // Coefficients of p[k-1], p[k], p[k+1] in the time-weighted central difference at point k.
+        static void CentralCoefficientsGet(double left, double right, double& a, double& b, double& c)
+        {
+            a = -right / (left * (left + right));
+            c = left / (right * (left + right));
+            b = -(a + c);
+        }
+
+        // Coefficients of p[k-1], p[k], p[k+1] in the right-hand side of spline row k.
+        static void SplineCoefficientsGet(double left, double right, double& a, double& b, double& c)
+        {
+            a = -3.0 * right / left;
+            c = 3.0 * left / right;
+            b = -(a + c);
+        }
+
+        // Apply a three-point stencil to points [1, last) into out; point 0 needs the start position and is done separately.
+        template <class CoefficientsGet>
+        void StencilApply(int64_t last, CoefficientsGet coefficientsGet, double *out) const
+        {
+            if (last <= 1)
+            {
+                return;
+            }
+            double a, b, c;
+            if (uniformTimes)
+            {
+                coefficientsGet(times[0], times[0], a, b, c);
+                ThreePointApply(&positions[(size_t)axisCount], axisCount, (last - 1) * axisCount, a, b, c, out + axisCount);
+                return;
+            }
+            for (int64_t k = 1; k < last; k++)
+            {
+                coefficientsGet(times[(size_t)k], times[(size_t)(k + 1)], a, b, c);
+                ThreePointApply(&positions[(size_t)(k * axisCount)], axisCount, axisCount, a, b, c, out + k * axisCount);
+            }
+        }
+
+        void CentralDifferenceCompute(int64_t pointCount)
+        {
+            const int64_t last = pointCount - 1;                        // the last point gets the end velocity
+            if (last <= 0)
+            {
+                return;
+            }
+            double a, b, c;
+            CentralCoefficientsGet(times[0], times[1], a, b, c);
+            for (int32_t axis = 0; axis < axisCount; axis++)
+            {
+                velocities[axis] = a * PositionGet(-1, axis) + b * PositionGet(0, axis) + c * PositionGet(1, axis);
+            }
+            StencilApply(last, CentralCoefficientsGet, &velocities[0]);
+        }
+
+        // Clamped cubic spline through the start position and every point.  Row k (unknown v[k], k in [0, last)) is
+        //   right * v[k-1] + 2 * (left + right) * v[k] + left * v[k+1] = 3 * (right * slopeLeft + left * slopeRight)
+        // with v[-1] the start velocity and v[last] the end velocity.  The matrix depends only on the times,
+        // so the Thomas algorithm factors it once and every axis shares the factors.
+        void CubicSplineCompute(int64_t pointCount)
+        {
+            const int64_t last = pointCount - 1;
+            if (last <= 0)
+            {
+                return;
+            }
+            const size_t A = (size_t)axisCount;
+
+            // right-hand side into velocities
+            double a, b, c;
+            SplineCoefficientsGet(times[0], times[1], a, b, c);
+            for (int32_t axis = 0; axis < axisCount; axis++)
+            {
+                velocities[axis] = a * PositionGet(-1, axis) + b * PositionGet(0, axis) + c * PositionGet(1, axis) - times[1] * startVelocities[axis];
+            }
+            StencilApply(last, SplineCoefficientsGet, &velocities[0]);
+            for (int32_t axis = 0; axis < axisCount; axis++)
+            {
+                velocities[(size_t)(last - 1) * A + axis] -= times[(size_t)(last - 1)] * endVelocities[axis];
+            }
+
+            // factor the matrix once; it depends only on the times
+            upperFactors.resize((size_t)last);
+            rowScales.resize((size_t)last);
+            for (int64_t k = 0; k < last; k++)
+            {
+                const double left = times[(size_t)k], right = times[(size_t)(k + 1)];
+                const double scale = 1.0 / (2.0 * (left + right) - (k > 0 ? right * upperFactors[(size_t)(k - 1)] : 0.0));
+                rowScales[(size_t)k] = scale;
+                upperFactors[(size_t)k] = left * scale;
+                if (uniformTimes && k > 0 && scale == rowScales[(size_t)(k - 1)])
+                {
+                    // with a constant time slice the factors converge within a few dozen rows
+                    std::fill(rowScales.begin() + k, rowScales.end(), scale);
+                    std::fill(upperFactors.begin() + k, upperFactors.end(), left * scale);
+                    break;
+                }
+            }
+
+            // forward elimination and back substitution in place, every axis of a row at once
+            for (int32_t axis = 0; axis < axisCount; axis++)
+            {
+                velocities[axis] *= rowScales[0];
+            }
+            for (int64_t k = 1; k < last; k++)
+            {
+                double *row = &velocities[(size_t)k * A];
+                RowEliminate(row, row - A, times[(size_t)(k + 1)], rowScales[(size_t)k]);
+            }
+            for (int64_t k = last - 2; k >= 0; k--)
+            {
+                double *row = &velocities[(size_t)k * A];
+                RowEliminate(row, row + A, upperFactors[(size_t)k], 1.0);
+            }
+        }
+
+        // row = (row - coefficient * other) * scale.  Short rows (few axes) skip the SIMD setup of SubtractScale().
+        void RowEliminate(double *row, const double *other, double coefficient, double scale) const
+        {
+            if (axisCount < 4)
+            {
+                for (int32_t axis = 0; axis < axisCount; axis++)
+                {
+                    row[axis] = (row[axis] - coefficient * other[axis]) * scale;
+                }
+                return;
+            }
+            SubtractScale(row, other, coefficient, scale, axisCount, row);
+        }
+
+        int32_t             axisCount;
+        std::vector<double> positions;
+        std::vector<double> velocities;
+        std::vector<double> times;
+        std::vector<double> startPositions;
+        std::vector<double> startVelocities;
+        std::vector<double> endVelocities;
+        std::vector<double> upperFactors;                               // spline factors, kept for reuse
+        std::vector<double> rowScales;
+        bool                uniformTimes;
+    };
+
+    /// <summary>
+    /// Streams the points of a built PVTBuilder in blocks, for StreamingPointRing.h or any TrajectorySource consumer.
+    /// </summary>
+    class PVTBuilderSource : public TrajectorySource
+    {
+    public:
+        explicit PVTBuilderSource(const PVTBuilder& builder) : builder(builder), nextIndex(0) {}
+
+        int32_t AxisCountGet() const override { return builder.AxisCountGet(); }
+        bool    HasVelocitiesGet() const override { return true; }
+        bool    IsDoneGet() const override { return nextIndex >= builder.PointCountGet(); }
+
+        int32_t PointsNext(double *positions, double *velocities, double *times, int32_t maxPoints) override
+        {
+            const int64_t remaining = builder.PointCountGet() - nextIndex;
+            const int32_t count = remaining < maxPoints ? (int32_t)remaining : maxPoints;
+            if (count <= 0)
+            {
+                return 0;
+            }
+            const size_t values = (size_t)count * builder.AxisCountGet();
+            memcpy(positions, builder.PositionsGet(nextIndex), sizeof(double) * values);
+            memcpy(velocities, builder.VelocitiesGet(nextIndex), sizeof(double) * values);
+            memcpy(times, builder.TimesGet(nextIndex), sizeof(double) * count);
+            nextIndex += count;
+            return count;
+        }
+
+    private:
+        const PVTBuilder&   builder;
+        int64_t             nextIndex;
+    };
+}
+#endif
@@ -0,0 +1,165 @@
+/*!
+@example    PVTBuilderBenchmark.cpp
+
+*  @page       pvt-builder-benchmark-cpp PVTBuilderBenchmark.cpp
+
+*  @brief      Benchmark of the PVTBuilder velocity methods against the PVTmotionMultiAxis.cpp forward-difference loop.
+
+*  @details
+Builds phase-shifted quarter circles on 2 and 6 axes with 3000 (the PVTmotionMultiAxis.cpp size), 100000 and 1000000 points.
+For each size it prints the throughput in millions of points per second of:
+
+- the PVTmotionMultiAxis.cpp forward-difference index loop, on heap arrays since the stack cannot hold the larger sizes,
+- PVTBuilder with ForwardDifference, CentralDifference and CubicSpline,
+- streaming the finished points out of PVTBuilderSource in blocks of BLOCK_POINTS.
+
+It also prints the worst velocity error of each method against the exact derivative of the circle.
+No controller is needed.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include PVTBuilderBenchmark.cpp
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "PVTBuilder.h"                             // Import the PVT builder.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int       POINT_COUNTS[] = { 3000, 100000, 1000000 };
+    const int       AXIS_COUNTS[] = { 2, 6 };
+    const int       MAX_AXES = 6;
+    const int       BLOCK_POINTS = 500;
+    const int       REPEATS = 5;
+    const double    TIME_SLICE = 0.01;                                  // same as PVTmotionMultiAxis.cpp
+    const double    RADIUS = 1000;
+    const double    PHASE_PER_AXIS = 0.3;                               // radians between the circles of neighbouring axes
+
+    // Best-of-REPEATS millions of points per second.
+    template <class Function>
+    double MillionPointsPerSecond(int pointCount, Function function)
+    {
+        double best = 1e30;
+        for (int repeat = 0; repeat < REPEATS; repeat++)
+        {
+            Clock::time_point start = Clock::now();
+            function();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (seconds < best)
+            {
+                best = seconds;
+            }
+        }
+        return pointCount / best / 1e6;
+    }
+
+    // Worst error over every point but the last, whose velocity is set rather than estimated by the loop.
+    double VelocityErrorGet(const double *velocities, const std::vector<double>& exact, int axisCount, int pointCount)
+    {
+        double worst = 0;
+        for (int j = 0; j < (pointCount - 1) * axisCount; j++)
+        {
+            worst = std::fmax(worst, std::fabs(velocities[j] - exact[j]));
+        }
+        return worst;
+    }
+}
+
+void pvtBuilderBenchmarkMain()
+{
+    printf("PVT velocity estimation, instruction set: %s\n", SampleAppsCPP::PointTransposeInstructionSetGet());
+    printf("%4s %8s | %10s %10s %10s %10s %10s | %11s %11s %11s\n", "axes", "points",
+        "loop", "forward", "central", "spline", "stream", "err forward", "err central", "err spline");
+
+    for (size_t axisIndex = 0; axisIndex < sizeof(AXIS_COUNTS) / sizeof(AXIS_COUNTS[0]); axisIndex++)
+    {
+        const int axisCount = AXIS_COUNTS[axisIndex];
+        for (size_t countIndex = 0; countIndex < sizeof(POINT_COUNTS) / sizeof(POINT_COUNTS[0]); countIndex++)
+        {
+            const int pointCount = POINT_COUNTS[countIndex];
+            const double radiansPerPoint = (90.0 / pointCount) * 3.14159265358979323 / 180.0;
+            const double radiansPerSecond = radiansPerPoint / TIME_SLICE;
+
+            // the path, one array per axis, plus the exact velocities in MovePVT() order
+            std::vector<double> axisStorage((size_t)axisCount * pointCount);
+            std::vector<double> exact((size_t)axisCount * pointCount);
+            const double *axisPositions[MAX_AXES];
+            double startPositions[MAX_AXES], startVelocities[MAX_AXES], endVelocities[MAX_AXES];
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                const double phase = axis * PHASE_PER_AXIS;
+                for (int i = 0; i < pointCount; i++)
+                {
+                    axisStorage[(size_t)axis * pointCount + i] = RADIUS * std::cos((i + 1) * radiansPerPoint + phase);
+                    exact[(size_t)i * axisCount + axis] = -RADIUS * radiansPerSecond * std::sin((i + 1) * radiansPerPoint + phase);
+                }
+                axisPositions[axis] = &axisStorage[(size_t)axis * pointCount];
+                startPositions[axis] = RADIUS * std::cos(phase);
+                startVelocities[axis] = -RADIUS * radiansPerSecond * std::sin(phase);
+                endVelocities[axis] = exact[(size_t)(pointCount - 1) * axisCount + axis];
+            }
+
+            // the PVTmotionMultiAxis.cpp loop, generalized to axisCount
+            std::vector<double> position((size_t)axisCount * pointCount), vel((size_t)axisCount * pointCount);
+            SampleAppsCPP::PointsInterleave(axisPositions, axisCount, pointCount, &position[0]);
+            double loopRate = MillionPointsPerSecond(pointCount, [&]()
+            {
+                for (int i = 0, x = 0; i < (pointCount - 1); i++)
+                {
+                    for (int axis = 0; axis < axisCount; axis++)
+                    {
+                        vel[x + axis] = (position[x + axis + axisCount] - position[x + axis]) / TIME_SLICE;
+                    }
+                    x = x + axisCount;
+                }
+                for (int axis = 0; axis < axisCount; axis++)
+                {
+                    vel[(size_t)(pointCount - 1) * axisCount + axis] = 0;
+                }
+            });
+
+            SampleAppsCPP::PVTBuilder builder(axisCount);
+            builder.Reserve(pointCount);
+            builder.PointsAppend(axisPositions, TIME_SLICE, pointCount);
+            builder.StartSet(startPositions, startVelocities);
+            builder.EndVelocitiesSet(endVelocities);
+
+            double rates[3], errors[3];
+            const SampleAppsCPP::PVTVelocityMethod methods[3] = { SampleAppsCPP::PVTVelocityMethod::ForwardDifference,
+                SampleAppsCPP::PVTVelocityMethod::CentralDifference, SampleAppsCPP::PVTVelocityMethod::CubicSpline };
+            for (int m = 0; m < 3; m++)
+            {
+                rates[m] = MillionPointsPerSecond(pointCount, [&]() { builder.VelocitiesCompute(methods[m]); });
+                errors[m] = VelocityErrorGet(builder.VelocitiesGet(0), exact, axisCount, pointCount);
+            }
+
+            // drain the finished spline in blocks, as a streaming loop would
+            std::vector<double> blockPositions((size_t)BLOCK_POINTS * axisCount), blockVelocities((size_t)BLOCK_POINTS * axisCount), blockTimes(BLOCK_POINTS);
+            double streamRate = MillionPointsPerSecond(pointCount, [&]()
+            {
+                SampleAppsCPP::PVTBuilderSource source(builder);
+                while (source.PointsNext(&blockPositions[0], &blockVelocities[0], &blockTimes[0], BLOCK_POINTS) > 0)
+                {
+                }
+            });
+
+            printf("%4d %8d | %10.1f %10.1f %10.1f %10.1f %10.1f | %11.2e %11.2e %11.2e\n", axisCount, pointCount,
+                loopRate, rates[0], rates[1], rates[2], streamRate, errors[0], errors[1], errors[2]);
+        }
+    }
+    printf("Throughput in millions of points per second, velocity error in user units per second.\n");
+}
@@ -0,0 +1,384 @@
+/*!
+*  @example    PhaseProfiler.h
+
+*  @page       phase-profiler-cpp PhaseProfiler.h
+
+*  @brief      Per-phase timing of a sync interrupt cycle against the host process time, with rolling percentiles and overrun attribution.
+
+*  @details
+Custom97.cpp brackets its work with SyncInterruptHostProcessFlagSet(true/false), and SyncInterruptHostProcessStatusBitGet()
+only says afterwards that the last cycle took too long, not where the time went.
+
+PhaseProfiler splits each cycle into phases (for example wake-up, Custom97ReadDataGet(), computation, Custom97WriteDataSet(), flag clear).
+The loop calls CycleBegin() when SyncInterruptWait() returns and PhaseEnd() with a host timestamp after each phase.
+Take the timestamps from HostTickCounter (StreamingDepthController.h): the raw 32-bit PerformanceTimerCountGet() wraps.
+The first phase also counts the wake-up latency passed to CycleBegin(), because the host process time starts at the interrupt, not at the wake-up.
+
+Every phase and the cycle total go into a LatencyHistogram (LatencyHistogram.h).  The histograms are double buffered:
+every windowCycles cycles CycleEnd() only switches the loop to the other set.  The percentile scans over the closed set and its reset
+(about 600 KB of counters) run on the profiler's own thread (Start()), or in WindowSummarize() called outside the cycle.
+Its p50/p99/p99.9/max per phase end up in a small table that WindowLog() hands to a CycleLog (CycleLog.h) without printing in the loop.
+If the closed set has not been summarized and logged by the next window close, the current window simply runs on until it has.
+When a cycle goes over the SyncInterruptHostProcessTimeGet() budget, CycleEnd() returns the phase during which the budget ran out.
+OverrunConfirm() records the firmware's own verdict on the previous cycle, so overruns the host clock missed are counted too.
+
+The two sets of histograms take about 1.2 MB, so create the profiler with new or at file scope, not on the stack.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include PhaseProfiler.h
+
+*/
+#ifndef CPP_PHASE_PROFILER
+#define CPP_PHASE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "LatencyHistogram.h"                       // Import the latency histogram.
+
+namespace SampleAppsCPP
+{
+    class PhaseProfiler
+    {
+    public:
+        static const int MAX_PHASES = 8;
+        static const int PERCENTILES = 3;
+
+        /// <summary>
+        /// p50, p99, p99.9 and max of one phase over the last completed window, in microseconds.
+        /// </summary>
+        struct PhaseSummary
+        {
+            double  percentileUs[PERCENTILES];
+            double  maxUs;
+        };
+
+        /// <param name="phaseNames">One name per phase, in cycle order.  Must outlive the profiler.</param>
+        /// <param name="phaseCount">Number of phases, up to MAX_PHASES.</param>
+        /// <param name="hostTicksPerSecond">PerformanceTimerFrequencyGet().</param>
+        /// <param name="budgetMicroseconds">SyncInterruptHostProcessTimeGet().</param>
+        /// <param name="windowCycles">Cycles per rolling percentile window.</param>
+        PhaseProfiler(const char *const *phaseNames, int phaseCount, double hostTicksPerSecond, double budgetMicroseconds, int64_t windowCycles)
+            : names(phaseNames), phaseCount(phaseCount < MAX_PHASES ? phaseCount : MAX_PHASES), nsPerTick(1e9 / hostTicksPerSecond),
+              budgetNs(budgetMicroseconds * 1000.0), windowCycles(windowCycles > 0 ? windowCycles : 1), summarizePeriodMs(10), stopRequested(false)
+        {
+            Reset();
+        }
+
+        ~PhaseProfiler() { Stop(); }
+
+        /// <summary>
+        /// Start the thread that summarizes and resets closed windows.
+        /// Call it before the sync thread raises its own priority (CyclicExecutor::Configure()), like CycleLog::Start().
+        /// </summary>
+        void Start(int summarizePeriodMilliseconds = 10)
+        {
+            if (summarizeThread.joinable())
+            {
+                return;
+            }
+            summarizePeriodMs = summarizePeriodMilliseconds;
+            stopRequested.store(false);
+            summarizeThread = std::thread([this]() { SummarizeLoop(); });
+        }
+
+        void Stop()
+        {
+            if (!summarizeThread.joinable())
+            {
+                return;
+            }
+            stopRequested.store(true);
+            summarizeThread.join();
+        }
+
+        /// <summary>
+        /// Clear everything.  Not while the summarize thread runs.
+        /// </summary>
+        void Reset()
+        {
+            for (int i = 0; i <= MAX_PHASES; i++)
+            {
+                window[0][i].Reset();
+                window[1][i].Reset();
+                summary[i] = PhaseSummary();
+                overrunsByPhase[i] = 0;
+                worstNs[i] = 0;
+            }
+            for (int i = 0; i < MAX_PHASES; i++)
+            {
+                phaseNs[i] = 0;
+            }
+            cycles = 0;
+            activeSet = 0;
+            closedSet = 1;
+            windowState.store(WINDOW_IDLE);
+            activeCycles = 0;
+            windowsCompleted = 0;
+            windowsExtended = 0;
+            overruns = 0;
+            confirmedOverruns = 0;
+            unmeasuredOverruns = 0;
+            lastCycleOverran = false;
+            lastTicks = 0;
+            pendingNs = 0;
+            currentPhase = 0;
+            cycleNs = 0;
+            crossingPhase = -1;
+        }
+
+        /// <summary>
+        /// Call as soon as SyncInterruptWait() returns.
+        /// </summary>
+        /// <param name="hostTicks">HostTickCounter::Read() right after the wake-up.</param>
+        /// <param name="wakeLatencyNs">Time from the interrupt to the wake-up (WakeLatencyEstimator), charged to the first phase.  0 if unknown.</param>
+        void CycleBegin(uint64_t hostTicks, double wakeLatencyNs)
+        {
+            lastTicks = hostTicks;
+            currentPhase = 0;
+            crossingPhase = -1;
+            cycleNs = 0;
+            pendingNs = wakeLatencyNs > 0.0 ? (uint64_t)wakeLatencyNs : 0;
+        }
+
+        /// <summary>
+        /// Call right after each phase, in order.
+        /// </summary>
+        void PhaseEnd(uint64_t hostTicks)
+        {
+            if (currentPhase >= phaseCount)
+            {
+                return;
+            }
+            const uint64_t ns = pendingNs + (uint64_t)((double)(hostTicks - lastTicks) * nsPerTick);
+            pendingNs = 0;
+            lastTicks = hostTicks;
+            phaseNs[currentPhase] = ns;
+            cycleNs += ns;
+            if (crossingPhase < 0 && (double)cycleNs > budgetNs)
+            {
+                crossingPhase = currentPhase;
+            }
+            ++currentPhase;
+        }
+
+        /// <summary>
+        /// Call after the last phase.  Returns the phase during which the budget ran out, or -1 if the cycle fit.
+        /// Closing a window only switches histogram sets, so this does no percentile scan or reset.
+        /// </summary>
+        int CycleEnd()
+        {
+            LatencyHistogram *histograms = window[activeSet];
+            for (int i = 0; i < currentPhase; i++)
+            {
+                histograms[i].Record(phaseNs[i]);
+                worstNs[i] = phaseNs[i] > worstNs[i] ? phaseNs[i] : worstNs[i];
+            }
+            histograms[phaseCount].Record(cycleNs);
+            worstNs[phaseCount] = cycleNs > worstNs[phaseCount] ? cycleNs : worstNs[phaseCount];
+
+            lastCycleOverran = crossingPhase >= 0;
+            if (lastCycleOverran)
+            {
+                ++overruns;
+                overrunsByPhase[crossingPhase]++;
+            }
+
+            ++cycles;
+            if (++activeCycles >= windowCycles)
+            {
+                if (windowState.load(std::memory_order_acquire) == WINDOW_IDLE)
+                {
+                    closedSet = activeSet;
+                    activeSet = 1 - activeSet;
+                    activeCycles = 0;
+                    windowState.store(WINDOW_CLOSED, std::memory_order_release);
+                }
+                else if (activeCycles == windowCycles)
+                {
+                    ++windowsExtended;                  // the last window is not summarized and logged yet, keep this one going
+                }
+            }
+            return crossingPhase;
+        }
+
+        /// <summary>
+        /// Call when SyncInterruptHostProcessStatusBitGet() reports that the previous cycle overran.
+        /// Counts it as unmeasured if the host timestamps said that cycle fit, which usually means the wake-up latency was underestimated.
+        /// </summary>
+        void OverrunConfirm()
+        {
+            ++confirmedOverruns;
+            if (!lastCycleOverran)
+            {
+                ++unmeasuredOverruns;
+            }
+        }
+
+        /// <summary>
+        /// Percentiles of a closed window into the table, then reset its histograms.  Not real-time safe.
+        /// The summarize thread calls this; without Start() call it yourself outside the cycle.  Returns false if no window was waiting.
+        /// </summary>
+        bool WindowSummarize()
+        {
+            if (windowState.load(std::memory_order_acquire) != WINDOW_CLOSED)
+            {
+                return false;
+            }
+            SummaryFill(window[closedSet]);
+            for (int i = 0; i <= phaseCount; i++)
+            {
+                window[closedSet][i].Reset();
+            }
+            ++windowsCompleted;
+            windowState.store(WINDOW_SUMMARIZED, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// True once a closed window has been summarized, until WindowLog() is called.
+        /// </summary>
+        bool IsWindowReadyGet() const { return windowState.load(std::memory_order_acquire) == WINDOW_SUMMARIZED; }
+
+        /// <summary>
+        /// Queue the last window's table on a CycleLog: one record per phase and one for the total.  Real-time safe.
+        /// </summary>
+        template <class LogT>
+        void WindowLog(LogT& log)
+        {
+            if (!IsWindowReadyGet())
+            {
+                return;
+            }
+            log.Log("\nphase        p50 us   p99 us  p99.9 us   max us   (window %lld, budget %.1lf us)\n", (long long)windowsCompleted, budgetNs / 1000.0);
+            for (int i = 0; i <= phaseCount; i++)
+            {
+                log.Log("%-10s %8.2lf %8.2lf %9.2lf %8.2lf\n", PhaseNameGet(i),
+                    summary[i].percentileUs[0], summary[i].percentileUs[1], summary[i].percentileUs[2], summary[i].maxUs);
+            }
+            windowState.store(WINDOW_IDLE, std::memory_order_release);     // the closed set is clean again
+        }
+
+        /// <summary>
+        /// Name of a phase, or "total" for phaseCount.
+        /// </summary>
+        const char* PhaseNameGet(int phase) const { return phase < phaseCount ? names[phase] : "total"; }
+
+        int     PhaseCountGet() const { return phaseCount; }
+        int64_t CycleCountGet() const { return cycles; }
+        int64_t OverrunCountGet() const { return overruns; }
+        int64_t OverrunCountGet(int phase) const { return overrunsByPhase[phase]; }
+        int64_t ConfirmedOverrunCountGet() const { return confirmedOverruns; }
+        int64_t WindowExtendedCountGet() const { return windowsExtended; }
+        double  PhaseMicrosecondsGet(int phase) const { return phaseNs[phase] / 1000.0; }
+        double  CycleMicrosecondsGet() const { return cycleNs / 1000.0; }
+        const PhaseSummary& SummaryGet(int phase) const { return summary[phase]; }
+
+        /// <summary>
+        /// Final report: the last window's table, the worst time of each phase, and where the overruns happened.
+        /// Not real-time safe; call it after the loop and Stop().
+        /// </summary>
+        void Print(FILE *out)
+        {
+            WindowSummarize();
+            if (activeCycles > 0)
+            {
+                SummaryFill(window[activeSet]);         // include the partial window
+            }
+            fprintf(out, "Phase profile: %lld cycles, budget %.1lf us, %lld overruns measured, %lld reported by the controller (%lld not seen by the host clock)\n",
+                (long long)cycles, budgetNs / 1000.0, (long long)overruns, (long long)confirmedOverruns, (long long)unmeasuredOverruns);
+            if (windowsExtended > 0)
+            {
+                fprintf(out, "  %lld windows ran long waiting for the last one to be summarized and logged\n", (long long)windowsExtended);
+            }
+            fprintf(out, "  phase        p50 us   p99 us  p99.9 us   max us  worst us  overruns\n");
+            for (int i = 0; i <= phaseCount; i++)
+            {
+                fprintf(out, "  %-10s %8.2lf %8.2lf %9.2lf %8.2lf %9.2lf  %8lld\n", PhaseNameGet(i),
+                    summary[i].percentileUs[0], summary[i].percentileUs[1], summary[i].percentileUs[2], summary[i].maxUs,
+                    worstNs[i] / 1000.0, (long long)(i < phaseCount ? overrunsByPhase[i] : overruns));
+            }
+        }
+
+    private:
+        // who owns the closed histogram set: the summarize thread (CLOSED), then the loop's WindowLog() (SUMMARIZED), then nobody (IDLE)
+        enum WindowState
+        {
+            WINDOW_IDLE,
+            WINDOW_CLOSED,
+            WINDOW_SUMMARIZED,
+        };
+
+        // One pass over each histogram (about 3300 buckets for a 1 ms range).
+        void SummaryFill(const LatencyHistogram *histograms)
+        {
+            static const double percents[PERCENTILES] = { 50.0, 99.0, 99.9 };
+            for (int i = 0; i <= phaseCount; i++)
+            {
+                uint64_t values[PERCENTILES];
+                histograms[i].PercentilesGet(percents, PERCENTILES, values);
+                for (int p = 0; p < PERCENTILES; p++)
+                {
+                    summary[i].percentileUs[p] = values[p] / 1000.0;
+                }
+                summary[i].maxUs = histograms[i].MaxGet() / 1000.0;
+            }
+        }
+
+        void SummarizeLoop()
+        {
+            while (!stopRequested.load())
+            {
+                if (!WindowSummarize())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(summarizePeriodMs));
+                }
+            }
+        }
+
+        const char *const   *names;
+        int                 phaseCount;
+        double              nsPerTick;
+        double              budgetNs;
+        int64_t             windowCycles;
+
+        LatencyHistogram    window[2][MAX_PHASES + 1];  // active and closed sets, the last of each is the cycle total
+        PhaseSummary        summary[MAX_PHASES + 1];
+        uint64_t            worstNs[MAX_PHASES + 1];
+        int64_t             overrunsByPhase[MAX_PHASES + 1];
+        uint64_t            phaseNs[MAX_PHASES];
+
+        uint64_t            lastTicks;
+        uint64_t            pendingNs;
+        uint64_t            cycleNs;
+        int                 currentPhase;
+        int                 crossingPhase;
+        int64_t             cycles;
+        int                 activeSet;                  // loop only
+        int                 closedSet;                  // written by the loop before it publishes WINDOW_CLOSED
+        std::atomic<int>    windowState;
+        int64_t             activeCycles;
+        int64_t             windowsCompleted;           // written by the summarizer before it publishes WINDOW_SUMMARIZED
+        int64_t             windowsExtended;
+        int64_t             overruns;
+        int64_t             confirmedOverruns;
+        int64_t             unmeasuredOverruns;
+        bool                lastCycleOverran;
+        int                 summarizePeriodMs;
+        std::thread         summarizeThread;
+        std::atomic<bool>   stopRequested;
+    };
+}
+#endif
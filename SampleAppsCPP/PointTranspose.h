@@ -0,0 +1,260 @@
+/*!
+*  @example    PointTranspose.h
+
+*  @page       point-transpose-cpp PointTranspose.h
+
+*  @brief      Vectorized interleave/deinterleave between per-axis arrays and MovePT()/MovePVT() point arrays.
+
+*  @details
+MultiAxis::MovePT() and MovePVT() take positions interleaved per axis (x0,y0,x1,y1...), which PVTmotionMultiAxis.cpp builds with x+=2/y+=2 indexing.
+Planners usually work per axis (one array per axis).  These functions convert between the two layouts for any axis count,
+writing straight into the caller's buffer, for example the positions of a PointBlock from StreamingPointRing.h.
+
+The axes are processed 4 at a time with an AVX 4x4 transpose, then 2 at a time with SSE2, then one at a time.
+The instruction set is chosen at compile time (/arch:AVX or /arch:AVX2 on MSVC, -mavx or -mavx2 on gcc/clang).
+Without them the scalar loops are used.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include PointTranspose.h
+
+*/
+#ifndef CPP_POINT_TRANSPOSE
+#define CPP_POINT_TRANSPOSE
+
+#if defined(__AVX__)
+#define SAMPLEAPPS_SIMD_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLEAPPS_SIMD_SSE2 1
+#endif
+
+#if defined(SAMPLEAPPS_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(SAMPLEAPPS_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// Scalar reference: per-axis arrays to interleaved points.  interleaved[point * axisCount + axis] = axisArrays[axis][point].
+    /// </summary>
+    inline void PointsInterleaveScalar(const double *const *axisArrays, int axisCount, int pointCount, double *interleaved)
+    {
+        for (int point = 0; point < pointCount; point++)
+        {
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                interleaved[point * axisCount + axis] = axisArrays[axis][point];
+            }
+        }
+    }
+
+    /// <summary>
+    /// Scalar reference: interleaved points to per-axis arrays.  axisArrays[axis][point] = interleaved[point * axisCount + axis].
+    /// </summary>
+    inline void PointsDeinterleaveScalar(const double *interleaved, int axisCount, int pointCount, double *const *axisArrays)
+    {
+        for (int point = 0; point < pointCount; point++)
+        {
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                axisArrays[axis][point] = interleaved[point * axisCount + axis];
+            }
+        }
+    }
+
+#if defined(SAMPLEAPPS_SIMD_AVX)
+    // 4x4 transpose of doubles.  Row k of the input becomes column k of the output.
+    inline void Transpose4x4(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3)
+    {
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);                    // r0[0] r1[0] r0[2] r1[2]
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);                    // r0[1] r1[1] r0[3] r1[3]
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+#endif
+
+    /// <summary>
+    /// Per-axis arrays to interleaved points, vectorized when the compiler targets AVX or SSE2.
+    /// </summary>
+    /// <param name="axisArrays">axisCount pointers, each to pointCount values.</param>
+    /// <param name="interleaved">pointCount * axisCount values, for example PointBlock::positions.</param>
+    inline void PointsInterleave(const double *const *axisArrays, int axisCount, int pointCount, double *interleaved)
+    {
+#if defined(SAMPLEAPPS_SIMD_SSE2) || defined(SAMPLEAPPS_SIMD_AVX)
+        const int stride = axisCount;
+        int point = 0;
+#if defined(SAMPLEAPPS_SIMD_AVX)
+        for (; point + 4 <= pointCount; point += 4)
+        {
+            double *out = interleaved + point * stride;
+            int axis = 0;
+            for (; axis + 4 <= axisCount; axis += 4)
+            {
+                __m256d r0 = _mm256_loadu_pd(axisArrays[axis] + point);
+                __m256d r1 = _mm256_loadu_pd(axisArrays[axis + 1] + point);
+                __m256d r2 = _mm256_loadu_pd(axisArrays[axis + 2] + point);
+                __m256d r3 = _mm256_loadu_pd(axisArrays[axis + 3] + point);
+                Transpose4x4(r0, r1, r2, r3);
+                _mm256_storeu_pd(out + axis, r0);
+                _mm256_storeu_pd(out + stride + axis, r1);
+                _mm256_storeu_pd(out + 2 * stride + axis, r2);
+                _mm256_storeu_pd(out + 3 * stride + axis, r3);
+            }
+            for (; axis + 2 <= axisCount; axis += 2)
+            {
+                __m256d r0 = _mm256_loadu_pd(axisArrays[axis] + point);
+                __m256d r1 = _mm256_loadu_pd(axisArrays[axis + 1] + point);
+                __m256d lo = _mm256_unpacklo_pd(r0, r1);                // point 0 and point 2
+                __m256d hi = _mm256_unpackhi_pd(r0, r1);                // point 1 and point 3
+                _mm_storeu_pd(out + axis, _mm256_castpd256_pd128(lo));
+                _mm_storeu_pd(out + stride + axis, _mm256_castpd256_pd128(hi));
+                _mm_storeu_pd(out + 2 * stride + axis, _mm256_extractf128_pd(lo, 1));
+                _mm_storeu_pd(out + 3 * stride + axis, _mm256_extractf128_pd(hi, 1));
+            }
+            for (; axis < axisCount; axis++)
+            {
+                const double *in = axisArrays[axis] + point;
+                out[axis] = in[0];
+                out[stride + axis] = in[1];
+                out[2 * stride + axis] = in[2];
+                out[3 * stride + axis] = in[3];
+            }
+        }
+#endif
+        for (; point + 2 <= pointCount; point += 2)
+        {
+            double *out = interleaved + point * stride;
+            int axis = 0;
+            for (; axis + 2 <= axisCount; axis += 2)
+            {
+                __m128d r0 = _mm_loadu_pd(axisArrays[axis] + point);
+                __m128d r1 = _mm_loadu_pd(axisArrays[axis + 1] + point);
+                _mm_storeu_pd(out + axis, _mm_unpacklo_pd(r0, r1));
+                _mm_storeu_pd(out + stride + axis, _mm_unpackhi_pd(r0, r1));
+            }
+            for (; axis < axisCount; axis++)
+            {
+                out[axis] = axisArrays[axis][point];
+                out[stride + axis] = axisArrays[axis][point + 1];
+            }
+        }
+        for (; point < pointCount; point++)
+        {
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                interleaved[point * stride + axis] = axisArrays[axis][point];
+            }
+        }
+#else
+        PointsInterleaveScalar(axisArrays, axisCount, pointCount, interleaved);
+#endif
+    }
+
+    /// <summary>
+    /// Interleaved points to per-axis arrays, vectorized when the compiler targets AVX or SSE2.
+    /// </summary>
+    /// <param name="interleaved">pointCount * axisCount values in MovePT() order.</param>
+    /// <param name="axisArrays">axisCount pointers, each to room for pointCount values.</param>
+    inline void PointsDeinterleave(const double *interleaved, int axisCount, int pointCount, double *const *axisArrays)
+    {
+#if defined(SAMPLEAPPS_SIMD_SSE2) || defined(SAMPLEAPPS_SIMD_AVX)
+        const int stride = axisCount;
+        int point = 0;
+#if defined(SAMPLEAPPS_SIMD_AVX)
+        for (; point + 4 <= pointCount; point += 4)
+        {
+            const double *in = interleaved + point * stride;
+            int axis = 0;
+            for (; axis + 4 <= axisCount; axis += 4)
+            {
+                __m256d r0 = _mm256_loadu_pd(in + axis);
+                __m256d r1 = _mm256_loadu_pd(in + stride + axis);
+                __m256d r2 = _mm256_loadu_pd(in + 2 * stride + axis);
+                __m256d r3 = _mm256_loadu_pd(in + 3 * stride + axis);
+                Transpose4x4(r0, r1, r2, r3);
+                _mm256_storeu_pd(axisArrays[axis] + point, r0);
+                _mm256_storeu_pd(axisArrays[axis + 1] + point, r1);
+                _mm256_storeu_pd(axisArrays[axis + 2] + point, r2);
+                _mm256_storeu_pd(axisArrays[axis + 3] + point, r3);
+            }
+            for (; axis + 2 <= axisCount; axis += 2)
+            {
+                __m128d p0 = _mm_loadu_pd(in + axis);
+                __m128d p1 = _mm_loadu_pd(in + stride + axis);
+                __m128d p2 = _mm_loadu_pd(in + 2 * stride + axis);
+                __m128d p3 = _mm_loadu_pd(in + 3 * stride + axis);
+                _mm_storeu_pd(axisArrays[axis] + point, _mm_unpacklo_pd(p0, p1));
+                _mm_storeu_pd(axisArrays[axis] + point + 2, _mm_unpacklo_pd(p2, p3));
+                _mm_storeu_pd(axisArrays[axis + 1] + point, _mm_unpackhi_pd(p0, p1));
+                _mm_storeu_pd(axisArrays[axis + 1] + point + 2, _mm_unpackhi_pd(p2, p3));
+            }
+            for (; axis < axisCount; axis++)
+            {
+                double *out = axisArrays[axis] + point;
+                out[0] = in[axis];
+                out[1] = in[stride + axis];
+                out[2] = in[2 * stride + axis];
+                out[3] = in[3 * stride + axis];
+            }
+        }
+#endif
+        for (; point + 2 <= pointCount; point += 2)
+        {
+            const double *in = interleaved + point * stride;
+            int axis = 0;
+            for (; axis + 2 <= axisCount; axis += 2)
+            {
+                __m128d p0 = _mm_loadu_pd(in + axis);
+                __m128d p1 = _mm_loadu_pd(in + stride + axis);
+                _mm_storeu_pd(axisArrays[axis] + point, _mm_unpacklo_pd(p0, p1));
+                _mm_storeu_pd(axisArrays[axis + 1] + point, _mm_unpackhi_pd(p0, p1));
+            }
+            for (; axis < axisCount; axis++)
+            {
+                axisArrays[axis][point] = in[axis];
+                axisArrays[axis][point + 1] = in[stride + axis];
+            }
+        }
+        for (; point < pointCount; point++)
+        {
+            for (int axis = 0; axis < axisCount; axis++)
+            {
+                axisArrays[axis][point] = interleaved[point * stride + axis];
+            }
+        }
+#else
+        PointsDeinterleaveScalar(interleaved, axisCount, pointCount, axisArrays);
+#endif
+    }
+
+    /// <summary>
+    /// Name of the instruction set PointsInterleave()/PointsDeinterleave() were compiled for.
+    /// </summary>
+    inline const char* PointTransposeInstructionSetGet()
+    {
+#if defined(SAMPLEAPPS_SIMD_AVX)
+        return "AVX";
+#elif defined(SAMPLEAPPS_SIMD_SSE2)
+        return "SSE2";
+#else
+        return "scalar";
+#endif
+    }
+}
+#endif
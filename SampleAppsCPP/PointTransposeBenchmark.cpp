@@ -0,0 +1,96 @@
+/*!
+@example    PointTransposeBenchmark.cpp
+
+*  @page       point-transpose-benchmark-cpp PointTransposeBenchmark.cpp
+
+*  @brief      Benchmark of the vectorized point interleave/deinterleave against the scalar index loops.
+
+*  @details
+For 2 to 16 axes, converts POINTS points from per-axis arrays to MovePT() order and back.
+Each conversion is done with the scalar index loops (the PVTmotionMultiAxis.cpp style) and with PointTranspose.h.
+Prints nanoseconds per point for each and the speedup.  Every result is checked against the scalar output.
+No controller is needed.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include PointTransposeBenchmark.cpp
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "PointTranspose.h"                         // Import the point interleave/deinterleave utility.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int MAX_AXES = 16;
+    const int POINTS = 1000;                                            // a large streaming block, small enough to stay in cache
+    const int REPEATS = 200;
+
+    // Best-of-REPEATS nanoseconds per point.
+    template <class Function>
+    double TimePerPoint(Function function)
+    {
+        double best = 1e30;
+        for (int repeat = 0; repeat < REPEATS; repeat++)
+        {
+            Clock::time_point start = Clock::now();
+            function();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / POINTS;
+            if (ns < best)
+            {
+                best = ns;
+            }
+        }
+        return best;
+    }
+}
+
+void pointTransposeBenchmarkMain()
+{
+    std::vector<double> axisStorage(MAX_AXES * POINTS), axisResult(MAX_AXES * POINTS);
+    std::vector<double> interleavedScalar(MAX_AXES * POINTS), interleavedSimd(MAX_AXES * POINTS);
+    const double *axisArrays[MAX_AXES];
+    double *axisResults[MAX_AXES];
+
+    for (int i = 0; i < MAX_AXES * POINTS; i++)
+    {
+        axisStorage[i] = i * 0.5;
+    }
+    for (int axis = 0; axis < MAX_AXES; axis++)
+    {
+        axisArrays[axis] = &axisStorage[axis * POINTS];
+        axisResults[axis] = &axisResult[axis * POINTS];
+    }
+
+    printf("Point transpose, %d points, instruction set: %s\n", POINTS, SampleAppsCPP::PointTransposeInstructionSetGet());
+    printf("%4s | %12s %12s %8s | %12s %12s %8s | %s\n", "axes", "interleave", "simd", "speedup", "deinterleave", "simd", "speedup", "check");
+
+    for (int axisCount = 2; axisCount <= MAX_AXES; axisCount++)
+    {
+        double interleaveScalarNs = TimePerPoint([&]() { SampleAppsCPP::PointsInterleaveScalar(axisArrays, axisCount, POINTS, &interleavedScalar[0]); });
+        double interleaveSimdNs = TimePerPoint([&]() { SampleAppsCPP::PointsInterleave(axisArrays, axisCount, POINTS, &interleavedSimd[0]); });
+        bool ok = memcmp(&interleavedScalar[0], &interleavedSimd[0], sizeof(double) * axisCount * POINTS) == 0;
+
+        double deinterleaveScalarNs = TimePerPoint([&]() { SampleAppsCPP::PointsDeinterleaveScalar(&interleavedScalar[0], axisCount, POINTS, axisResults); });
+        double deinterleaveSimdNs = TimePerPoint([&]() { SampleAppsCPP::PointsDeinterleave(&interleavedScalar[0], axisCount, POINTS, axisResults); });
+        ok = ok && memcmp(&axisResult[0], &axisStorage[0], sizeof(double) * axisCount * POINTS) == 0;
+
+        printf("%4d | %9.3f ns %9.3f ns %7.2fx | %9.3f ns %9.3f ns %7.2fx | %s\n", axisCount,
+            interleaveScalarNs, interleaveSimdNs, interleaveScalarNs / interleaveSimdNs,
+            deinterleaveScalarNs, deinterleaveSimdNs, deinterleaveScalarNs / deinterleaveSimdNs,
+            ok ? "ok" : "MISMATCH");
+    }
+}
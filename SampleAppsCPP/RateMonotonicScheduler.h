@@ -0,0 +1,298 @@
+/*!
+*  @example    RateMonotonicScheduler.h
+
+*  @page       rate-monotonic-scheduler-cpp RateMonotonicScheduler.h
+
+*  @brief      Run tasks at several rates from one SyncInterruptWait() loop, fastest first, with slower tasks spread across cycles.
+
+*  @details
+SyncInterrupt.cpp runs one loop at one rate.  An application that also needs, say, 100 Hz supervision and 10 Hz HMI updates
+usually adds threads for them, and those threads then compete with the sync loop for the controller and the CPU.
+
+RateMonotonicScheduler runs them all from the sync loop instead.  Each task runs every divisor cycles (divisor 1 is every sync interrupt).
+<ul>
+<li>Rate monotonic: in a cycle, due tasks run in order of rate, fastest first, so the control task always runs before supervision or HMI work.</li>
+<li>Spread: Build() gives each slower task a phase offset within its period, chosen so the estimated work per cycle is as even as possible.
+A 10-cycle task and a 100-cycle task then never run in the same cycle unless they must, so slow work does not pile up into one overrun.</li>
+<li>Budget: with budgetUs set, a task slower than every cycle that becomes due after Dispatch() has used its budget is deferred to the next cycle
+and counted, instead of overrunning the host process time.  Every-cycle tasks are never deferred.</li>
+<li>Missed interrupts: cycles are counted from the sample counter, so a task whose run was slept through runs once on the next wake-up
+(counted as skipped runs) and then returns to its phase.  It does not run several times to catch up.</li>
+</ul>
+Each task's execution time goes into its own LatencyHistogram, and Print() reports rate, phase, runs, deferrals, skips and p50/p99/max times.
+Tasks are plain function pointers with a context pointer, so Dispatch() never allocates.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include RateMonotonicScheduler.h
+
+*/
+#ifndef CPP_RATE_MONOTONIC_SCHEDULER
+#define CPP_RATE_MONOTONIC_SCHEDULER
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "LatencyHistogram.h"                       // Import the latency histogram.
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// A scheduled task.  sample is the SyncInterruptWait() counter of the cycle it runs in.  Must be real-time safe.
+    /// </summary>
+    typedef void (*ScheduledTaskFunction)(void *context, int32_t sample);
+
+    class RateMonotonicScheduler
+    {
+    public:
+        static const int MAX_TASKS = 16;
+        static const int64_t MAX_PLAN_CYCLES = 100000;     // cycles Build() looks at when spreading the tasks
+
+        /// <param name="syncPeriodSamples">Samples between wake-ups (SyncInterruptPeriodSet()).</param>
+        /// <param name="sampleRate">Controller sample rate in Hz (SampleRateGet()), for the task rates in Print().</param>
+        /// <param name="budgetUs">Time Dispatch() may use before it defers slower tasks to the next cycle.  0 never defers.</param>
+        RateMonotonicScheduler(int32_t syncPeriodSamples, double sampleRate, double budgetUs = 0.0)
+            : syncPeriod(syncPeriodSamples > 0 ? syncPeriodSamples : 1), sampleRate(sampleRate), budgetNs(budgetUs * 1000.0), built(false), plannedPeakUs(0.0)
+        {
+            Reset();
+        }
+
+        /// <summary>
+        /// Add a task that runs every divisor cycles.  Call Build() after the last one.  Returns the task id, or -1 if MAX_TASKS are already added.
+        /// </summary>
+        /// <param name="costEstimateUs">Expected execution time, used only by Build() to spread the tasks.</param>
+        int32_t TaskAdd(const char *name, int32_t divisor, ScheduledTaskFunction function, void *context, double costEstimateUs = 1.0)
+        {
+            if ((int)tasks.size() >= MAX_TASKS || function == nullptr || divisor < 1 || built)
+            {
+                return -1;
+            }
+            Task task;
+            task.name = name;
+            task.divisor = divisor;
+            task.offset = 0;
+            task.function = function;
+            task.context = context;
+            task.costEstimateUs = costEstimateUs;
+            tasks.push_back(task);
+            return (int32_t)tasks.size() - 1;
+        }
+
+        /// <summary>
+        /// Order the tasks by rate and give each slower task the phase offset that keeps the estimated per-cycle work lowest.  Allocates, so call it before the loop.
+        /// </summary>
+        void Build()
+        {
+            order.resize(tasks.size());
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                order[i] = (int32_t)i;
+            }
+            std::stable_sort(order.begin(), order.end(), [this](int32_t a, int32_t b) { return tasks[a].divisor < tasks[b].divisor; });
+
+            // plan over the hyperperiod (the least common multiple of the divisors), or MAX_PLAN_CYCLES if that is longer
+            int64_t planCycles = 1;
+            for (size_t i = 0; i < tasks.size() && planCycles <= MAX_PLAN_CYCLES; i++)
+            {
+                planCycles = planCycles / GreatestCommonDivisor(planCycles, tasks[i].divisor) * tasks[i].divisor;
+            }
+            planCycles = planCycles < MAX_PLAN_CYCLES ? planCycles : MAX_PLAN_CYCLES;
+
+            std::vector<double> load((size_t)planCycles, 0.0);
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                Task& task = tasks[order[i]];
+                double bestWorst = 1e300;
+                for (int32_t offset = 0; offset < task.divisor && offset < planCycles; offset++)
+                {
+                    double worst = 0.0;
+                    for (int64_t cycle = offset; cycle < planCycles; cycle += task.divisor)
+                    {
+                        worst = load[(size_t)cycle] > worst ? load[(size_t)cycle] : worst;
+                    }
+                    if (worst < bestWorst)
+                    {
+                        bestWorst = worst;
+                        task.offset = offset;
+                    }
+                }
+                for (int64_t cycle = task.offset; cycle < planCycles; cycle += task.divisor)
+                {
+                    load[(size_t)cycle] += task.costEstimateUs;
+                }
+            }
+            plannedPeakUs = load.empty() ? 0.0 : *std::max_element(load.begin(), load.end());
+            built = true;
+            Reset();
+        }
+
+        /// <summary>
+        /// Clear the statistics and start counting cycles again from the next Dispatch().  Keeps the tasks and their phases.
+        /// </summary>
+        void Reset()
+        {
+            hasPrevious = false;
+            previousSample = 0;
+            cycle = 0;
+            cycleCount = 0;
+            overBudgetCount = 0;
+            dispatchTimes.Reset();
+            for (size_t i = 0; i < tasks.size(); i++)
+            {
+                tasks[i].nextDue = tasks[i].offset;
+                tasks[i].runs = 0;
+                tasks[i].deferred = 0;
+                tasks[i].skipped = 0;
+                tasks[i].times.Reset();
+            }
+        }
+
+        /// <summary>
+        /// Run the tasks due this cycle, fastest first.  Call once per SyncInterruptWait() with its sample counter.  Real-time safe.
+        /// Returns the number of tasks run.
+        /// </summary>
+        int32_t Dispatch(int32_t sample)
+        {
+            typedef std::chrono::steady_clock Clock;
+            if (hasPrevious)
+            {
+                const int32_t elapsed = (int32_t)((uint32_t)sample - (uint32_t)previousSample);
+                cycle += elapsed > 0 ? (elapsed + syncPeriod - 1) / syncPeriod : 1;
+            }
+            hasPrevious = true;
+            previousSample = sample;
+            ++cycleCount;
+
+            const Clock::time_point start = Clock::now();
+            Clock::time_point taskStart = start;
+            bool overBudget = false;
+            int32_t ran = 0;
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                Task& task = tasks[order[i]];
+                if (cycle < task.nextDue)
+                {
+                    continue;
+                }
+                if (budgetNs > 0.0 && task.divisor > 1 && std::chrono::duration<double, std::nano>(taskStart - start).count() > budgetNs)
+                {
+                    ++task.deferred;                        // still due, so it runs next cycle
+                    overBudget = true;
+                    continue;
+                }
+                task.skipped += (cycle - task.nextDue) / task.divisor;
+
+                task.function(task.context, sample);
+                const Clock::time_point taskEnd = Clock::now();
+                task.times.Record((uint64_t)std::chrono::duration<double, std::nano>(taskEnd - taskStart).count());
+                taskStart = taskEnd;
+                ++task.runs;
+                ++ran;
+
+                // next cycle in this task's phase
+                const int64_t periods = (cycle + 1 - task.offset + task.divisor - 1) / task.divisor;
+                task.nextDue = task.offset + periods * task.divisor;
+            }
+            dispatchTimes.Record((uint64_t)std::chrono::duration<double, std::nano>(taskStart - start).count());
+            overBudgetCount += overBudget ? 1 : 0;
+            return ran;
+        }
+
+        int32_t     TaskCountGet() const { return (int32_t)tasks.size(); }
+        const char* TaskNameGet(int32_t task) const { return tasks[task].name; }
+        int32_t     TaskOffsetGet(int32_t task) const { return tasks[task].offset; }
+        int64_t     TaskRunCountGet(int32_t task) const { return tasks[task].runs; }
+        int64_t     TaskDeferredCountGet(int32_t task) const { return tasks[task].deferred; }
+        int64_t     TaskSkippedCountGet(int32_t task) const { return tasks[task].skipped; }
+
+        /// <summary>
+        /// Execution times of a task, in ns.
+        /// </summary>
+        const LatencyHistogram& TaskTimesGet(int32_t task) const { return tasks[task].times; }
+
+        /// <summary>
+        /// Time each Dispatch() spent running tasks, in ns.
+        /// </summary>
+        const LatencyHistogram& DispatchTimesGet() const { return dispatchTimes; }
+
+        int64_t     CycleCountGet() const { return cycleCount; }
+        int64_t     OverBudgetCycleCountGet() const { return overBudgetCount; }
+
+        /// <summary>
+        /// Largest per-cycle sum of the cost estimates after Build() spread the tasks.
+        /// </summary>
+        double      PlannedPeakUsGet() const { return plannedPeakUs; }
+
+        /// <summary>
+        /// Print the per-task statistics.  Not real-time safe: call it after the loop.
+        /// </summary>
+        void Print(FILE *out) const
+        {
+            const double cycleHz = sampleRate / syncPeriod;
+            fprintf(out, "Scheduler: %lld cycles at %.1lf Hz, %lld over budget, planned peak %.1lf us per cycle\n",
+                (long long)cycleCount, cycleHz, (long long)overBudgetCount, plannedPeakUs);
+            fprintf(out, "%-16s %9s %9s %10s %9s %8s | %9s %9s %9s\n", "task", "rate Hz", "phase", "runs", "deferred", "skipped", "p50 us", "p99 us", "max us");
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                const Task& task = tasks[order[i]];
+                fprintf(out, "%-16s %9.2lf %4d/%-4d %10lld %9lld %8lld | ", task.name, cycleHz / task.divisor, task.offset, task.divisor,
+                    (long long)task.runs, (long long)task.deferred, (long long)task.skipped);
+                TimesPrint(out, task.times);
+            }
+            fprintf(out, "%-16s %9s %9s %10lld %9s %8s | ", "(all, per cycle)", "", "", (long long)cycleCount, "", "");
+            TimesPrint(out, dispatchTimes);
+        }
+
+    private:
+        struct Task
+        {
+            const char              *name;
+            int32_t                 divisor;
+            int32_t                 offset;
+            ScheduledTaskFunction   function;
+            void                    *context;
+            double                  costEstimateUs;
+            int64_t                 nextDue;                // cycle
+            int64_t                 runs;
+            int64_t                 deferred;
+            int64_t                 skipped;
+            LatencyHistogram        times;
+        };
+
+        static void TimesPrint(FILE *out, const LatencyHistogram& times)
+        {
+            const double percents[] = { 50.0, 99.0 };
+            uint64_t values[2];
+            times.PercentilesGet(percents, 2, values);
+            fprintf(out, "%9.2lf %9.2lf %9.2lf\n", values[0] / 1000.0, values[1] / 1000.0, times.MaxGet() / 1000.0);
+        }
+
+        static int64_t GreatestCommonDivisor(int64_t a, int64_t b) { return b == 0 ? a : GreatestCommonDivisor(b, a % b); }
+
+        int32_t                 syncPeriod;
+        double                  sampleRate;
+        double                  budgetNs;
+        bool                    built;
+        double                  plannedPeakUs;
+        bool                    hasPrevious;
+        int32_t                 previousSample;
+        int64_t                 cycle;
+        int64_t                 cycleCount;
+        int64_t                 overBudgetCount;
+        std::vector<Task>       tasks;                      // in TaskAdd() order, so ids stay valid
+        std::vector<int32_t>    order;                      // fastest first
+        LatencyHistogram        dispatchTimes;
+    };
+}
+#endif
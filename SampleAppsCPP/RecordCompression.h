@@ -0,0 +1,391 @@
+/*!
+*  @example    RecordCompression.h
+
+*  @page       record-compression-cpp RecordCompression.h
+
+*  @brief      Streaming compression of recorded channels: delta-of-delta zig-zag varints for integers, XOR of consecutive values for floating point.
+
+*  @details
+Recorded positions and velocities change slowly from one sample to the next, so most of each raw value repeats the one before it.
+Each channel is encoded on its own, one value at a time, as the records arrive:
+
+- integer channels (int32, uint32, int64): the first value, then the first delta, then every change of delta (delta-of-delta).
+Each is zig-zag mapped (0, -1, 1, -2 ... to 0, 1, 2, 3 ...) and written as a varint, 7 bits per byte, with a flag in the first byte.
+A run of zero delta-of-deltas (a held value, a counter or an encoder at constant velocity) is written once, as its length with the flag set.
+Otherwise a value costs 1 byte while its delta-of-delta is within +-32, instead of 4 or 8.
+- float and double channels: the XOR of each value with the one before (Gorilla, Pelkonen et al. 2015), as a bit stream.
+An unchanged value costs 1 bit.  Otherwise the XOR's meaningful bits are written, reusing the previous leading/trailing zero window when
+they fit in it (2 control bits), or with a new window (2 control bits, 5 bits of leading zeros, 6 bits of length).
+
+The encoding is lossless: decoded values are bit for bit the recorded ones.
+ColumnarRecording.h uses these for its compressed recordings, one encoder per channel, started afresh in every chunk
+so a reader can decode one channel of one chunk without the rest.
+RecordCompressionBenchmark.cpp measures the ratio and the throughput on synthetic and recorded motion.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include RecordCompression.h
+
+*/
+#ifndef CPP_RECORD_COMPRESSION
+#define CPP_RECORD_COMPRESSION
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace SampleAppsCPP
+{
+    inline uint64_t ZigZagEncode(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+    inline int64_t  ZigZagDecode(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+    inline void VarintWrite(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    // Returns false if the varint runs past end or is longer than 10 bytes.
+    inline bool VarintRead(const uint8_t *&data, const uint8_t *end, uint64_t *value)
+    {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 70 && data < end; shift += 7)
+        {
+            const uint8_t byte = *data++;
+            result |= (uint64_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                *value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// A varint with a flag in the low bit of its first byte: 6 bits of value there, then 7 per byte.
+    /// </summary>
+    inline void TaggedVarintWrite(std::vector<uint8_t>& out, uint64_t value, bool flag)
+    {
+        const uint64_t high = value >> 6;
+        out.push_back((uint8_t)(((value & 0x3f) << 1) | (flag ? 1 : 0) | (high != 0 ? 0x80 : 0)));
+        if (high != 0)
+        {
+            VarintWrite(out, high);
+        }
+    }
+
+    inline bool TaggedVarintRead(const uint8_t *&data, const uint8_t *end, uint64_t *value, bool *flag)
+    {
+        if (data >= end)
+        {
+            return false;
+        }
+        const uint8_t first = *data++;
+        uint64_t high = 0;
+        if ((first & 0x80) != 0 && !VarintRead(data, end, &high))
+        {
+            return false;
+        }
+        *flag = (first & 1) != 0;
+        *value = ((uint64_t)(first >> 1) & 0x3f) | (high << 6);
+        return true;
+    }
+
+    // Leading and trailing zero bits of a nonzero value.
+    inline int LeadingZerosGet(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - (int)index;
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+    inline int TrailingZerosGet(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return (int)index;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    /// <summary>
+    /// Appends bits to a byte vector, most significant bit first.
+    /// </summary>
+    class BitWriter
+    {
+    public:
+        BitWriter() : accumulator(0), bitCount(0) {}
+
+        void Reset() { accumulator = 0; bitCount = 0; }
+
+        /// <param name="count">0 to 64 low bits of value.</param>
+        void Write(std::vector<uint8_t>& out, uint64_t value, int count)
+        {
+            while (count > 0)
+            {
+                const int take = count > 32 ? 32 : count;
+                count -= take;
+                accumulator = (accumulator << take) | ((value >> count) & ((1ull << take) - 1));
+                bitCount += take;
+                while (bitCount >= 8)
+                {
+                    bitCount -= 8;
+                    out.push_back((uint8_t)(accumulator >> bitCount));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Write the last partial byte, padded with zeros.
+        /// </summary>
+        void Flush(std::vector<uint8_t>& out)
+        {
+            if (bitCount > 0)
+            {
+                out.push_back((uint8_t)(accumulator << (8 - bitCount)));
+            }
+            Reset();
+        }
+
+    private:
+        uint64_t    accumulator;
+        int         bitCount;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data, const uint8_t *end) : data(data), end(end), accumulator(0), bitCount(0), overrun(false) {}
+
+        /// <param name="count">0 to 64 bits.  Past the end, reads zeros and sets OverrunGet().</param>
+        uint64_t Read(int count)
+        {
+            uint64_t value = 0;
+            while (count > 0)
+            {
+                const int take = count > 32 ? 32 : count;
+                count -= take;
+                while (bitCount < take)
+                {
+                    overrun = overrun || data == end;
+                    accumulator = (accumulator << 8) | (data < end ? *data++ : 0);
+                    bitCount += 8;
+                }
+                bitCount -= take;
+                value = (value << take) | ((accumulator >> bitCount) & ((1ull << take) - 1));
+            }
+            return value;
+        }
+
+        bool OverrunGet() const { return overrun; }
+
+    private:
+        const uint8_t   *data;
+        const uint8_t   *end;
+        uint64_t        accumulator;
+        int             bitCount;
+        bool            overrun;
+    };
+
+    /// <summary>
+    /// Delta-of-delta, zig-zag, tagged varint, zero runs.  Values are sign- or zero-extended to 64 bits and differences wrap,
+    /// so any int64 sequence round-trips.
+    /// </summary>
+    class DeltaOfDeltaEncoder
+    {
+    public:
+        DeltaOfDeltaEncoder() { Reset(); }
+
+        void Reset() { count = 0; previous = 0; previousDelta = 0; zeroRun = 0; }
+
+        void Append(std::vector<uint8_t>& out, int64_t value)
+        {
+            const uint64_t delta = (uint64_t)value - previous;
+            const uint64_t deltaOfDelta = count == 0 ? (uint64_t)value : (count == 1 ? delta : delta - previousDelta);
+            if (count >= 2 && deltaOfDelta == 0)
+            {
+                ++zeroRun;
+            }
+            else
+            {
+                Flush(out);
+                TaggedVarintWrite(out, ZigZagEncode((int64_t)deltaOfDelta), false);
+            }
+            previousDelta = delta;
+            previous = (uint64_t)value;
+            ++count;
+        }
+
+        /// <summary>
+        /// Write a pending run of zeros.  Call at the end of a column.
+        /// </summary>
+        void Flush(std::vector<uint8_t>& out)
+        {
+            if (zeroRun > 0)
+            {
+                TaggedVarintWrite(out, zeroRun, true);
+                zeroRun = 0;
+            }
+        }
+
+    private:
+        int64_t     count;
+        uint64_t    previous;
+        uint64_t    previousDelta;
+        uint64_t    zeroRun;
+    };
+
+    class DeltaOfDeltaDecoder
+    {
+    public:
+        DeltaOfDeltaDecoder() : count(0), previous(0), previousDelta(0), zeroRun(0) {}
+
+        bool Next(const uint8_t *&data, const uint8_t *end, int64_t *value)
+        {
+            uint64_t decoded = 0;
+            if (zeroRun > 0)
+            {
+                --zeroRun;
+            }
+            else
+            {
+                uint64_t encoded;
+                bool run;
+                if (!TaggedVarintRead(data, end, &encoded, &run) || (run && (encoded == 0 || count < 2)))
+                {
+                    return false;
+                }
+                zeroRun = run ? encoded - 1 : 0;
+                decoded = run ? 0 : (uint64_t)ZigZagDecode(encoded);
+            }
+            const uint64_t current = count == 0 ? decoded : previous + (count == 1 ? decoded : previousDelta + decoded);
+            previousDelta = current - previous;
+            previous = current;
+            ++count;
+            *value = (int64_t)current;
+            return true;
+        }
+
+    private:
+        int64_t     count;
+        uint64_t    previous;
+        uint64_t    previousDelta;
+        uint64_t    zeroRun;
+    };
+
+    /// <summary>
+    /// XOR with the previous value (Gorilla), for the bits of a float (uint32_t) or a double (uint64_t).
+    /// </summary>
+    template <class UIntT>
+    class XorEncoder
+    {
+    public:
+        static const int BITS = sizeof(UIntT) * 8;
+
+        XorEncoder() { Reset(); }
+
+        void Reset() { count = 0; previous = 0; leading = -1; trailing = 0; }
+
+        void Append(std::vector<uint8_t>& out, BitWriter& bits, UIntT value)
+        {
+            if (count++ == 0)
+            {
+                bits.Write(out, value, BITS);
+                previous = value;
+                return;
+            }
+            const UIntT difference = value ^ previous;
+            previous = value;
+            if (difference == 0)
+            {
+                bits.Write(out, 0, 1);                                  // '0': same as before
+                return;
+            }
+            int newLeading = LeadingZerosGet(difference) - (64 - BITS);
+            const int newTrailing = TrailingZerosGet(difference);
+            newLeading = newLeading > 31 ? 31 : newLeading;
+            if (leading >= 0 && newLeading >= leading && newTrailing >= trailing)
+            {
+                bits.Write(out, 2, 2);                                  // '10': inside the previous window
+                bits.Write(out, difference >> trailing, BITS - leading - trailing);
+                return;
+            }
+            const int meaningful = BITS - newLeading - newTrailing;
+            bits.Write(out, 3, 2);                                      // '11': new window
+            bits.Write(out, (uint64_t)newLeading, 5);
+            bits.Write(out, (uint64_t)(meaningful & 63), 6);            // 64 is written as 0
+            bits.Write(out, difference >> newTrailing, meaningful);
+            leading = newLeading;
+            trailing = newTrailing;
+        }
+
+    private:
+        int64_t     count;
+        UIntT       previous;
+        int         leading;                                            // -1 until the first window
+        int         trailing;
+    };
+
+    template <class UIntT>
+    class XorDecoder
+    {
+    public:
+        static const int BITS = sizeof(UIntT) * 8;
+
+        XorDecoder() : count(0), previous(0), leading(0), trailing(0) {}
+
+        UIntT Next(BitReader& bits)
+        {
+            if (count++ == 0)
+            {
+                previous = (UIntT)bits.Read(BITS);
+            }
+            else if (bits.Read(1) != 0)
+            {
+                if (bits.Read(1) != 0)
+                {
+                    leading = (int)bits.Read(5);
+                    const int meaningful = (int)bits.Read(6);
+                    trailing = BITS - leading - (meaningful == 0 ? 64 : meaningful);
+                    if (trailing < 0)
+                    {
+                        trailing = 0;                                   // corrupt input; Read() past the end flags it
+                    }
+                }
+                previous ^= (UIntT)(bits.Read(BITS - leading - trailing) << trailing);
+            }
+            return previous;
+        }
+
+    private:
+        int64_t     count;
+        UIntT       previous;
+        int         leading;
+        int         trailing;
+    };
+}
+#endif
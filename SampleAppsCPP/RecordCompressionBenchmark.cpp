@@ -0,0 +1,340 @@
+/*!
+@example    RecordCompressionBenchmark.cpp
+
+*  @page       record-compression-benchmark-cpp RecordCompressionBenchmark.cpp
+
+*  @brief      Compression ratio and encode/decode throughput of the recorder channel encoders on synthetic and recorded motion.
+
+*  @details
+Each profile is one channel at 1 kHz for PROFILE_SECONDS, encoded with a ColumnEncoder (RecordCompression.h) in CHUNK_RECORDS chunks,
+the way ColumnarRecordingWriter encodes it as records are drained, then decoded and compared bit for bit.  The synthetic profiles are:
+
+- a trapezoidal back-and-forth move: command position and command velocity (doubles, fractional counts),
+- the actual position of that move: whole encoder counts with a count or two of noise, as a double and as an int32 encoder register,
+- a held axis: a constant position,
+- a status word that changes now and then (uint32),
+- a noisy float torque, which the encoders cannot do much with.
+
+"encoded" is the ColumnEncoder output; "stored" is what the writer keeps, the encoded or the raw column of each chunk, whichever is smaller,
+and the ratio and bits per value are of that.
+
+If RECORDED_FILE exists (Recorder.cpp writes it), every channel in it is measured too.
+Last, all the synthetic channels are written as one ColumnarRecording, raw and compressed, to compare file sizes and write times.
+Throughput is in MB of raw values per second; a 64-channel 1 kHz capture of doubles is 0.5 MB/s.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include RecordCompressionBenchmark.cpp
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "ColumnarRecording.h"                      // Import the columnar recording and its channel encoders.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const double    SAMPLE_RATE = 1000.0;
+    const int       PROFILE_SECONDS = 60;
+    const int       CHUNK_RECORDS = 4096;                               // as ColumnarRecordingWriter's default
+    const int       REPEATS = 5;                                        // encode and decode passes timed, the fastest is kept
+    const double    MOVE_DISTANCE = 200000.0;                           // counts
+    const double    MOVE_VELOCITY = 100000.0;                           // counts/s
+    const double    MOVE_ACCELERATION = 1000000.0;                      // counts/s^2
+    const double    DWELL_SECONDS = 0.25;
+    const char      *RECORDED_FILE = "recorder.rsicol";                 // written by Recorder.cpp
+    const char      *BENCHMARK_FILE = "recordcompression.rsicol";       // scratch file for the whole-recording comparison
+
+    struct Profile
+    {
+        char                        name[96];
+        SampleAppsCPP::RecordingChannelType type;
+        std::vector<unsigned char>  values;                             // raw, RecordingChannelBytesGet(type) bytes each
+
+        int64_t CountGet() const { return (int64_t)values.size() / SampleAppsCPP::RecordingChannelBytesGet(type); }
+    };
+
+    template <class T>
+    Profile ProfileMake(const char *name, SampleAppsCPP::RecordingChannelType type, const std::vector<T>& values)
+    {
+        Profile profile;
+        snprintf(profile.name, sizeof(profile.name), "%s", name);
+        profile.type = type;
+        profile.values.resize(values.size() * sizeof(T));
+        memcpy(profile.values.data(), values.data(), profile.values.size());
+        return profile;
+    }
+
+    // Position and velocity of a trapezoidal move from 0 to MOVE_DISTANCE, then back, with dwells, repeating.
+    void TrapezoidGet(double t, double *position, double *velocity)
+    {
+        const double accelTime = MOVE_VELOCITY / MOVE_ACCELERATION;
+        const double accelDistance = 0.5 * MOVE_ACCELERATION * accelTime * accelTime;
+        const double moveTime = 2 * accelTime + (MOVE_DISTANCE - 2 * accelDistance) / MOVE_VELOCITY;
+        const double period = 2 * (moveTime + DWELL_SECONDS);
+        double phase = fmod(t, period);
+        const double direction = phase < moveTime + DWELL_SECONDS ? 1.0 : -1.0;
+        const double start = direction > 0 ? 0.0 : MOVE_DISTANCE;
+        phase = direction > 0 ? phase : phase - (moveTime + DWELL_SECONDS);
+
+        double distance;
+        double speed;
+        if (phase >= moveTime)
+        {
+            distance = MOVE_DISTANCE;
+            speed = 0;
+        }
+        else if (phase < accelTime)
+        {
+            distance = 0.5 * MOVE_ACCELERATION * phase * phase;
+            speed = MOVE_ACCELERATION * phase;
+        }
+        else if (phase < moveTime - accelTime)
+        {
+            distance = accelDistance + MOVE_VELOCITY * (phase - accelTime);
+            speed = MOVE_VELOCITY;
+        }
+        else
+        {
+            const double remaining = moveTime - phase;
+            distance = MOVE_DISTANCE - 0.5 * MOVE_ACCELERATION * remaining * remaining;
+            speed = MOVE_ACCELERATION * remaining;
+        }
+        *position = start + direction * distance;
+        *velocity = direction * speed;
+    }
+
+    std::vector<Profile> SyntheticProfilesGet()
+    {
+        const int count = (int)(SAMPLE_RATE * PROFILE_SECONDS);
+        std::mt19937 random(1);
+        std::normal_distribution<double> followingError(0.0, 0.7);
+        std::normal_distribution<float> torqueNoise(0.0f, 0.05f);
+
+        std::vector<double> commandPosition(count), commandVelocity(count), actualPosition(count), held(count, 123456.0);
+        std::vector<int32_t> encoder(count);
+        std::vector<uint32_t> status(count);
+        std::vector<float> torque(count);
+        for (int i = 0; i < count; i++)
+        {
+            TrapezoidGet(i / SAMPLE_RATE, &commandPosition[i], &commandVelocity[i]);
+            actualPosition[i] = floor(commandPosition[i] + followingError(random) + 0.5);
+            encoder[i] = (int32_t)actualPosition[i];
+            status[i] = commandVelocity[i] == 0 ? 0x0001 : 0x0101;      // a motion bit that follows the move
+            torque[i] = (float)(commandVelocity[i] / MOVE_VELOCITY * 0.2) + torqueNoise(random);
+        }
+
+        std::vector<Profile> profiles;
+        profiles.push_back(ProfileMake("command position (double)", SampleAppsCPP::RecordingChannelTypeDOUBLE, commandPosition));
+        profiles.push_back(ProfileMake("command velocity (double)", SampleAppsCPP::RecordingChannelTypeDOUBLE, commandVelocity));
+        profiles.push_back(ProfileMake("actual position (double)", SampleAppsCPP::RecordingChannelTypeDOUBLE, actualPosition));
+        profiles.push_back(ProfileMake("encoder counts (int32)", SampleAppsCPP::RecordingChannelTypeINT32, encoder));
+        profiles.push_back(ProfileMake("held position (double)", SampleAppsCPP::RecordingChannelTypeDOUBLE, held));
+        profiles.push_back(ProfileMake("status word (uint32)", SampleAppsCPP::RecordingChannelTypeUINT32, status));
+        profiles.push_back(ProfileMake("torque (float)", SampleAppsCPP::RecordingChannelTypeFLOAT, torque));
+        return profiles;
+    }
+
+    // Every channel of a columnar recording, back in its recorded type.
+    std::vector<Profile> RecordedProfilesGet(const char *path)
+    {
+        std::vector<Profile> profiles;
+        SampleAppsCPP::ColumnarRecordingReader recording;
+        if (!recording.Open(path))
+        {
+            return profiles;
+        }
+        for (int32_t channel = 0; channel < recording.ChannelCountGet(); channel++)
+        {
+            char name[96];
+            const SampleAppsCPP::RecordingChannelType type = recording.ChannelTypeGet(channel);
+            snprintf(name, sizeof(name), "%s (%s)", recording.ChannelNameGet(channel), SampleAppsCPP::RecordingChannelTypeNameGet(type));
+            if (type == SampleAppsCPP::RecordingChannelTypeDOUBLE)
+            {
+                std::vector<double> values;
+                recording.ChannelRead(channel, values);
+                profiles.push_back(ProfileMake(name, type, values));
+            }
+            else if (type == SampleAppsCPP::RecordingChannelTypeFLOAT)
+            {
+                std::vector<float> values;
+                recording.ChannelRead(channel, values);
+                profiles.push_back(ProfileMake(name, type, values));
+            }
+            else if (type == SampleAppsCPP::RecordingChannelTypeINT64)
+            {
+                std::vector<int64_t> values;
+                recording.ChannelRead(channel, values);
+                profiles.push_back(ProfileMake(name, type, values));
+            }
+            else
+            {
+                std::vector<uint32_t> values;                           // the low 32 bits, int32 or uint32
+                recording.ChannelRead(channel, values);
+                profiles.push_back(ProfileMake(name, type, values));
+            }
+        }
+        return profiles;
+    }
+
+    void ProfileMeasure(const Profile& profile)
+    {
+        const int32_t bytes = SampleAppsCPP::RecordingChannelBytesGet(profile.type);
+        const int64_t count = profile.CountGet();
+        if (count == 0)
+        {
+            return;
+        }
+        SampleAppsCPP::ColumnEncoder encoder(profile.type);
+        std::vector<std::vector<uint8_t>> chunks;
+        std::vector<unsigned char> decoded;
+        decoded.reserve(profile.values.size());
+        double encodeSeconds = 1e30;
+        double decodeSeconds = 1e30;
+        bool same = true;
+
+        for (int repeat = 0; repeat < REPEATS; repeat++)
+        {
+            chunks.clear();
+            Clock::time_point start = Clock::now();
+            for (int64_t i = 0; i < count; i++)
+            {
+                encoder.Append(&profile.values[(size_t)(i * bytes)]);
+                if ((i + 1) % CHUNK_RECORDS == 0 || i + 1 == count)
+                {
+                    encoder.Finish();
+                    chunks.push_back(encoder.BytesGet());
+                    encoder.Reset();
+                }
+            }
+            const double encoded = std::chrono::duration<double>(Clock::now() - start).count();
+            encodeSeconds = encoded < encodeSeconds ? encoded : encodeSeconds;
+
+            start = Clock::now();
+            decoded.clear();
+            for (size_t k = 0; k < chunks.size(); k++)
+            {
+                const int64_t first = (int64_t)k * CHUNK_RECORDS;
+                const int64_t records = count - first < CHUNK_RECORDS ? count - first : CHUNK_RECORDS;
+                same = SampleAppsCPP::ColumnDecode(profile.type, chunks[k].data(), chunks[k].size(), records, decoded) && same;
+            }
+            const double decodeTime = std::chrono::duration<double>(Clock::now() - start).count();
+            decodeSeconds = decodeTime < decodeSeconds ? decodeTime : decodeSeconds;
+        }
+        same = same && decoded == profile.values;
+
+        // what ColumnarRecordingWriter stores: each chunk's column encoded, or raw where encoding did not make it smaller
+        size_t compressed = 0;
+        size_t stored = 0;
+        int rawChunks = 0;
+        for (size_t k = 0; k < chunks.size(); k++)
+        {
+            const int64_t first = (int64_t)k * CHUNK_RECORDS;
+            const size_t rawBytes = (size_t)((count - first < CHUNK_RECORDS ? count - first : CHUNK_RECORDS) * bytes);
+            compressed += chunks[k].size();
+            stored += chunks[k].size() < rawBytes ? chunks[k].size() : rawBytes;
+            rawChunks += chunks[k].size() < rawBytes ? 0 : 1;
+        }
+        const double megabytes = profile.values.size() / 1.0e6;
+        char rawNote[32] = "";
+        if (rawChunks > 0)
+        {
+            snprintf(rawNote, sizeof(rawNote), "%d/%d chunks raw", rawChunks, (int)chunks.size());
+        }
+        printf("%-44s | %10lld %10lld %10lld %7.2lfx %7.2lf | %9.0lf %9.0lf %s%s\n", profile.name, (long long)profile.values.size(), (long long)compressed, (long long)stored,
+            (double)profile.values.size() / stored, 8.0 * stored / count, megabytes / encodeSeconds, megabytes / decodeSeconds, rawNote, same ? "" : " MISMATCH");
+    }
+
+    void ProfilesMeasure(const char *title, const std::vector<Profile>& profiles)
+    {
+        printf("\n%s\n", title);
+        printf("%-44s | %10s %10s %10s %8s %7s | %9s %9s\n", "channel", "raw bytes", "encoded", "stored", "ratio", "bits", "enc MB/s", "dec MB/s");
+        for (size_t i = 0; i < profiles.size(); i++)
+        {
+            ProfileMeasure(profiles[i]);
+        }
+    }
+
+    // All profiles as the channels of one recording, appended in 1024-record batches the way RecorderService delivers them.
+    void RecordingWrite(const std::vector<Profile>& profiles, SampleAppsCPP::ColumnarCompression compression)
+    {
+        std::vector<SampleAppsCPP::RecordingChannel> channels;
+        for (size_t i = 0; i < profiles.size(); i++)
+        {
+            SampleAppsCPP::RecordingChannel channel = { profiles[i].name, profiles[i].type };
+            channels.push_back(channel);
+        }
+        const int32_t valuesPerRecord = SampleAppsCPP::RecordingValueCountGet(channels.data(), (int32_t)channels.size());
+        const int64_t count = profiles[0].CountGet();
+        std::vector<int32_t> records((size_t)(count * valuesPerRecord));
+        for (int64_t r = 0; r < count; r++)
+        {
+            int32_t value = 0;
+            for (size_t i = 0; i < profiles.size(); i++)
+            {
+                const int32_t bytes = SampleAppsCPP::RecordingChannelBytesGet(profiles[i].type);
+                memcpy(&records[(size_t)(r * valuesPerRecord + value)], &profiles[i].values[(size_t)(r * bytes)], bytes);
+                value += bytes / 4;
+            }
+        }
+
+        const Clock::time_point start = Clock::now();
+        SampleAppsCPP::ColumnarRecordingWriter writer;
+        bool ok = writer.Open(BENCHMARK_FILE, channels.data(), (int32_t)channels.size(), CHUNK_RECORDS, compression);
+        for (int64_t r = 0; r < count && ok; r += 1024)
+        {
+            ok = writer.RecordsAppend(&records[(size_t)(r * valuesPerRecord)], (int32_t)(count - r < 1024 ? count - r : 1024), valuesPerRecord);
+        }
+        ok = writer.Close() && ok;
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        FILE *file = fopen(BENCHMARK_FILE, "rb");
+        long long size = 0;
+        if (file != nullptr)
+        {
+            fseek(file, 0, SEEK_END);
+            size = (long long)ftell(file);
+            fclose(file);
+        }
+        printf("%-44s | %10lld bytes, %8.1lf ms to write%s\n", compression == SampleAppsCPP::ColumnarCompressionNONE ? "raw" : "delta-of-delta / XOR",
+            size, seconds * 1000.0, ok ? "" : " (WRITE ERROR)");
+    }
+}
+
+void recordCompressionBenchmarkMain()
+{
+    const std::vector<Profile> synthetic = SyntheticProfilesGet();
+    char title[128];
+    snprintf(title, sizeof(title), "Synthetic motion: %d s at %.0lf Hz, %d-record chunks", PROFILE_SECONDS, SAMPLE_RATE, CHUNK_RECORDS);
+    ProfilesMeasure(title, synthetic);
+
+    const std::vector<Profile> recorded = RecordedProfilesGet(RECORDED_FILE);
+    if (recorded.empty())
+    {
+        printf("\nNo %s to measure; run Recorder.cpp to record one.\n", RECORDED_FILE);
+    }
+    else
+    {
+        snprintf(title, sizeof(title), "Recorded: %s", RECORDED_FILE);
+        ProfilesMeasure(title, recorded);
+    }
+
+    printf("\nThe synthetic channels as one columnar recording\n");
+    RecordingWrite(synthetic, SampleAppsCPP::ColumnarCompressionNONE);
+    RecordingWrite(synthetic, SampleAppsCPP::ColumnarCompressionDELTA_XOR);
+    remove(BENCHMARK_FILE);
+}
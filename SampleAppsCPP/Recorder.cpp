@@ -6,6 +6,14 @@
 *  @brief      Recorder sample application.
 
 *  @details    In this sample app we show you how easy it is to track multiple drive parameters with a Recorder.
+The recorder runs with its circular buffer on, and RecorderService drains it continuously into RECORD_FILE on a background thread,
+so the capture can run for as long as RECORD_TIME says (hours if you like) without being limited by the controller's buffer.
+The channels are named ("axis0.actual_position"), and RecorderChannelCatalog resolves their addresses and types and configures the recorder:
+the positions and velocity are 64-bit doubles, so each takes two recorder values.
+The controller's sample counter is recorded first, as "controller.sample_counter", so RecorderService counts every record lost to an overflow
+from the gaps in it, and the service watches the fill level against RecorderRecordMaxCountGet().
+The records are written to a columnar recording (ColumnarRecording.h), compressed as they are drained when COMPRESS is set,
+and one channel is read back from it at the end.
 
 *  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
 
@@ -27,22 +35,25 @@ Robotic Systems Integration.
 
 #include "rsi.h" // Import our RapidCode Library. 
 #include "HelperFunctions.h"                        // Import our SampleApp helper functions. 
+#include "RecorderService.h"                        // Import the continuous recorder drain.
+#include "ColumnarRecording.h"                      // Import the typed columnar recording file.
+#include "RecorderChannelCatalog.h"                 // Import the named recorder channels.
+
 void RecorderMain()
 {
     using namespace RSI::RapidCode;
 
     // Constants
     const int AXIS_NUMBER = 0;                    // Specify which axis/motor to control.
-    const int VALUES_PER_RECORD = 2;              // How many values to store in each record.  
     const int RECORD_PERIOD_SAMPLES = 1;          // How often to record data. (samples between consecutive records)
     const int RECORD_TIME = 5000;                 // How long to record. (in milliseconds)
+    const char *RECORD_FILE = "recorder.rsicol";  // Columnar recording of CHANNELS.
+    const bool COMPRESS = true;                   // Delta-of-delta / XOR encode every channel as it is written. (see RecordCompression.h)
 
-    uint64 axis0ActualPositionAddr;
-    uint64 axis0CommandVelocityAddr;
-    uint64 axis1ActualPositionAddr;
-
-    int32 *recordDataPtr;
-    int32 recordData[VALUES_PER_RECORD];
+    // What to record.  See RecorderChannelCatalog.h for the axis fields.  The sample counter stays first: it is the sequence value.
+    const char *SEQUENCE_CHANNEL = "controller.sample_counter";
+    const char *CHANNELS[] = { SEQUENCE_CHANNEL, "axis0.actual_position", "axis0.command_velocity", "axis1.actual_position" };
+    const int CHANNEL_COUNT = sizeof(CHANNELS) / sizeof(CHANNELS[0]);
 
     char rmpPath[] = "C:\\RSI\\X.X.X\\";            // Insert the path location of the RMP.rta (usually the RapidSetup folder)
     // Initialize MotionController class.
@@ -59,52 +70,61 @@ void RecorderMain()
         // configure Recorder to record every 'n' samples
         controller->RecorderPeriodSet(RECORD_PERIOD_SAMPLES);
 
-        // do not use a circular buffer
-        controller->RecorderCircularBufferSet(false);
-
-        // configure the number of values for each record
-        controller->RecorderDataCountSet(VALUES_PER_RECORD);
-
-        // get the host controller addresses for the values we want to record
-        axis0ActualPositionAddr = controller->AxisGet(0)->AddressGet(RSIAxisAddressType::RSIAxisAddressTypeACTUAL_POSITION);
-        axis0CommandVelocityAddr = controller->AxisGet(0)->AddressGet(RSIAxisAddressType::RSIAxisAddressTypeCOMMAND_VELOCITY);
-        axis1ActualPositionAddr = controller->AxisGet(1)->AddressGet(RSIAxisAddressType::RSIAxisAddressTypeACTUAL_POSITION);
-
-        // configure the recoder to record values from these addresses
-        controller->RecorderDataAddressSet(0, axis0ActualPositionAddr);
-        controller->RecorderDataAddressSet(1, axis0CommandVelocityAddr);
-        controller->RecorderDataAddressSet(2, axis1ActualPositionAddr);
-
-        // start recording
-        controller->RecorderStart();
-
-        // put this thread to sleep for some milliseconds
-        controller->OS->Sleep(RECORD_TIME);
-
-        // stop recording
-        controller->RecorderStop();
-
-        // find out how many records were recorded
-        long recordsAvailable = controller->RecorderRecordCountGet();
-        printf("There are %ld Records available.\n", recordsAvailable);
+        // look up the channels' addresses and types, and configure the number of values for each record and their addresses
+        SampleAppsCPP::RecorderChannelCatalog catalog(controller);
+        catalog.ChannelAdd(SEQUENCE_CHANNEL, controller->AddressGet(RSIControllerAddressTypeSAMPLE_COUNTER), SampleAppsCPP::RecordingChannelTypeINT32);
+        const int valuesPerRecord = catalog.RecorderConfigure(CHANNELS, CHANNEL_COUNT);
+        if (valuesPerRecord < 0)
+        {
+            printf("%s\n", catalog.ErrorGet());
+            controller->Delete();
+            return;
+        }
 
-        // print all the records
-        for (long i = 0; i < recordsAvailable; i++)
+        SampleAppsCPP::ColumnarRecordingWriter recordFile;
+        if (!recordFile.Open(RECORD_FILE, catalog.ChannelsGet(), catalog.ChannelCountGet(), 4096,
+            COMPRESS ? SampleAppsCPP::ColumnarCompressionDELTA_XOR : SampleAppsCPP::ColumnarCompressionNONE))
         {
-            // get the pointer to the record data
-            recordDataPtr = controller->RecorderRecordDataGet();
+            printf("Cannot create %s\n", RECORD_FILE);
+            controller->Delete();
+            return;
+        }
 
-            // copy the recorded data into an array
-            memcpy(&recordData, recordDataPtr, sizeof(recordData));
+        // turn the circular buffer on, start recording, and drain records into the file as they arrive
+        SampleAppsCPP::RecorderServiceConfig recorderConfig;
+        recorderConfig.bufferRecords = controller->RecorderRecordMaxCountGet();   // watch the fill level against the controller's buffer
+        recorderConfig.sequenceValueIndex = 0;                                  // the sample counter, CHANNELS[0]
+        recorderConfig.sequenceStep = RECORD_PERIOD_SAMPLES;                    // it advances this much per record
+        SampleAppsCPP::RecorderService<MotionController> recorder(controller, valuesPerRecord, recorderConfig);
+        recorder.Start(SampleAppsCPP::ColumnarRecordingWriter::RecordsSink, &recordFile);
 
-            // print first data value 
-            printf("Record %ld: Axis 0 ActPos: %lf ", i, recordData[0]);
+        // watch the capture once a second
+        for (int elapsed = 0; elapsed < RECORD_TIME; elapsed += 1000)
+        {
+            controller->OS->Sleep(RECORD_TIME - elapsed < 1000 ? RECORD_TIME - elapsed : 1000);
+            SampleAppsCPP::RecorderServiceStats stats = recorder.StatsGet();
+            printf("%lld records, %d waiting (peak %d), %lld overflows, %lld lost\r", (long long)stats.recordsDrained, stats.fill, stats.peakFill, (long long)stats.overflows, (long long)stats.lostRecords);
+        }
 
-            // print second data value 
-            printf("Axis 0 CmdVel: %lf ", recordData[1]);
+        // stop recording and write what is left
+        recorder.Stop();
+        if (!recordFile.Close())
+        {
+            printf("\nError writing %s\n", RECORD_FILE);
+        }
+        printf("\n");
+        recorder.Print(stdout);
 
-            // print third data value 
-            printf("Axis 1 ActPos: %lf\n", recordData[2]);
+        // load one channel back, without reading the others
+        SampleAppsCPP::ColumnarRecordingReader recording;
+        std::vector<double> positions;
+        if (!recording.Open(RECORD_FILE))
+        {
+            printf("%s: %s\n", RECORD_FILE, recording.ErrorGet());
+        }
+        else if (recording.ChannelRead(recording.ChannelIndexGet("axis0.actual_position"), positions) && !positions.empty())
+        {
+            printf("%s: %lld records, axis0.actual_position first %lf, last %lf\n", RECORD_FILE, (long long)recording.RecordCountGet(), positions.front(), positions.back());
         }
 
     }
@@ -0,0 +1,205 @@
+/*!
+*  @example    RecorderChannelCatalog.h
+
+*  @page       recorder-channel-catalog-cpp RecorderChannelCatalog.h
+
+*  @brief      Recorder channels by name ("axis3.actual_position"): addresses and types resolved once and cached, and the recorder configured in one call.
+
+*  @details
+Without it, every channel of a capture is an AddressGet(RSIAxisAddressType...) call, a RecorderDataAddressSet() call per recorder value,
+and a RecorderDataCountSet() that has to agree with both.  RecorderChannelCatalog takes channel names instead:
+
+- "axis<n>.<field>", where field is one of the RECORDER_AXIS_FIELDS below, for example "axis3.actual_position" or "axis0.status",
+- any name given to ChannelAdd() with its own address and type, for example a user buffer.
+
+A name is resolved the first time it is used, with AxisGet() and AddressGet(), and its address and type are cached,
+so reconfiguring a capture costs only the recorder calls themselves.  RecorderConfigure() resolves every name, checks that the names are
+unique and that their recorder values (two for a double) fit in maxValues, and only then sets the data count and addresses.
+After it, ChannelsGet() and ValueCountGet() are what ColumnarRecordingWriter::Open() and RecorderService need.
+Errors are returned, with the reason in ErrorGet(), rather than thrown, so a bad name does not leave the recorder half configured.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include RecorderChannelCatalog.h
+
+*/
+#ifndef CPP_RECORDER_CHANNEL_CATALOG
+#define CPP_RECORDER_CHANNEL_CATALOG
+
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "ColumnarRecording.h"                      // Import the recording channel types.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SampleAppsCPP
+{
+    struct RecorderAxisField
+    {
+        const char                          *name;
+        RSI::RapidCode::RSIAxisAddressType  addressType;
+        RecordingChannelType                type;
+    };
+
+    const RecorderAxisField RECORDER_AXIS_FIELDS[] =
+    {
+        { "actual_position",        RSI::RapidCode::RSIAxisAddressTypeACTUAL_POSITION,      RecordingChannelTypeDOUBLE },
+        { "command_position",       RSI::RapidCode::RSIAxisAddressTypeCOMMAND_POSITION,     RecordingChannelTypeDOUBLE },
+        { "command_velocity",       RSI::RapidCode::RSIAxisAddressTypeCOMMAND_VELOCITY,     RecordingChannelTypeDOUBLE },
+        { "tc_actual_position",     RSI::RapidCode::RSIAxisAddressTypeTC_ACTUAL_POSITION,   RecordingChannelTypeDOUBLE },
+        { "tc_command_position",    RSI::RapidCode::RSIAxisAddressTypeTC_COMMAND_POSITION,  RecordingChannelTypeDOUBLE },
+        { "target_feedrate",        RSI::RapidCode::RSIAxisAddressTypeTARGET_FEEDRATE,      RecordingChannelTypeDOUBLE },
+        { "encoder_primary",        RSI::RapidCode::RSIAxisAddressTypeENCODER_PRIMARY,      RecordingChannelTypeINT32 },
+        { "status",                 RSI::RapidCode::RSIAxisAddressTypeSTATUS,               RecordingChannelTypeUINT32 },
+        { "digital_inputs",         RSI::RapidCode::RSIAxisAddressTypeDIGITAL_INPUTS,       RecordingChannelTypeUINT32 },
+    };
+
+    struct RecorderChannelEntry
+    {
+        uint64_t                address;
+        RecordingChannelType    type;
+    };
+
+    class RecorderChannelCatalog
+    {
+    public:
+        /// <param name="maxValues">Recorder values the firmware can record per record.  Check the limit of yours.</param>
+        RecorderChannelCatalog(RSI::RapidCode::MotionController *controller, int32_t maxValues = 128)
+            : controller(controller), maxValues(maxValues), valueCount(0)
+        {
+            error[0] = 0;
+        }
+
+        /// <summary>
+        /// Add (or replace) a channel that is not an axis field, for example an address in the user buffer.
+        /// </summary>
+        void ChannelAdd(const char *name, uint64_t address, RecordingChannelType type)
+        {
+            RecorderChannelEntry entry = { address, type };
+            entries[name] = entry;
+        }
+
+        /// <summary>
+        /// Address and type of a channel, resolved on first use and cached.  Returns false (see ErrorGet()) for an unknown name.
+        /// </summary>
+        bool ChannelGet(const char *name, RecorderChannelEntry *entry)
+        {
+            const std::string *key = Resolve(name);
+            if (key == nullptr)
+            {
+                return false;
+            }
+            *entry = entries.find(*key)->second;
+            return true;
+        }
+
+        /// <summary>
+        /// Resolve every name, check them, then set the recorder data count and addresses (two per double).
+        /// Returns the recorder values per record, or -1 (see ErrorGet()) without touching the recorder.
+        /// </summary>
+        int32_t RecorderConfigure(const char *const *names, int32_t nameCount)
+        {
+            std::vector<RecordingChannel> resolved;
+            std::vector<uint64_t> resolvedAddresses;
+            for (int32_t i = 0; i < nameCount; i++)
+            {
+                const std::string *key = Resolve(names[i]);
+                if (key == nullptr)
+                {
+                    return -1;
+                }
+                for (size_t j = 0; j < resolved.size(); j++)
+                {
+                    if (*key == resolved[j].name)
+                    {
+                        snprintf(error, sizeof(error), "channel '%s' is listed twice", names[i]);
+                        return -1;
+                    }
+                }
+                const RecorderChannelEntry& entry = entries.find(*key)->second;
+                RecordingChannel channel = { key->c_str(), entry.type };
+                resolved.push_back(channel);
+                resolvedAddresses.push_back(entry.address);
+            }
+
+            const int32_t values = RecordingValueCountGet(resolved.data(), (int32_t)resolved.size());
+            if (values == 0 || values > maxValues)
+            {
+                snprintf(error, sizeof(error), "%d channels need %d recorder values, the recorder takes 1 to %d", nameCount, values, maxValues);
+                return -1;
+            }
+
+            RecordingChannelsConfigure(controller, resolved.data(), resolvedAddresses.data(), (int32_t)resolved.size());
+            channels.swap(resolved);
+            valueCount = values;
+            error[0] = 0;
+            return valueCount;
+        }
+
+        /// <summary>
+        /// The channels of the last RecorderConfigure(), in recorder order, for ColumnarRecordingWriter::Open().
+        /// </summary>
+        const RecordingChannel* ChannelsGet() const { return channels.data(); }
+        int32_t                 ChannelCountGet() const { return (int32_t)channels.size(); }
+        int32_t                 ValueCountGet() const { return valueCount; }            // for RecorderService
+        const char*             ErrorGet() const { return error; }
+        int32_t                 CachedCountGet() const { return (int32_t)entries.size(); }
+
+    private:
+        // The cache key of a resolved name (stable while the catalog lives), or nullptr with the reason in error.
+        const std::string* Resolve(const char *name)
+        {
+            std::unordered_map<std::string, RecorderChannelEntry>::iterator found = entries.find(name);
+            if (found != entries.end())
+            {
+                return &found->first;
+            }
+
+            // "axis<n>.<field>"
+            char *end = nullptr;
+            const long axisNumber = strncmp(name, "axis", 4) == 0 ? strtol(name + 4, &end, 10) : -1;
+            if (end == nullptr || end == name + 4 || *end != '.')
+            {
+                snprintf(error, sizeof(error), "unknown channel '%s' (expected axis<n>.<field> or a name given to ChannelAdd())", name);
+                return nullptr;
+            }
+            if (axisNumber < 0 || axisNumber >= controller->AxisCountGet())
+            {
+                snprintf(error, sizeof(error), "channel '%s': the controller has %d axes", name, controller->AxisCountGet());
+                return nullptr;
+            }
+            for (size_t i = 0; i < sizeof(RECORDER_AXIS_FIELDS) / sizeof(RECORDER_AXIS_FIELDS[0]); i++)
+            {
+                if (strcmp(end + 1, RECORDER_AXIS_FIELDS[i].name) == 0)
+                {
+                    RSI::RapidCode::Axis *axis = controller->AxisGet((int32_t)axisNumber);
+                    RecorderChannelEntry entry = { axis->AddressGet(RECORDER_AXIS_FIELDS[i].addressType), RECORDER_AXIS_FIELDS[i].type };
+                    return &entries.insert(std::make_pair(std::string(name), entry)).first->first;
+                }
+            }
+            snprintf(error, sizeof(error), "channel '%s': unknown axis field '%s'", name, end + 1);
+            return nullptr;
+        }
+
+        RSI::RapidCode::MotionController                        *controller;
+        int32_t                                                 maxValues;
+        std::unordered_map<std::string, RecorderChannelEntry>   entries;        // resolved and added channels
+        std::vector<RecordingChannel>                           channels;       // last configured, names point at entries' keys
+        int32_t                                                 valueCount;
+        char                                                    error[160];
+    };
+}
+#endif
@@ -0,0 +1,240 @@
+/*!
+@example    RecorderDrainBenchmark.cpp
+
+*  @page       recorder-drain-benchmark-cpp RecorderDrainBenchmark.cpp
+
+*  @brief      Records per second drained from a controller's recorder one RecorderRecordDataGet() at a time vs RecorderRecordsDrain(), with a hypothetical bulk call for comparison.
+
+*  @details
+The measurement that matters is the controller one: set RUN_ON_CONTROLLER, and the controller records for RECORD_MILLISECONDS and is drained
+two ways, for 2, 8 and 32 values per record:
+
+- per-record loop: RecorderRecordCountGet(), then one RecorderRecordDataGet() and one memcpy per record, the way Recorder.cpp used to read,
+- RecorderRecordsDrain(): every waiting record into one contiguous caller buffer in one call.
+
+RapidCode has no bulk recorder call, so on a controller RecorderRecordsDrain() still makes one RecorderRecordDataGet() per record: it saves the
+copies and the per-record bookkeeping, not the round trips.  Expect a small gain there, and that is the number to quote.
+
+The stand-in rows that follow are hypothetical, and are labeled so in the printed table.  SimulatedRecorder (MotionControllerStandIn.h) has a bulk
+call that RapidCode lacks, and charges an assumed CALL_OVERHEAD_US per call, so its speedups show only what such a call could save if the
+firmware had one and if a call cost that much.  It also times RecorderRecordsSpanGet(), the records read in place without a copy.
+Every method adds up the values it drained, so none of them can skip touching the data, and on the stand-in the sums must match.
+Build with SAMPLEAPPS_NO_RAPIDCODE defined to leave out rsi.h and run only the stand-in.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include RecorderDrainBenchmark.cpp
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#endif
+#include "RecorderService.h"                        // Import the recorder drain functions.
+#include "MotionControllerStandIn.h"                // Import the software stand-in for the recorder.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int       VALUES_PER_RECORD[] = { 2, 8, 32 };
+    const int       BUFFER_RECORDS = 100000;                            // records drained per run
+    const double    STAND_IN_SAMPLE_RATE = 1.0e7;                       // fills the stand-in's buffer in 10 ms
+    const double    CALL_OVERHEAD_US = 1.0;                             // per recorder call
+    const int       RECORD_MILLISECONDS = 2000;                         // controller capture drained per run (1 record per sample)
+    const bool      RUN_ON_CONTROLLER = false;                          // set true to time draining a real controller's recorder (the headline)
+    const char      STAND_IN_NAME[] = "stand-in*";                      // hypothetical rows, footnoted under the table
+
+    struct DrainResult
+    {
+        int64_t records;
+        double  seconds;
+        int64_t checksum;
+    };
+
+    int64_t ValuesSum(const int32_t *values, size_t count)
+    {
+        int64_t sum = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    // the way Recorder.cpp used to read: one call and one copy per record
+    template <class ControllerT>
+    DrainResult PerRecordDrain(ControllerT *controller, int32_t valuesPerRecord, std::vector<int32_t>& buffer)
+    {
+        DrainResult result = DrainResult();
+        const Clock::time_point start = Clock::now();
+        const int32_t waiting = controller->RecorderRecordCountGet();
+        for (int32_t i = 0; i < waiting; i++)
+        {
+            const int32_t *record = controller->RecorderRecordDataGet();
+            memcpy(&buffer[(size_t)i * valuesPerRecord], record, sizeof(int32_t) * valuesPerRecord);
+        }
+        result.checksum = ValuesSum(buffer.data(), (size_t)waiting * valuesPerRecord);
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.records = waiting;
+        return result;
+    }
+
+    template <class ControllerT>
+    DrainResult BufferDrain(ControllerT *controller, int32_t valuesPerRecord, std::vector<int32_t>& buffer)
+    {
+        DrainResult result = DrainResult();
+        const Clock::time_point start = Clock::now();
+        result.records = SampleAppsCPP::RecorderRecordsDrain(controller, valuesPerRecord, buffer.data(), (int32_t)(buffer.size() / valuesPerRecord));
+        result.checksum = ValuesSum(buffer.data(), (size_t)result.records * valuesPerRecord);
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+    template <class ControllerT>
+    DrainResult SpanDrain(ControllerT *controller, int32_t valuesPerRecord, std::vector<int32_t>& scratch)
+    {
+        DrainResult result = DrainResult();
+        const Clock::time_point start = Clock::now();
+        const SampleAppsCPP::RecordSpan span = SampleAppsCPP::RecorderRecordsSpanGet(controller, valuesPerRecord, controller->RecorderRecordCountGet(), scratch);
+        result.checksum = ValuesSum(span.records, (size_t)span.recordCount * valuesPerRecord);
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.records = span.recordCount;
+        return result;
+    }
+
+    void ResultPrint(const char *controllerName, int32_t valuesPerRecord, const char *method, const DrainResult& result, const DrainResult& baseline, bool sameRecords = true)
+    {
+        printf("%-10s %6d %-24s | %8lld %10.2lf %12.0lf %8.1lfx %s\n", controllerName, valuesPerRecord, method, (long long)result.records, result.seconds * 1000.0,
+            result.records / result.seconds, baseline.seconds / result.seconds * result.records / baseline.records,
+            !sameRecords || result.checksum == baseline.checksum ? "" : "(different records)");
+    }
+
+    // Fill the stand-in's buffer, linear so it stops when full, and return it with BUFFER_RECORDS records waiting.
+    void StandInFill(SampleAppsCPP::SimulatedRecorder& recorder, int32_t valuesPerRecord)
+    {
+        recorder.RecorderCircularBufferSet(false);
+        recorder.RecorderDataCountSet(valuesPerRecord);
+        recorder.RecorderDataAddressSet(0, SampleAppsCPP::SimulatedRecorder::SAMPLE_COUNTER_ADDRESS);
+        for (int32_t i = 1; i < valuesPerRecord; i++)
+        {
+            recorder.RecorderDataAddressSet(i, 0x1000 + 8 * i);
+        }
+        recorder.RecorderStart();
+        while (recorder.RecorderRecordCountGet() < BUFFER_RECORDS)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        recorder.RecorderStop();
+    }
+
+    void StandInSweep()
+    {
+        printf("\nHypothetical: software stand-in with a bulk recorder call RapidCode does not have, an assumed %.2lf us per call, %d records per run\n",
+            CALL_OVERHEAD_US, BUFFER_RECORDS);
+        printf("%-10s %6s %-24s | %8s %10s %12s %9s\n", "recorder", "values", "method", "records", "ms", "records/s", "speedup");
+        for (size_t v = 0; v < sizeof(VALUES_PER_RECORD) / sizeof(VALUES_PER_RECORD[0]); v++)
+        {
+            const int32_t valuesPerRecord = VALUES_PER_RECORD[v];
+            std::vector<int32_t> buffer((size_t)BUFFER_RECORDS * valuesPerRecord);
+            std::vector<int32_t> scratch;
+
+            // the same records every run: the stand-in's values depend only on the addresses and the record's sample
+            SampleAppsCPP::SimulatedRecorder perRecord(STAND_IN_SAMPLE_RATE, BUFFER_RECORDS, CALL_OVERHEAD_US);
+            StandInFill(perRecord, valuesPerRecord);
+            const DrainResult baseline = PerRecordDrain(&perRecord, valuesPerRecord, buffer);
+            ResultPrint(STAND_IN_NAME, valuesPerRecord, "per-record loop", baseline, baseline);
+
+            SampleAppsCPP::SimulatedRecorder drain(STAND_IN_SAMPLE_RATE, BUFFER_RECORDS, CALL_OVERHEAD_US);
+            StandInFill(drain, valuesPerRecord);
+            ResultPrint(STAND_IN_NAME, valuesPerRecord, "RecorderRecordsDrain()", BufferDrain(&drain, valuesPerRecord, buffer), baseline);
+
+            SampleAppsCPP::SimulatedRecorder span(STAND_IN_SAMPLE_RATE, BUFFER_RECORDS, CALL_OVERHEAD_US);
+            StandInFill(span, valuesPerRecord);
+            ResultPrint(STAND_IN_NAME, valuesPerRecord, "RecorderRecordsSpanGet()", SpanDrain(&span, valuesPerRecord, scratch), baseline);
+        }
+        printf("* hypothetical: not a RapidCode measurement.  Quote the controller rows.\n");
+    }
+
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    using namespace RSI::RapidCode;
+
+    // Record for RECORD_MILLISECONDS, stop, and drain what the controller kept.  Records axis 0's position, so nothing moves.
+    template <class DrainFn>
+    DrainResult ControllerRun(MotionController *controller, int32_t valuesPerRecord, DrainFn drain)
+    {
+        const uint64 address = controller->AxisGet(0)->AddressGet(RSIAxisAddressTypeACTUAL_POSITION);
+        controller->RecorderPeriodSet(1);
+        controller->RecorderCircularBufferSet(false);
+        controller->RecorderDataCountSet(valuesPerRecord);
+        for (int32_t i = 0; i < valuesPerRecord; i++)
+        {
+            controller->RecorderDataAddressSet(i, address + 4 * (i % 2));
+        }
+        controller->RecorderStart();
+        controller->OS->Sleep(RECORD_MILLISECONDS);
+        controller->RecorderStop();
+        return drain();
+    }
+
+    void ControllerSweep(MotionController *controller)
+    {
+        printf("\nController (RapidCode, no bulk call): %d ms of records per run\n", RECORD_MILLISECONDS);
+        printf("%-10s %6s %-24s | %8s %10s %12s %9s\n", "recorder", "values", "method", "records", "ms", "records/s", "speedup");
+        for (size_t v = 0; v < sizeof(VALUES_PER_RECORD) / sizeof(VALUES_PER_RECORD[0]); v++)
+        {
+            const int32_t valuesPerRecord = VALUES_PER_RECORD[v];
+            std::vector<int32_t> buffer((size_t)(controller->SampleRateGet() * RECORD_MILLISECONDS / 1000.0 + 1) * valuesPerRecord);
+
+            const DrainResult baseline = ControllerRun(controller, valuesPerRecord, [&]() { return PerRecordDrain(controller, valuesPerRecord, buffer); });
+            ResultPrint("controller", valuesPerRecord, "per-record loop", baseline, baseline);
+            const DrainResult drained = ControllerRun(controller, valuesPerRecord, [&]() { return BufferDrain(controller, valuesPerRecord, buffer); });
+            ResultPrint("controller", valuesPerRecord, "RecorderRecordsDrain()", drained, baseline, false);   // a new capture each run
+        }
+    }
+#endif
+}
+
+void recorderDrainBenchmarkMain()
+{
+    // the real controller first: it is the comparison that counts
+#ifndef SAMPLEAPPS_NO_RAPIDCODE
+    if (RUN_ON_CONTROLLER)
+    {
+        MotionController *controller = MotionController::CreateFromSoftware();
+        SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+        try
+        {
+            SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+            ControllerSweep(controller);
+        }
+        catch (RsiError const& err)
+        {
+            printf("\n%s\n", err.text);
+        }
+        controller->Delete();                               // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+    }
+    else
+    {
+        printf("\nRUN_ON_CONTROLLER is off: no controller measurement, only the hypothetical stand-in below.\n");
+    }
+#else
+    printf("\nBuilt without RapidCode: no controller measurement, only the hypothetical stand-in below.\n");
+#endif
+
+    StandInSweep();
+}
@@ -0,0 +1,388 @@
+/*!
+*  @example    RecorderService.h
+
+*  @page       recorder-service-cpp RecorderService.h
+
+*  @brief      Continuous recorder capture: circular buffer on, a background thread drains records as they arrive, watches the fill level and counts losses.
+
+*  @details
+Recorder.cpp records with the circular buffer off, sleeps, and reads the records at the end, so a capture can never be longer than the controller's buffer.
+
+RecorderService turns the circular buffer on, starts the recorder, and runs a drain thread that:
+<ul>
+<li>reads RecorderRecordCountGet() every pollMilliseconds and passes those records to a sink callback, for example a file writer,
+batchRecords at a time (see RecorderRecordsSpanGet() below),</li>
+<li>keeps the current and peak fill level, and drains again without sleeping while the buffer is above highWaterFraction of bufferRecords,</li>
+<li>counts an overflow whenever it finds the buffer full, because the controller has then started overwriting records it had not read,</li>
+<li>with sequenceValueIndex set to a value that holds a free-running counter (for example the sample counter), checks every record's step
+and counts exactly how many records were lost.</li>
+</ul>
+Stop() asks the thread to stop the recorder, drain what is left and hand the last batch to the sink.  The statistics can be read at any time.
+
+The retrieval functions can also be used on their own:
+<ul>
+<li>RecorderRecordsDrain() empties the waiting records into a caller's contiguous buffer in one call,</li>
+<li>RecorderRecordsSpanGet() returns a RecordSpan over recordCount waiting records.  If the controller has a bulk call
+(RecorderRecordDataSpanGet(), as SimulatedRecorder does) the span points into the controller's block and nothing is copied.
+Otherwise the records are fetched one RecorderRecordDataGet() at a time into the caller's scratch buffer.</li>
+</ul>
+RecorderDrainBenchmark.cpp compares their records per second with the per-record loop.
+
+The controller is a template parameter: MotionController with RapidCode, or SimulatedRecorder (MotionControllerStandIn.h) offline.
+While the service runs, the drain thread is the only one that should make recorder calls.
+For hours-long captures at 1 kHz, keep the sink fast (buffered writes, no printf) and give the thread enough priority to keep up.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include RecorderService.h
+
+*/
+#ifndef CPP_RECORDER_SERVICE
+#define CPP_RECORDER_SERVICE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SampleAppsCPP
+{
+    struct RecorderServiceConfig
+    {
+        int32_t pollMilliseconds;                   // sleep between drain passes while the buffer is below the high-water mark
+        int32_t batchRecords;                       // records handed to the sink at a time
+        int32_t bufferRecords;                      // records the controller buffer holds, for the fill level and overflow check (0 if unknown)
+        double  highWaterFraction;                  // above this fill, drain again without sleeping
+        int32_t sequenceValueIndex;                 // value holding a free-running counter, to count lost records exactly (-1 for none)
+        int32_t sequenceStep;                       // expected counter step between records, usually the recorder period in samples
+
+        RecorderServiceConfig()
+            : pollMilliseconds(5), batchRecords(1024), bufferRecords(0), highWaterFraction(0.5), sequenceValueIndex(-1), sequenceStep(1) {}
+    };
+
+    struct RecorderServiceStats
+    {
+        int64_t recordsDrained;
+        int64_t batches;                            // sink calls
+        int64_t sinkFailures;                       // sink calls that returned false
+        int64_t passes;                             // drain passes
+        int32_t fill;                               // records waiting at the last pass
+        int32_t peakFill;
+        int64_t overflows;                          // passes that found the buffer full
+        int64_t lostRecords;                        // counted from sequence gaps (sequenceValueIndex only)
+        int64_t sequenceErrors;                     // counter steps that were 0 or went backwards
+        double  maxPassMilliseconds;
+        bool    failed;                             // a recorder call threw, and the drain thread stopped
+    };
+
+    /// <summary>
+    /// Receives drained records, recordCount * valuesPerRecord values in record order.  Runs on the drain thread.  Return false on a write error.
+    /// </summary>
+    typedef bool (*RecordSink)(void *context, const int32_t *records, int32_t recordCount, int32_t valuesPerRecord);
+
+    /// <summary>
+    /// Records in order, contiguous: recordCount * valuesPerRecord values.
+    /// </summary>
+    struct RecordSpan
+    {
+        const int32_t   *records;
+        int32_t         recordCount;
+    };
+
+    // true_type if ControllerT has RecorderRecordDataSpanGet(int32_t maxRecords, int32_t *recordCount)
+    template <class ControllerT, class = void>
+    struct RecorderSpanSupport : std::false_type {};
+    template <class ControllerT>
+    struct RecorderSpanSupport<ControllerT, decltype((void)std::declval<ControllerT&>().RecorderRecordDataSpanGet(0, (int32_t *)nullptr))> : std::true_type {};
+
+    template <class ControllerT>
+    RecordSpan RecorderRecordsSpanGet(ControllerT *controller, int32_t valuesPerRecord, int32_t recordCount, std::vector<int32_t>& scratch, std::true_type)
+    {
+        (void)valuesPerRecord;
+        (void)scratch;
+        RecordSpan span;
+        span.records = controller->RecorderRecordDataSpanGet(recordCount, &span.recordCount);
+        return span;
+    }
+
+    template <class ControllerT>
+    RecordSpan RecorderRecordsSpanGet(ControllerT *controller, int32_t valuesPerRecord, int32_t recordCount, std::vector<int32_t>& scratch, std::false_type)
+    {
+        if (scratch.size() < (size_t)recordCount * valuesPerRecord)
+        {
+            scratch.resize((size_t)recordCount * valuesPerRecord);
+        }
+        for (int32_t i = 0; i < recordCount; i++)
+        {
+            memcpy(&scratch[(size_t)i * valuesPerRecord], controller->RecorderRecordDataGet(), sizeof(int32_t) * valuesPerRecord);
+        }
+        RecordSpan span = { scratch.data(), recordCount };
+        return span;
+    }
+
+    /// <summary>
+    /// The oldest recordCount waiting records (fewer if fewer are waiting, with a bulk call).  Check RecorderRecordCountGet() first.
+    /// With a bulk call the span is the controller's own block, valid until the next recorder call; otherwise it is scratch.
+    /// </summary>
+    template <class ControllerT>
+    RecordSpan RecorderRecordsSpanGet(ControllerT *controller, int32_t valuesPerRecord, int32_t recordCount, std::vector<int32_t>& scratch)
+    {
+        return RecorderRecordsSpanGet(controller, valuesPerRecord, recordCount, scratch, RecorderSpanSupport<ControllerT>());
+    }
+
+    /// <summary>
+    /// Copy every waiting record, up to maxRecords, into buffer (maxRecords * valuesPerRecord values).  Returns the records copied.
+    /// </summary>
+    template <class ControllerT>
+    int32_t RecorderRecordsDrain(ControllerT *controller, int32_t valuesPerRecord, int32_t *buffer, int32_t maxRecords)
+    {
+        const int32_t waiting = controller->RecorderRecordCountGet();
+        const int32_t count = waiting < maxRecords ? waiting : maxRecords;
+        if (RecorderSpanSupport<ControllerT>::value)
+        {
+            std::vector<int32_t> unused;
+            const RecordSpan span = RecorderRecordsSpanGet(controller, valuesPerRecord, count, unused);
+            memcpy(buffer, span.records, sizeof(int32_t) * valuesPerRecord * span.recordCount);
+            return span.recordCount;
+        }
+        for (int32_t i = 0; i < count; i++)
+        {
+            memcpy(buffer + (size_t)i * valuesPerRecord, controller->RecorderRecordDataGet(), sizeof(int32_t) * valuesPerRecord);
+        }
+        return count;
+    }
+
+    template <class ControllerT>
+    class RecorderService
+    {
+    public:
+        /// <param name="valuesPerRecord">The count given to RecorderDataCountSet().</param>
+        RecorderService(ControllerT *controller, int32_t valuesPerRecord, const RecorderServiceConfig& config = RecorderServiceConfig())
+            : controller(controller), valuesPerRecord(valuesPerRecord), config(config), sink(nullptr), sinkContext(nullptr),
+              batchRecords(config.batchRecords > 0 ? config.batchRecords : 1), batch((size_t)batchRecords * valuesPerRecord),
+              hasSequence(false), previousSequence(0), running(false), stopRequested(false)
+        {
+            StatsReset();
+        }
+
+        ~RecorderService() { Stop(); }
+
+        /// <summary>
+        /// Turn the circular buffer on, start the recorder and the drain thread.  Configure the period, count and addresses first.
+        /// The thread inherits this thread's scheduling, so start it before raising a real-time thread's priority.
+        /// </summary>
+        bool Start(RecordSink recordSink, void *context)
+        {
+            if (running || recordSink == nullptr)
+            {
+                return false;
+            }
+            sink = recordSink;
+            sinkContext = context;
+            hasSequence = false;
+            StatsReset();
+            controller->RecorderCircularBufferSet(true);
+            controller->RecorderStart();
+            stopRequested.store(false);
+            running = true;
+            drainThread = std::thread([this]() { DrainLoop(); });
+            return true;
+        }
+
+        /// <summary>
+        /// Stop the recorder, drain the records still in the buffer, hand the last batch to the sink and end the thread.
+        /// </summary>
+        void Stop()
+        {
+            if (!running)
+            {
+                return;
+            }
+            stopRequested.store(true);
+            drainThread.join();
+            running = false;
+        }
+
+        bool IsRunningGet() const { return running; }
+
+        /// <summary>
+        /// Statistics so far.  Safe to call while the service runs.
+        /// </summary>
+        RecorderServiceStats StatsGet() const
+        {
+            RecorderServiceStats stats;
+            stats.recordsDrained = recordsDrained.load();
+            stats.batches = batches.load();
+            stats.sinkFailures = sinkFailures.load();
+            stats.passes = passes.load();
+            stats.fill = fill.load();
+            stats.peakFill = peakFill.load();
+            stats.overflows = overflows.load();
+            stats.lostRecords = lostRecords.load();
+            stats.sequenceErrors = sequenceErrors.load();
+            stats.maxPassMilliseconds = maxPassUs.load() / 1000.0;
+            stats.failed = failed.load();
+            return stats;
+        }
+
+        void Print(FILE *out) const
+        {
+            const RecorderServiceStats stats = StatsGet();
+            fprintf(out, "Recorder service: %lld records drained in %lld batches over %lld passes%s\n",
+                (long long)stats.recordsDrained, (long long)stats.batches, (long long)stats.passes, stats.failed ? ", STOPPED BY A RECORDER ERROR" : "");
+            if (config.bufferRecords > 0)
+            {
+                fprintf(out, "  fill: %d now, %d peak of %d records (%.0lf%%)\n", stats.fill, stats.peakFill, config.bufferRecords, 100.0 * stats.peakFill / config.bufferRecords);
+            }
+            else
+            {
+                fprintf(out, "  fill: %d now, %d peak records\n", stats.fill, stats.peakFill);
+            }
+            fprintf(out, "  %lld overflows, %lld lost records%s, %lld sequence errors, %lld sink failures, longest pass %.3lf ms\n",
+                (long long)stats.overflows, (long long)stats.lostRecords, config.sequenceValueIndex >= 0 ? "" : " (no sequence value, not counted)",
+                (long long)stats.sequenceErrors, (long long)stats.sinkFailures, stats.maxPassMilliseconds);
+        }
+
+    private:
+        void StatsReset()
+        {
+            recordsDrained = 0;
+            batches = 0;
+            sinkFailures = 0;
+            passes = 0;
+            fill = 0;
+            peakFill = 0;
+            overflows = 0;
+            lostRecords = 0;
+            sequenceErrors = 0;
+            maxPassUs = 0;
+            failed = false;
+        }
+
+        void DrainLoop()
+        {
+            try
+            {
+                while (!stopRequested.load())
+                {
+                    const int32_t waiting = DrainPass();
+                    const bool aboveHighWater = config.bufferRecords > 0 ? waiting > config.highWaterFraction * config.bufferRecords : waiting >= config.batchRecords;
+                    if (!aboveHighWater)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(config.pollMilliseconds));
+                    }
+                }
+                controller->RecorderStop();
+                DrainPass();
+            }
+            catch (...)
+            {
+                failed = true;
+            }
+        }
+
+        // Drain the records waiting now.  Returns how many there were.
+        int32_t DrainPass()
+        {
+            typedef std::chrono::steady_clock Clock;
+            const Clock::time_point start = Clock::now();
+            const int32_t waiting = controller->RecorderRecordCountGet();
+            fill = waiting;
+            peakFill = waiting > peakFill.load() ? waiting : peakFill.load();
+            if (config.bufferRecords > 0 && waiting >= config.bufferRecords)
+            {
+                ++overflows;
+            }
+
+            // hand the records to the sink batchRecords at a time, straight from the controller's block when it has a bulk call
+            int32_t drained = 0;
+            while (drained < waiting)
+            {
+                const int32_t count = waiting - drained < batchRecords ? waiting - drained : batchRecords;
+                const RecordSpan span = RecorderRecordsSpanGet(controller, valuesPerRecord, count, batch);
+                if (span.recordCount <= 0)
+                {
+                    break;
+                }
+                if (config.sequenceValueIndex >= 0)
+                {
+                    for (int32_t i = 0; i < span.recordCount; i++)
+                    {
+                        SequenceCheck(span.records[(size_t)i * valuesPerRecord + config.sequenceValueIndex]);
+                    }
+                }
+                if (!sink(sinkContext, span.records, span.recordCount, valuesPerRecord))
+                {
+                    ++sinkFailures;
+                }
+                ++batches;
+                drained += span.recordCount;
+            }
+            recordsDrained += drained;
+            ++passes;
+
+            const double passUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            maxPassUs = passUs > maxPassUs.load() ? passUs : maxPassUs.load();
+            return waiting;
+        }
+
+        void SequenceCheck(int32_t sequence)
+        {
+            if (hasSequence)
+            {
+                const int32_t step = (int32_t)((uint32_t)sequence - (uint32_t)previousSequence);
+                if (step <= 0)
+                {
+                    ++sequenceErrors;
+                }
+                else if (step > config.sequenceStep)
+                {
+                    lostRecords += step / config.sequenceStep - 1;
+                }
+            }
+            hasSequence = true;
+            previousSequence = sequence;
+        }
+
+        ControllerT             *controller;
+        int32_t                 valuesPerRecord;
+        RecorderServiceConfig   config;
+        RecordSink              sink;
+        void                    *sinkContext;
+        int32_t                 batchRecords;
+        std::vector<int32_t>    batch;                      // scratch for controllers without a bulk call
+        bool                    hasSequence;
+        int32_t                 previousSequence;
+        bool                    running;
+        std::thread             drainThread;
+        std::atomic<bool>       stopRequested;
+
+        // written by the drain thread, read by StatsGet()
+        std::atomic<int64_t>    recordsDrained;
+        std::atomic<int64_t>    batches;
+        std::atomic<int64_t>    sinkFailures;
+        std::atomic<int64_t>    passes;
+        std::atomic<int32_t>    fill;
+        std::atomic<int32_t>    peakFill;
+        std::atomic<int64_t>    overflows;
+        std::atomic<int64_t>    lostRecords;
+        std::atomic<int64_t>    sequenceErrors;
+        std::atomic<double>     maxPassUs;
+        std::atomic<bool>       failed;
+    };
+}
+#endif
@@ -0,0 +1,308 @@
+/*!
+*  @example    StreamingDepthController.h
+
+*  @page       streaming-depth-controller-cpp StreamingDepthController.h
+
+*  @brief      Adaptive queued-point depth for streaming PT/PVT motion.
+
+*  @details
+StreamingMotionBufferManagement.cpp keeps a fixed DESIRED_POINTS and UpdateBufferPoints.cpp keeps "at least two motion IDs queued".
+Both have to be sized for the worst host latency ever seen, which adds command-to-motion latency all the time.
+
+This file has three small pieces that work together:
+
+StreamingBlockLedger:       remembers how many points each MovePT()/MovePVT() call sent, so the executing motion ID and element ID
+                            (MotionIdExecutingGet(), MotionElementIdExecutingGet()) turn into an exact count of points still queued.
+
+HostTickCounter:            extends the 32-bit PerformanceTimerCountGet() into a 64-bit count that does not wrap, for every host timestamp below.
+
+WakeLatencyEstimator:       turns the sample counter returned by SyncInterruptWait() and a host timestamp into the host wake-up latency in samples.
+
+StreamingDepthController:   grows the target depth quickly when latency rises or the queue gets close to EMPTY_CT, and shrinks it slowly when things are quiet.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include StreamingDepthController.h
+
+*/
+#ifndef CPP_STREAMING_DEPTH_CONTROLLER
+#define CPP_STREAMING_DEPTH_CONTROLLER
+
+#include <cmath>
+#include <cstdint>
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// Tracks the points sent by each streaming motion call so queued points can be computed from the executing motion/element IDs.
+    /// Each MovePT()/MovePVT() call with final=false gets the next motion ID and restarts the element ID at 0.
+    /// </summary>
+    class StreamingBlockLedger
+    {
+    public:
+        static const int MAX_BLOCKS = 256;                  // Motion IDs remembered.  Must exceed the number of blocks ever queued at once.
+
+        StreamingBlockLedger() { Reset(0); }
+
+        /// <summary>
+        /// Start over.  firstMotionId is the ID the next streaming call will get (the value passed to MotionIdSet()).
+        /// </summary>
+        void Reset(int32_t firstMotionId)
+        {
+            nextMotionId = firstMotionId;
+            oldestMotionId = firstMotionId;
+            pointsSent = 0;
+        }
+
+        /// <summary>
+        /// Record a streaming call.  Returns the motion ID the call is expected to get.
+        /// </summary>
+        int32_t BlockSent(int32_t pointCount)
+        {
+            const int32_t motionId = nextMotionId++;
+            firstPointOfBlock[motionId & (MAX_BLOCKS - 1)] = pointsSent;
+            pointsSent += pointCount;
+            if (nextMotionId - oldestMotionId > MAX_BLOCKS)
+            {
+                oldestMotionId = nextMotionId - MAX_BLOCKS;
+            }
+            return motionId;
+        }
+
+        /// <summary>
+        /// Points the controller has already consumed.
+        /// </summary>
+        int64_t PointsExecutedGet(int32_t executingMotionId, int32_t executingElementId) const
+        {
+            if (executingMotionId < oldestMotionId)
+            {
+                return 0;                                   // still executing something from before the first tracked block
+            }
+            if (executingMotionId >= nextMotionId)
+            {
+                return pointsSent;                          // past everything we sent
+            }
+            return firstPointOfBlock[executingMotionId & (MAX_BLOCKS - 1)] + executingElementId;
+        }
+
+        /// <summary>
+        /// Points sent but not yet executed.
+        /// </summary>
+        int64_t QueuedPointsGet(int32_t executingMotionId, int32_t executingElementId) const
+        {
+            return pointsSent - PointsExecutedGet(executingMotionId, executingElementId);
+        }
+
+        int64_t PointsSentGet() const { return pointsSent; }
+        int32_t NextMotionIdGet() const { return nextMotionId; }
+
+    private:
+        static_assert((MAX_BLOCKS & (MAX_BLOCKS - 1)) == 0, "MAX_BLOCKS must be a power of two.");
+
+        int64_t firstPointOfBlock[MAX_BLOCKS];
+        int64_t pointsSent;
+        int32_t nextMotionId;
+        int32_t oldestMotionId;
+    };
+
+    /// <summary>
+    /// PerformanceTimerCountGet() is 32 bits wide and wraps (every 7 minutes at 10 MHz).  Widened straight to 64 bits, a wrap is a jump
+    /// of 2^32 ticks, or a sign extension, in every difference and offset computed from it.  HostTickCounter adds the 32-bit difference
+    /// since the last reading to a running 64-bit count instead.  Read it at least once per wrap, and from one thread only.
+    /// </summary>
+    class HostTickCounter
+    {
+    public:
+        HostTickCounter() : count(0), last(0), started(false) {}
+
+        /// <summary>
+        /// The running count for a raw 32-bit reading.
+        /// </summary>
+        uint64_t Extend(uint32_t ticks)
+        {
+            count = started ? count + (uint32_t)(ticks - last) : ticks;
+            last = ticks;
+            started = true;
+            return count;
+        }
+
+        /// <summary>
+        /// Read the host timer (controller->OS) and return the running count.
+        /// </summary>
+        template <class OsT>
+        uint64_t Read(OsT *os) { return Extend((uint32_t)os->PerformanceTimerCountGet()); }
+
+    private:
+        uint64_t    count;
+        uint32_t    last;
+        bool        started;
+    };
+
+    /// <summary>
+    /// Estimates how late the host woke up after each sync interrupt, in controller samples.
+    /// The controller sample counter and the host clock both run at a steady rate, so the smallest (host time - sample time) offset
+    /// seen is the earliest possible wake-up.  Latency is how far each wake-up lands after that.
+    /// </summary>
+    class WakeLatencyEstimator
+    {
+    public:
+        /// <param name="hostTicksPerSample">Host timer ticks per controller sample (PerformanceTimerFrequencyGet() / SampleRateGet()).</param>
+        explicit WakeLatencyEstimator(double hostTicksPerSample) : ticksPerSample(hostTicksPerSample), hasBaseline(false), baseline(0) {}
+
+        /// <summary>
+        /// Call right after SyncInterruptWait() returns.  Returns the wake-up latency in samples (0 for the best wake-up seen).
+        /// </summary>
+        /// <param name="hostTicks">HostTickCounter::Read(), not the raw PerformanceTimerCountGet(), which wraps.</param>
+        double Update(int32_t sampleCounter, uint64_t hostTicks)
+        {
+            const double offset = (double)hostTicks / ticksPerSample - (double)sampleCounter;
+            if (!hasBaseline || offset < baseline)
+            {
+                baseline = offset;
+                hasBaseline = true;
+            }
+            else
+            {
+                baseline += CLOCK_DRIFT_PER_UPDATE;         // let the baseline follow slow drift between the two clocks
+            }
+            return offset - baseline;
+        }
+
+    private:
+        static constexpr double CLOCK_DRIFT_PER_UPDATE = 1e-6;
+
+        double ticksPerSample;
+        bool   hasBaseline;
+        double baseline;
+    };
+
+    /// <summary>
+    /// Configuration for StreamingDepthController.  All counts are in points.
+    /// </summary>
+    struct StreamingDepthConfig
+    {
+        int32_t emptyCount;                                 // EMPTY_CT passed to MovePT().  The queue must never reach this.
+        int32_t minPoints;                                  // Never ask for less than this many queued points.
+        int32_t maxPoints;                                  // Never ask for more than this many queued points.
+        int32_t blockPoints;                                // Send in multiples of this many points (1 for no rounding).
+        double  samplesPerPoint;                            // Controller samples per point (TIME_SLICE * sample rate).
+        double  syncPeriodSamples;                          // Samples between sync interrupts (SyncInterruptPeriodSet()).
+        double  latencyDecay;                               // Per-cycle decay of the remembered latency peak, e.g. 0.999.
+        int32_t quietCyclesToShrink;                        // Cycles without a close call before the safety factor shrinks.
+        double  startupLatencySamples;                      // Wake-up latency assumed before any is measured (the worst expected); fades like a measured peak.
+    };
+
+    /// <summary>
+    /// Chooses how many points to keep queued from measured host latency and queue margin.
+    /// </summary>
+    /// @code
+    ///     SampleAppsCPP::HostTickCounter hostTimer;          // declared once, before the loop
+    ///     ...
+    ///     int32 sample = controller->SyncInterruptWait();
+    ///     double latency = wakeLatency.Update(sample, hostTimer.Read(controller->OS));
+    ///     int64_t queued = ledger.QueuedPointsGet(multiAxis->MotionIdExecutingGet(), multiAxis->MotionElementIdExecutingGet());
+    ///     int32_t toSend = depth.Update(latency, queued);
+    ///     if (toSend > 0) { multiAxis->MovePT(..., toSend, EMPTY_CT, false, false); ledger.BlockSent(toSend); }
+    /// @endcode
+    /// Queue InitialPointsGet() points before starting the motion: it already covers startupLatencySamples with STARTUP_SAFETY_FACTOR,
+    /// so a late first wake-up does not reach EMPTY_CT before the estimator has seen one.
+    class StreamingDepthController
+    {
+    public:
+        explicit StreamingDepthController(const StreamingDepthConfig& config)
+            : config(config), latencyPeak(config.startupLatencySamples > 0.0 ? config.startupLatencySamples : 0.0), safetyFactor(STARTUP_SAFETY_FACTOR),
+              quietCycles(0), targetPoints((int32_t)TargetGet()), closestMargin(INT32_MAX) {}
+
+        /// <summary>
+        /// Points to queue before the motion starts, rounded up to blockPoints.
+        /// </summary>
+        int32_t InitialPointsGet() const { return (int32_t)BlockRound(TargetGet()); }
+
+        /// <summary>
+        /// Call once per sync interrupt.  Returns how many points to send now (already rounded to blockPoints), or 0.
+        /// </summary>
+        /// <param name="wakeLatencySamples">Host wake-up latency for this cycle, from WakeLatencyEstimator.</param>
+        /// <param name="queuedPoints">Points still queued, from StreamingBlockLedger.</param>
+        int32_t Update(double wakeLatencySamples, int64_t queuedPoints)
+        {
+            // remember the worst recent latency, letting it fade slowly
+            latencyPeak *= config.latencyDecay;
+            if (wakeLatencySamples > latencyPeak)
+            {
+                latencyPeak = wakeLatencySamples;
+            }
+
+            // a close call grows the safety factor right away, quiet cycles shrink it slowly
+            const int64_t margin = queuedPoints - config.emptyCount;
+            if (margin < closestMargin)
+            {
+                closestMargin = (int32_t)margin;
+            }
+            if (margin * config.samplesPerPoint < config.syncPeriodSamples)
+            {
+                safetyFactor = std::fmin(safetyFactor * GROW_FACTOR, MAX_SAFETY_FACTOR);
+                quietCycles = 0;
+            }
+            else if (++quietCycles >= config.quietCyclesToShrink)
+            {
+                safetyFactor = std::fmax(safetyFactor * SHRINK_FACTOR, 1.0);
+                quietCycles = 0;
+            }
+
+            const int64_t target = TargetGet();
+            targetPoints = (int32_t)target;
+
+            if (queuedPoints >= target)
+            {
+                return 0;
+            }
+            return (int32_t)BlockRound(target - queuedPoints);
+        }
+
+        int32_t TargetPointsGet() const { return targetPoints; }
+        double  LatencyPeakGet() const { return latencyPeak; }
+        double  SafetyFactorGet() const { return safetyFactor; }
+        int32_t ClosestMarginGet() const { return closestMargin; }  // smallest queuedPoints - emptyCount seen so far
+
+    private:
+        static constexpr double GROW_FACTOR = 1.5;
+        static constexpr double SHRINK_FACTOR = 0.95;
+        static constexpr double MAX_SAFETY_FACTOR = 8.0;
+        static constexpr double STARTUP_SAFETY_FACTOR = 2.0;   // shrinks toward 1 once the cycles are quiet
+
+        static int64_t Clamp(int64_t value, int64_t low, int64_t high)
+        {
+            return value < low ? low : (value > high ? high : value);
+        }
+
+        // until the next refill we must cover one sync period plus the worst wake-up latency, then keep EMPTY_CT in reserve
+        int64_t TargetGet() const
+        {
+            const double samplesToCover = (config.syncPeriodSamples + latencyPeak) * safetyFactor;
+            const int64_t target = config.emptyCount + (int64_t)std::ceil(samplesToCover / config.samplesPerPoint);
+            return Clamp(target, config.minPoints, config.maxPoints);
+        }
+
+        int64_t BlockRound(int64_t points) const
+        {
+            return config.blockPoints > 1 ? ((points + config.blockPoints - 1) / config.blockPoints) * config.blockPoints : points;
+        }
+
+        StreamingDepthConfig config;
+        double  latencyPeak;
+        double  safetyFactor;
+        int32_t quietCycles;
+        int32_t targetPoints;
+        int32_t closestMargin;
+    };
+}
+#endif
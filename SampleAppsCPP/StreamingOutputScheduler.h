@@ -0,0 +1,167 @@
+/*!
+*  @example    StreamingOutputScheduler.h
+
+*  @page       streaming-output-scheduler-cpp StreamingOutputScheduler.h
+
+*  @brief      Maps a list of point-synchronized output events onto streamed blocks and registers them in batches.
+
+*  @details
+SyncOutputWithMotion.cpp and SingleAxisSyncOutputs.cpp call StreamingOutputAdd(output, state, elementId) one output at a time.
+The element ID counts from 0 within each MovePT()/MovePVT() call, so when a path is streamed in blocks an event at
+trajectory point N belongs to whichever block ends up holding point N.
+
+StreamingOutputScheduler takes the whole list of (trajectory point index, IOPoint, state) events up front and sorts it once.
+Right before each block is sent, BlockOutputsAdd() registers the events that fall inside that block with their element IDs.
+Events on the same element and the same output address are merged into one StreamingOutputAdd(onMask, offMask, address, elementId) call,
+so a dense pattern on several bits of one output word costs one call per point instead of one per bit.
+No memory is allocated while streaming.
+
+StreamingSession (StreamingSession.h) calls BlockOutputsAdd() for you when given a scheduler with OutputSchedulerSet().
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include StreamingOutputScheduler.h
+
+*/
+#ifndef CPP_STREAMING_OUTPUT_SCHEDULER
+#define CPP_STREAMING_OUTPUT_SCHEDULER
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// Set or clear the output bits in mask at address when the motion reaches trajectory point pointIndex (counted from 0 across all blocks).
+    /// </summary>
+    struct StreamingOutputEvent
+    {
+        int64_t     pointIndex;
+        uint64_t    address;                        // IOPoint::AddressGet()
+        int32_t     mask;                           // IOPoint::MaskGet()
+        bool        state;
+    };
+
+    /// <summary>
+    /// Build an event from an IOPoint (or anything with AddressGet() and MaskGet()).
+    /// </summary>
+    template <class IOPointT>
+    StreamingOutputEvent StreamingOutputEventMake(int64_t pointIndex, IOPointT *output, bool state)
+    {
+        StreamingOutputEvent event;
+        event.pointIndex = pointIndex;
+        event.address = output->AddressGet();
+        event.mask = output->MaskGet();
+        event.state = state;
+        return event;
+    }
+
+    class StreamingOutputScheduler
+    {
+    public:
+        StreamingOutputScheduler() { Reset(); }
+
+        /// <summary>
+        /// Replace the event list.  Events may be in any order; events at the same point are applied in the order given.
+        /// </summary>
+        void EventsSet(const StreamingOutputEvent *newEvents, int64_t count)
+        {
+            events.assign(newEvents, newEvents + count);
+            std::stable_sort(events.begin(), events.end(), [](const StreamingOutputEvent& a, const StreamingOutputEvent& b)
+            {
+                return a.pointIndex < b.pointIndex || (a.pointIndex == b.pointIndex && a.address < b.address);
+            });
+            Reset();
+        }
+
+        /// <summary>
+        /// Start over from the first event, for example to stream the same path again.
+        /// </summary>
+        void Reset()
+        {
+            nextEvent = 0;
+            callsMade = 0;
+            eventsAdded = 0;
+            eventsMissed = 0;
+        }
+
+        /// <summary>
+        /// Register the events for the block about to be sent.  Call right before its MovePT()/MovePVT().
+        /// Returns the number of StreamingOutputAdd() calls made.
+        /// </summary>
+        /// <param name="motion">The MultiAxis or Axis the block is sent to.  Its streaming outputs must be enabled.</param>
+        /// <param name="firstPointIndex">Trajectory index of the first point in the block.</param>
+        /// <param name="pointCount">Points in the block.</param>
+        template <class MotionT>
+        int32_t BlockOutputsAdd(MotionT *motion, int64_t firstPointIndex, int32_t pointCount)
+        {
+            const int64_t end = firstPointIndex + pointCount;
+            const size_t eventCount = events.size();
+
+            // anything before this block was sent too late to be registered
+            while (nextEvent < eventCount && events[nextEvent].pointIndex < firstPointIndex)
+            {
+                ++eventsMissed;
+                ++nextEvent;
+            }
+
+            int32_t calls = 0;
+            while (nextEvent < eventCount && events[nextEvent].pointIndex < end)
+            {
+                // merge every event on this point and address into one pair of masks
+                const int64_t pointIndex = events[nextEvent].pointIndex;
+                const uint64_t address = events[nextEvent].address;
+                int32_t onMask = 0;
+                int32_t offMask = 0;
+                while (nextEvent < eventCount && events[nextEvent].pointIndex == pointIndex && events[nextEvent].address == address)
+                {
+                    const StreamingOutputEvent& event = events[nextEvent];
+                    if (event.state)
+                    {
+                        onMask |= event.mask;
+                        offMask &= ~event.mask;             // the later event on a bit wins
+                    }
+                    else
+                    {
+                        offMask |= event.mask;
+                        onMask &= ~event.mask;
+                    }
+                    ++eventsAdded;
+                    ++nextEvent;
+                }
+                motion->StreamingOutputAdd(onMask, offMask, address, (int32_t)(pointIndex - firstPointIndex));
+                ++calls;
+            }
+            callsMade += calls;
+            return calls;
+        }
+
+        int64_t EventCountGet() const { return (int64_t)events.size(); }
+        int64_t EventsPendingGet() const { return (int64_t)(events.size() - nextEvent); }
+        int64_t EventsAddedGet() const { return eventsAdded; }
+        int64_t CallsMadeGet() const { return callsMade; }
+
+        /// <summary>
+        /// Events skipped because their point had already been sent when they came up.
+        /// </summary>
+        int64_t EventsMissedGet() const { return eventsMissed; }
+
+    private:
+        std::vector<StreamingOutputEvent>   events;
+        size_t                              nextEvent;
+        int64_t                             callsMade;
+        int64_t                             eventsAdded;
+        int64_t                             eventsMissed;
+    };
+}
+#endif
@@ -0,0 +1,150 @@
+/*!
+*  @example    StreamingPointRing.h
+
+*  @page       streaming-point-ring-cpp StreamingPointRing.h
+
+*  @brief      Lock-free single-producer/single-consumer ring of streamed PT/PVT point blocks.
+
+*  @details
+UpdateBufferPoints.cpp generates its points on the same thread that waits in SyncInterruptWait() and calls MovePT().
+Any time spent generating points is time stolen from the sync cycle.
+
+This class lets a generator thread fill fixed-size point blocks ahead of time while the sync thread only dequeues a block
+and hands its arrays straight to MultiAxis::MovePT() or MultiAxis::MovePVT().
+Exactly one thread may produce and exactly one thread may consume.  No locks and no allocations happen after construction.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include StreamingPointRing.h
+
+*/
+#ifndef CPP_STREAMING_POINT_RING
+#define CPP_STREAMING_POINT_RING
+
+#include <atomic>
+#include <cstdint>
+
+namespace SampleAppsCPP
+{
+    const int CACHE_LINE_SIZE = 64;                         // Keep producer and consumer indexes on separate cache lines.
+
+    /// <summary>
+    /// A block of streamed points laid out the way MovePT()/MovePVT() expect them: positions and velocities are interleaved per axis (x0,y0,x1,y1...).
+    /// </summary>
+    /// <typeparam name="AXIS_COUNT">Number of axes in the MultiAxis.</typeparam>
+    /// <typeparam name="MAX_POINTS">Capacity of the block in points.  pointCount may be anything up to this.</typeparam>
+    template <int AXIS_COUNT, int MAX_POINTS>
+    struct PointBlock
+    {
+        static const int AXES = AXIS_COUNT;
+        static const int CAPACITY = MAX_POINTS;
+
+        int32_t pointCount;                                 // Number of valid points in this block.
+        int32_t firstPointIndex;                            // Index of the first point in the whole trajectory.
+        bool    isFinal;                                    // True for the last block of the motion (pass as the 'final' argument of MovePT).
+        double  positions[MAX_POINTS * AXIS_COUNT];
+        double  velocities[MAX_POINTS * AXIS_COUNT];        // Only used for PVT motion.
+        double  times[MAX_POINTS];
+    };
+
+    /// <summary>
+    /// Lock-free single-producer/single-consumer ring of point blocks.
+    /// </summary>
+    /// <typeparam name="BlockT">Block type, normally a PointBlock.</typeparam>
+    /// <typeparam name="BLOCK_COUNT">Number of blocks in the ring.  Must be a power of two.</typeparam>
+    /// @code
+    ///     // generator thread
+    ///     Block *block = ring->ProducerBlockGet();    // nullptr when the ring is full
+    ///     if (block != nullptr) { /* fill block */ ring->ProducerBlockCommit(); }
+    ///
+    ///     // sync thread
+    ///     Block *block = ring->ConsumerBlockGet();    // nullptr when the ring is empty
+    ///     if (block != nullptr) { multiAxis->MovePT(RSIMotionTypePT, block->positions, block->times, block->pointCount, EMPTY_CT, false, block->isFinal); ring->ConsumerBlockRelease(); }
+    /// @endcode
+    template <class BlockT, int BLOCK_COUNT>
+    class StreamingPointRing
+    {
+        static_assert(BLOCK_COUNT >= 2 && (BLOCK_COUNT & (BLOCK_COUNT - 1)) == 0, "BLOCK_COUNT must be a power of two.");
+
+    public:
+        StreamingPointRing() : head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+        /// <summary>
+        /// Producer only.  Returns the next free block to fill, or nullptr if the consumer has not released enough blocks yet.
+        /// </summary>
+        BlockT* ProducerBlockGet()
+        {
+            const uint32_t currentHead = head.load(std::memory_order_relaxed);
+            if (currentHead - cachedTail == BLOCK_COUNT)
+            {
+                cachedTail = tail.load(std::memory_order_acquire);      // only touch the consumer's cache line when we appear to be full
+                if (currentHead - cachedTail == BLOCK_COUNT)
+                {
+                    return nullptr;
+                }
+            }
+            return &blocks[currentHead & (BLOCK_COUNT - 1)];
+        }
+
+        /// <summary>
+        /// Producer only.  Publishes the block returned by ProducerBlockGet() to the consumer.
+        /// </summary>
+        void ProducerBlockCommit()
+        {
+            head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// <summary>
+        /// Consumer only.  Returns the oldest filled block, or nullptr if the producer has not committed one yet.
+        /// </summary>
+        BlockT* ConsumerBlockGet()
+        {
+            const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+            if (currentTail == cachedHead)
+            {
+                cachedHead = head.load(std::memory_order_acquire);      // only touch the producer's cache line when we appear to be empty
+                if (currentTail == cachedHead)
+                {
+                    return nullptr;
+                }
+            }
+            return &blocks[currentTail & (BLOCK_COUNT - 1)];
+        }
+
+        /// <summary>
+        /// Consumer only.  Hands the block returned by ConsumerBlockGet() back to the producer.
+        /// Call this after MovePT()/MovePVT() returns, because the library reads the arrays during the call.
+        /// </summary>
+        void ConsumerBlockRelease()
+        {
+            tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// <summary>
+        /// Number of committed blocks waiting for the consumer.  Safe to call from either thread, but only a snapshot.
+        /// </summary>
+        int CountGet() const
+        {
+            return (int)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+        }
+
+        static int CapacityGet() { return BLOCK_COUNT; }
+
+    private:
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head;    // written by the producer
+        uint32_t cachedTail;                                    // producer's last view of tail
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail;    // written by the consumer
+        uint32_t cachedHead;                                    // consumer's last view of head
+        alignas(CACHE_LINE_SIZE) BlockT blocks[BLOCK_COUNT];
+    };
+}
+#endif
@@ -0,0 +1,222 @@
+/*!
+@example    StreamingPointRingBenchmark.cpp
+
+*  @page       streaming-point-ring-benchmark-cpp StreamingPointRingBenchmark.cpp
+
+*  @brief      Benchmark of sync-thread time per cycle with and without the StreamingPointRing.
+
+*  @details
+Compares the two ways of feeding a streamed PT motion:
+
+Inline: the UpdateBufferPoints.cpp pattern.  The sync thread generates BUFFER_SZ points and then sends them.
+
+Ring:   the StreamingPointRingMotion.cpp pattern.  A generator thread fills blocks and the sync thread only dequeues and sends.
+
+The controller is not needed.  A std::chrono timer stands in for SyncInterruptWait() and a copy into a sink buffer stands in for MovePT().
+The sweep covers BUFFER_SZ and a synthetic per-point generator load, and prints the mean, p99 and max sync-thread busy time per cycle.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include StreamingPointRingBenchmark.cpp
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "StreamingPointRing.h"                     // Import the lock-free point ring.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int       AXIS_COUNT = 2;
+    const int       MAX_BUFFER_SZ = 500;
+    const int       RING_BLOCKS = 8;
+    const int       CYCLES = 200;                                       // sync cycles measured per configuration
+    const std::chrono::microseconds SYNC_PERIOD(1000);                  // 1ms, like SYNC_PERIOD = 1 at a 1kHz sample rate
+
+    typedef SampleAppsCPP::PointBlock<AXIS_COUNT, MAX_BUFFER_SZ> Block;
+    typedef SampleAppsCPP::StreamingPointRing<Block, RING_BLOCKS> Ring;
+
+    volatile double sinkChecksum = 0;                                   // keeps the compiler from optimizing the work away
+    double sink[MAX_BUFFER_SZ * AXIS_COUNT * 2];
+
+    // Generate one point.  'load' is the number of extra trigonometric iterations, standing in for a real planner.
+    inline void GeneratePoint(int pointIndex, int load, double *positions, double *time)
+    {
+        double value = pointIndex * 0.001;
+        for (int i = 0; i < load; i++)
+        {
+            value += std::sin(value) * 1e-9;
+        }
+        for (int axis = 0; axis < AXIS_COUNT; axis++)
+        {
+            positions[axis] = value + axis;
+        }
+        *time = 0.001;
+    }
+
+    // Stand-in for MultiAxis::MovePT().  The library copies the arrays during the call, so do the same.
+    inline void SendBlock(const double *positions, const double *times, int count)
+    {
+        memcpy(sink, positions, sizeof(double) * count * AXIS_COUNT);
+        memcpy(sink + MAX_BUFFER_SZ * AXIS_COUNT, times, sizeof(double) * count);
+        sinkChecksum = sinkChecksum + sink[0];
+    }
+
+    struct CycleStats
+    {
+        double meanUs;
+        double p99Us;
+        double maxUs;
+        int    underruns;
+    };
+
+    CycleStats Summarize(std::vector<double>& busyUs, int underruns)
+    {
+        CycleStats stats;
+        std::sort(busyUs.begin(), busyUs.end());
+        double sum = 0;
+        for (size_t i = 0; i < busyUs.size(); i++)
+        {
+            sum += busyUs[i];
+        }
+        stats.meanUs = sum / busyUs.size();
+        stats.p99Us = busyUs[(busyUs.size() * 99) / 100];
+        stats.maxUs = busyUs.back();
+        stats.underruns = underruns;
+        return stats;
+    }
+
+    CycleStats RunInline(int bufferSize, int load)
+    {
+        static double positions[MAX_BUFFER_SZ * AXIS_COUNT];
+        static double times[MAX_BUFFER_SZ];
+        std::vector<double> busyUs;
+        busyUs.reserve(CYCLES);
+
+        int nextPoint = 0;
+        Clock::time_point wake = Clock::now();
+        for (int cycle = 0; cycle < CYCLES; cycle++)
+        {
+            wake += SYNC_PERIOD;
+            std::this_thread::sleep_until(wake);                        // stands in for SyncInterruptWait()
+
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < bufferSize; i++)
+            {
+                GeneratePoint(nextPoint + i, load, &positions[i * AXIS_COUNT], &times[i]);
+            }
+            SendBlock(positions, times, bufferSize);
+            nextPoint += bufferSize;
+            busyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        return Summarize(busyUs, 0);
+    }
+
+    CycleStats RunRing(int bufferSize, int load)
+    {
+        static Ring ring;
+        std::vector<double> busyUs;
+        busyUs.reserve(CYCLES);
+        std::atomic<bool> done(false);
+
+        // drain anything left over from a previous configuration
+        while (ring.ConsumerBlockGet() != nullptr)
+        {
+            ring.ConsumerBlockRelease();
+        }
+
+        std::thread generator([&]()
+        {
+            int nextPoint = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                Block *block = ring.ProducerBlockGet();
+                if (block == nullptr)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (int i = 0; i < bufferSize; i++)
+                {
+                    GeneratePoint(nextPoint + i, load, &block->positions[i * AXIS_COUNT], &block->times[i]);
+                }
+                block->pointCount = bufferSize;
+                block->firstPointIndex = nextPoint;
+                block->isFinal = false;
+                ring.ProducerBlockCommit();
+                nextPoint += bufferSize;
+            }
+        });
+
+        // let the generator get ahead, the same way the sample queues blocks before releasing the hold gate
+        while (ring.CountGet() < 2)
+        {
+            std::this_thread::yield();
+        }
+
+        int underruns = 0;
+        Clock::time_point wake = Clock::now();
+        for (int cycle = 0; cycle < CYCLES; cycle++)
+        {
+            wake += SYNC_PERIOD;
+            std::this_thread::sleep_until(wake);                        // stands in for SyncInterruptWait()
+
+            Clock::time_point start = Clock::now();
+            Block *block = ring.ConsumerBlockGet();
+            if (block != nullptr)
+            {
+                SendBlock(block->positions, block->times, block->pointCount);
+                ring.ConsumerBlockRelease();
+            }
+            else
+            {
+                ++underruns;
+            }
+            busyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+
+        done = true;
+        generator.join();
+        return Summarize(busyUs, underruns);
+    }
+}
+
+void streamingPointRingBenchmarkMain()
+{
+    const int BUFFER_SIZES[] = { 10, 50, 100, 250, 500 };
+    const int LOADS[] = { 0, 10, 100 };                                 // extra sin() calls per point
+
+    printf("Sync-thread busy time per %lld us cycle, %d axes, %d cycles per row.\n", (long long)SYNC_PERIOD.count(), AXIS_COUNT, CYCLES);
+    printf("%9s %6s | %10s %10s %10s | %10s %10s %10s %9s\n",
+        "BUFFER_SZ", "load", "inline avg", "inline p99", "inline max", "ring avg", "ring p99", "ring max", "underruns");
+
+    for (size_t loadIndex = 0; loadIndex < sizeof(LOADS) / sizeof(LOADS[0]); loadIndex++)
+    {
+        for (size_t sizeIndex = 0; sizeIndex < sizeof(BUFFER_SIZES) / sizeof(BUFFER_SIZES[0]); sizeIndex++)
+        {
+            CycleStats inlineStats = RunInline(BUFFER_SIZES[sizeIndex], LOADS[loadIndex]);
+            CycleStats ringStats = RunRing(BUFFER_SIZES[sizeIndex], LOADS[loadIndex]);
+
+            printf("%9d %6d | %10.2f %10.2f %10.2f | %10.2f %10.2f %10.2f %9d\n",
+                BUFFER_SIZES[sizeIndex], LOADS[loadIndex],
+                inlineStats.meanUs, inlineStats.p99Us, inlineStats.maxUs,
+                ringStats.meanUs, ringStats.p99Us, ringStats.maxUs, ringStats.underruns);
+        }
+    }
+}
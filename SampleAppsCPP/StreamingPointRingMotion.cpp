@@ -0,0 +1,208 @@
+/*!
+@example    StreamingPointRingMotion.cpp
+
+*  @page       streaming-point-ring-motion-cpp StreamingPointRingMotion.cpp
+
+*  @brief      Streaming PT motion fed by a generator thread through a lock-free point ring.
+
+*  @details
+This is the UpdateBufferPoints.cpp motion, but the points are no longer generated on the sync thread.
+A generator thread fills fixed-size blocks in a StreamingPointRing ahead of time.
+The sync thread only waits for the interrupt, checks how many motion IDs are queued, dequeues a block and hands it to MovePT().
+
+If the generator ever falls behind, the sync thread counts a ring underrun and tries again next interrupt instead of blocking.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include StreamingPointRingMotion.cpp
+*/
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "StreamingPointRing.h"                     // Import the lock-free point ring.
+
+using namespace RSI::RapidCode;
+
+namespace
+{
+    const double    TIME_SLICE = 0.001;                                 // 0.001s = 1ms
+    const int       AXIS_COUNT = 1;                                     // number of axes
+
+    const int       REVS = 5;                                           // number of revolutions
+    const int       RPS = 1;                                            // revs / sec
+    const int       TOTAL_POINTS = (int)(REVS / TIME_SLICE / RPS);      // total number of points
+    const int       BUFFER_SZ = 100;                                    // Number of points to send in a buffer
+    const int       RING_BLOCKS = 8;                                    // Number of blocks the generator may run ahead (power of two)
+
+    typedef SampleAppsCPP::PointBlock<AXIS_COUNT, BUFFER_SZ> Block;
+    typedef SampleAppsCPP::StreamingPointRing<Block, RING_BLOCKS> Ring;
+
+    std::atomic<bool> stopGenerating(false);                            // lets the sync thread stop the generator early (errors)
+
+    // The generator thread.  Fills blocks until the whole trajectory has been produced.
+    void GeneratePoints(Ring *ring)
+    {
+        int nextPoint = 0;
+        while (nextPoint < TOTAL_POINTS && !stopGenerating.load())
+        {
+            Block *block = ring->ProducerBlockGet();
+            if (block == nullptr)
+            {
+                std::this_thread::yield();                              // ring is full, the sync thread has plenty queued
+                continue;
+            }
+
+            int count = (TOTAL_POINTS - nextPoint < BUFFER_SZ) ? (TOTAL_POINTS - nextPoint) : BUFFER_SZ;
+            for (int i = 0; i < count; i++)
+            {
+                for (int axis = 0; axis < AXIS_COUNT; axis++)
+                {
+                    block->positions[i * AXIS_COUNT + axis] = (nextPoint + i) * TIME_SLICE * RPS;
+                }
+                block->times[i] = TIME_SLICE;
+            }
+            block->pointCount = count;
+            block->firstPointIndex = nextPoint;
+            block->isFinal = (nextPoint + count >= TOTAL_POINTS);
+
+            ring->ProducerBlockCommit();
+            nextPoint += count;
+        }
+    }
+}
+
+void streamingPointRingMotionMain()
+{
+    const int       CPS = (int)std::pow(2, 20);                         // encoder counts per rev (set as appropiate)
+    const int       EMPTY_CT = 10;                                      // Number of points that remains in the buffer before an e-stop
+
+    static Ring ring;                                                   // large and cache-line aligned, so keep it off the stack
+    std::thread generator;
+
+    // Initizalize the controller from software w/ multiple axes
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    try
+    {
+        SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+
+        // add an additional axis for the multiaxis supervisor
+        controller->MotionCountSet(AXIS_COUNT + 1);
+
+        // create the multiaxis using the ID of the first free axis (0 indexed)
+        MultiAxis *multiAxis = controller->MultiAxisGet(AXIS_COUNT);
+        SampleAppsCPP::HelperFunctions::CheckErrors(multiAxis);
+
+        // populate the multiaxis
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            Axis *tempAxis = controller->AxisGet(i);
+            SampleAppsCPP::HelperFunctions::CheckErrors(tempAxis);
+
+            tempAxis->EStopAbort();
+            tempAxis->ClearFaults();
+            tempAxis->PositionSet(0);
+
+            tempAxis->UserUnitsSet(CPS);
+            multiAxis->AxisAdd(tempAxis);
+        }
+
+        // start generating points before motion starts so the first blocks are ready
+        stopGenerating = false;
+        generator = std::thread(GeneratePoints, &ring);
+
+        // prepare the controller (and drive)
+        multiAxis->Abort();
+        multiAxis->ClearFaults();
+        assert(multiAxis->StateGet() == RSIState::RSIStateIDLE);
+        multiAxis->AmpEnableSet(true);
+
+        // reset the motion ID to 0
+        double zeroPositions[AXIS_COUNT] = { 0 };
+        double zeroTime = TIME_SLICE;
+        multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, zeroPositions, &zeroTime, 1, -1, false, true);
+        multiAxis->MotionIdSet(0);
+
+        // Set up a motion hold gate so we can start buffering blocks
+        const int motionHoldGate = 3;
+        controller->MotionHoldGateSet(motionHoldGate, true);
+        multiAxis->MotionHoldGateSet(motionHoldGate);
+
+        int finalMotionID = 0;
+        int ringUnderruns = 0;
+        bool exitCondition = false;
+
+        // queue the first two blocks, waiting for the generator if it has not produced them yet
+        while (finalMotionID < 2 && !exitCondition)
+        {
+            Block *block = ring.ConsumerBlockGet();
+            if (block == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, block->positions, block->times, block->pointCount, EMPTY_CT, false, block->isFinal);
+            exitCondition = block->isFinal;
+            ring.ConsumerBlockRelease();
+            ++finalMotionID;
+        }
+
+        // Set up the interrupt frequency period
+        controller->SyncInterruptPeriodSet(10); // this generates an interrupt every x cycles of a 1KHz sample rate
+        controller->SyncInterruptEnableSet(true);
+
+        controller->MotionHoldGateSet(motionHoldGate, false); // release the hold gate to start moving
+
+        while (!exitCondition)
+        {
+            controller->SyncInterruptWait();
+            int curMotionID = multiAxis->MotionIdExecutingGet();
+
+            // the sync thread does no point generation: dequeue, send, release
+            if (std::abs(finalMotionID - curMotionID) < 2)
+            {
+                Block *block = ring.ConsumerBlockGet();
+                if (block == nullptr)
+                {
+                    ++ringUnderruns;                                    // generator fell behind, EMPTY_CT points of margin remain
+                    continue;
+                }
+                multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, block->positions, block->times, block->pointCount, EMPTY_CT, false, block->isFinal);
+                exitCondition = block->isFinal;
+                ring.ConsumerBlockRelease();
+                ++finalMotionID;
+            }
+        }
+        printf("Updates Done. Ring underruns: %d. Waiting to finish motion.\n", ringUnderruns);
+        multiAxis->MotionDoneWait();
+        printf("Motion Complete. Final Motion ID: %d\tFinal Element ID %d\n", multiAxis->MotionIdExecutingGet(), multiAxis->MotionElementIdExecutingGet());
+
+        controller->SyncInterruptEnableSet(false);
+        multiAxis->EStopAbort();
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+    stopGenerating = true;
+    if (generator.joinable())
+    {
+        generator.join();
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
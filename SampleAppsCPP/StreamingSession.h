@@ -0,0 +1,256 @@
+/*!
+*  @example    StreamingSession.h
+
+*  @page       streaming-session-cpp StreamingSession.h
+
+*  @brief      Per-MultiAxis streaming state and a scheduler that feeds many MultiAxis objects from one sync interrupt loop.
+
+*  @details
+StreamingMotionBufferManagement.cpp and UpdateBufferPoints.cpp keep their streaming state (lastSample, extraPointsSentToEvenOutBlock,
+finalMotionID) in globals, so only one MultiAxis can stream at a time.
+
+StreamingSession holds all of it for one MultiAxis: the TrajectorySource (TrajectorySource.h) it streams from, its own block buffers,
+and a StreamingBlockLedger (StreamingDepthController.h) that turns the executing motion and element IDs into queued points.
+
+StreamingScheduler services any number of sessions from a single SyncInterruptWait() loop.  Each cycle it reads the queue of every session,
+then refills the one with the fewest queued points first.  maxCallsPerCycle bounds the MovePT()/MovePVT() calls made in one cycle,
+so with many groups the cycle stays short and only the least urgent refills wait for the next cycle.
+
+Give a session a StreamingOutputScheduler (StreamingOutputScheduler.h) and it registers the output events of each block right before sending it.
+
+Sessions are templated on the MultiAxis type so the same code also drives SimulatedMultiAxis (MotionControllerStandIn.h).
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include StreamingSession.h
+
+*/
+#ifndef CPP_STREAMING_SESSION
+#define CPP_STREAMING_SESSION
+
+#include <cstdint>
+#include <vector>
+#include "StreamingDepthController.h"               // Import the streaming block ledger.
+#include "StreamingOutputScheduler.h"               // Import the point-synchronized output scheduler.
+#include "TrajectorySource.h"                       // Import the streaming trajectory source interface.
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// Streaming state for one MultiAxis.  MotionTypeT is the type of the MovePT() motion type argument (RSIMotionType with RapidCode).
+    /// </summary>
+    template <class MultiAxisT, class MotionTypeT>
+    class StreamingSession
+    {
+    public:
+        /// <param name="multiAxis">The MultiAxis to stream to.  Its axis count must match the source.</param>
+        /// <param name="ptMotionType">Motion type passed to MovePT() when the source has no velocities.</param>
+        /// <param name="source">Where the points come from.  Must outlive the session.</param>
+        /// <param name="targetQueuedPoints">Refill when fewer than this many points are queued.</param>
+        /// <param name="blockPoints">Points per MovePT()/MovePVT() call.</param>
+        /// <param name="emptyCount">EMPTY_CT passed to every call.</param>
+        StreamingSession(MultiAxisT *multiAxis, MotionTypeT ptMotionType, TrajectorySource& source, int32_t targetQueuedPoints, int32_t blockPoints, int32_t emptyCount)
+            : multiAxis(multiAxis), ptMotionType(ptMotionType), source(source), targetQueuedPoints(targetQueuedPoints), blockPoints(blockPoints), emptyCount(emptyCount),
+              positions((size_t)blockPoints * source.AxisCountGet()), velocities((size_t)blockPoints * source.AxisCountGet()), times(blockPoints), outputs(nullptr)
+        {
+            Reset();
+        }
+
+        /// <summary>
+        /// Prepare to stream.  Sets the MultiAxis motion ID so the ledger and the controller agree.
+        /// </summary>
+        void Start(int32_t firstMotionId = 0)
+        {
+            Reset();
+            multiAxis->MotionIdSet(firstMotionId);
+            ledger.Reset(firstMotionId);
+        }
+
+        /// <summary>
+        /// Register output events with each block as it is sent.  The MultiAxis streaming outputs must be enabled.  nullptr for none.
+        /// </summary>
+        void OutputSchedulerSet(StreamingOutputScheduler *scheduler) { outputs = scheduler; }
+
+        /// <summary>
+        /// Read the executing motion and element IDs and update the queued point count.  Call once per cycle before Service().
+        /// </summary>
+        void Poll()
+        {
+            if (!started)
+            {
+                return;
+            }
+            queuedPoints = ledger.QueuedPointsGet(multiAxis->MotionIdExecutingGet(), multiAxis->MotionElementIdExecutingGet());
+            if (!finalSent && queuedPoints < minQueuedPoints)
+            {
+                minQueuedPoints = queuedPoints;
+            }
+        }
+
+        /// <summary>
+        /// Send blocks until targetQueuedPoints are queued, the source is finished, or maxCalls calls were made.  Returns the calls made.
+        /// </summary>
+        int32_t Service(int32_t maxCalls)
+        {
+            int32_t calls = 0;
+            while (!finalSent && queuedPoints < targetQueuedPoints && calls < maxCalls)
+            {
+                const int32_t count = source.PointsNext(&positions[0], &velocities[0], &times[0], blockPoints);
+                if (count == 0)
+                {
+                    break;                                  // the source has nothing ready this cycle
+                }
+                finalSent = source.IsDoneGet();
+                if (outputs != nullptr)
+                {
+                    outputs->BlockOutputsAdd(multiAxis, ledger.PointsSentGet(), count);
+                }
+                if (source.HasVelocitiesGet())
+                    multiAxis->MovePVT(&positions[0], &velocities[0], &times[0], count, emptyCount, false, finalSent);
+                else
+                    multiAxis->MovePT(ptMotionType, &positions[0], &times[0], count, emptyCount, false, finalSent);
+                ledger.BlockSent(count);
+                queuedPoints += count;
+                started = true;
+                ++calls;
+            }
+            return calls;
+        }
+
+        MultiAxisT* MultiAxisGet() const { return multiAxis; }
+        int64_t QueuedPointsGet() const { return queuedPoints; }
+        int64_t PointsSentGet() const { return ledger.PointsSentGet(); }
+        bool    IsFinalSentGet() const { return finalSent; }
+        bool    IsRefillNeededGet() const { return !finalSent && queuedPoints < targetQueuedPoints; }
+
+        /// <summary>
+        /// Fewest points seen queued before the final block was sent.  Close to EMPTY_CT means the group nearly starved.
+        /// </summary>
+        int64_t MinQueuedPointsGet() const { return minQueuedPoints; }
+
+    private:
+        void Reset()
+        {
+            queuedPoints = 0;
+            minQueuedPoints = INT64_MAX;
+            finalSent = false;
+            started = false;
+        }
+
+        MultiAxisT              *multiAxis;
+        MotionTypeT             ptMotionType;
+        TrajectorySource&       source;
+        int32_t                 targetQueuedPoints;
+        int32_t                 blockPoints;
+        int32_t                 emptyCount;
+        std::vector<double>     positions;
+        std::vector<double>     velocities;
+        std::vector<double>     times;
+        StreamingBlockLedger    ledger;
+        StreamingOutputScheduler *outputs;
+        int64_t                 queuedPoints;
+        int64_t                 minQueuedPoints;
+        bool                    finalSent;
+        bool                    started;
+    };
+
+    /// <summary>
+    /// Services up to MAX_SESSIONS StreamingSession objects from one thread, most urgent first.
+    /// </summary>
+    template <class SessionT, int MAX_SESSIONS>
+    class StreamingScheduler
+    {
+    public:
+        StreamingScheduler() : sessionCount(0), cycles(0), deferredRefills(0) {}
+
+        /// <summary>
+        /// Add a session.  Returns false if MAX_SESSIONS are already added.
+        /// </summary>
+        bool SessionAdd(SessionT *session)
+        {
+            if (sessionCount >= MAX_SESSIONS)
+            {
+                return false;
+            }
+            sessions[sessionCount++] = session;
+            return true;
+        }
+
+        /// <summary>
+        /// Call once per sync interrupt.  Polls every session, then refills them in order of fewest queued points,
+        /// making at most maxCallsPerCycle streaming calls in total.  Returns the number of sessions still streaming.
+        /// </summary>
+        int32_t Service(int32_t maxCallsPerCycle)
+        {
+            ++cycles;
+            int32_t refillCount = 0;
+            for (int32_t i = 0; i < sessionCount; i++)
+            {
+                sessions[i]->Poll();
+                if (sessions[i]->IsRefillNeededGet())
+                {
+                    InsertByUrgency(refillCount++, sessions[i]);
+                }
+            }
+
+            int32_t callsLeft = maxCallsPerCycle;
+            for (int32_t i = 0; i < refillCount; i++)
+            {
+                if (callsLeft <= 0)
+                {
+                    deferredRefills += refillCount - i;     // these sessions wait for the next cycle
+                    break;
+                }
+                callsLeft -= order[i]->Service(callsLeft);
+            }
+
+            int32_t streaming = 0;
+            for (int32_t i = 0; i < sessionCount; i++)
+            {
+                if (!sessions[i]->IsFinalSentGet())
+                {
+                    ++streaming;
+                }
+            }
+            return streaming;
+        }
+
+        int32_t SessionCountGet() const { return sessionCount; }
+        SessionT* SessionGet(int32_t index) const { return sessions[index]; }
+        int64_t CycleCountGet() const { return cycles; }
+
+        /// <summary>
+        /// Refills that had to wait a cycle because the per-cycle call budget ran out.
+        /// </summary>
+        int64_t DeferredRefillCountGet() const { return deferredRefills; }
+
+    private:
+        // Insertion sort into order[0..count], fewest queued points first.  The session count is small, so this beats a heap.
+        void InsertByUrgency(int32_t count, SessionT *session)
+        {
+            int32_t i = count;
+            while (i > 0 && order[i - 1]->QueuedPointsGet() > session->QueuedPointsGet())
+            {
+                order[i] = order[i - 1];
+                --i;
+            }
+            order[i] = session;
+        }
+
+        SessionT    *sessions[MAX_SESSIONS];
+        SessionT    *order[MAX_SESSIONS];
+        int32_t     sessionCount;
+        int64_t     cycles;
+        int64_t     deferredRefills;
+    };
+}
+#endif
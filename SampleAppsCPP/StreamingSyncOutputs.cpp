@@ -0,0 +1,121 @@
+/*!
+@example    StreamingSyncOutputs.cpp
+
+*  @page       streaming-sync-outputs-cpp StreamingSyncOutputs.cpp
+
+*  @brief      Thousands of position-synchronized output events on a path streamed in blocks.
+
+*  @details
+A dispense pattern is laid out on trajectory point indexes before motion starts: a valve output turns on every PULSE_PERIOD points
+and off PULSE_WIDTH points later.  A second output on the same drive follows it: it opens on the point the valve closes and closes on the
+point the next pulse opens the valve, so the two outputs switch together on every event point after the first.
+StreamingOutputScheduler (StreamingOutputScheduler.h) maps each event onto the block and element ID that holds its point
+as StreamingSession (StreamingSession.h) streams the path, and merges the two outputs into one call wherever they switch on the same point:
+the four events of each pulse go out in about two StreamingOutputAdd() calls.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include StreamingSyncOutputs.cpp
+*/
+
+#include <vector>
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "StreamingSession.h"                       // Import the streaming session and output scheduler.
+
+using namespace RSI::RapidCode;
+
+void streamingSyncOutputsMain()
+{
+    const int       AXIS_COUNT = (1);
+    const long      POINTS = (20000);                                   // 20 seconds of motion
+    const double    TIME_SLICE = (0.001);                               // one point per 1kHz sample
+    const double    RPS = (0.5);                                        // revs / sec
+    const int       USER_UNITS = 1048576;                               // encoder counts per rev (set as appropiate)
+    const int       BUFFER_SZ = (100);                                  // points per MovePT() call
+    const int       TARGET_QUEUED = (3 * BUFFER_SZ);
+    const int       EMPTY_CT = (10);                                    // Number of points that remains in the buffer before an e-stop
+    const int       PULSE_PERIOD = (10);                                // points between dispense pulses
+    const int       PULSE_WIDTH = (5);                                  // points the valve stays open
+    const int       FOLLOWER_DELAY = (PULSE_WIDTH);                     // points the second output trails the first by (switches with it)
+
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    try
+    {
+        SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+        controller->MotionCountSet(controller->AxisCountGet() + 1);     // add a motion supervisor for the MultiAxis
+
+        MultiAxis *multiAxis = controller->MultiAxisGet(controller->AxisCountGet());
+        SampleAppsCPP::HelperFunctions::CheckErrors(multiAxis);
+        Axis *axis = controller->AxisGet(0);
+        SampleAppsCPP::HelperFunctions::CheckErrors(axis);
+        axis->PositionSet(0);
+        axis->UserUnitsSet(USER_UNITS);
+        multiAxis->AxisAdd(axis);
+
+        multiAxis->Abort();
+        multiAxis->ClearFaults();
+        multiAxis->AmpEnableSet(true);
+
+        IOPoint *valve = IOPoint::CreateDigitalOutput(axis, RSIMotorGeneralIo0);
+        IOPoint *follower = IOPoint::CreateDigitalOutput(axis, RSIMotorGeneralIo1);
+        valve->Set(false);
+        follower->Set(false);
+
+        // lay out the whole pattern on trajectory point indexes
+        std::vector<SampleAppsCPP::StreamingOutputEvent> events;
+        for (long point = PULSE_PERIOD; point + PULSE_WIDTH + FOLLOWER_DELAY < POINTS; point += PULSE_PERIOD)
+        {
+            events.push_back(SampleAppsCPP::StreamingOutputEventMake(point, valve, true));
+            events.push_back(SampleAppsCPP::StreamingOutputEventMake(point + PULSE_WIDTH, valve, false));
+            events.push_back(SampleAppsCPP::StreamingOutputEventMake(point + FOLLOWER_DELAY, follower, true));
+            events.push_back(SampleAppsCPP::StreamingOutputEventMake(point + FOLLOWER_DELAY + PULSE_WIDTH, follower, false));
+        }
+        SampleAppsCPP::StreamingOutputScheduler outputs;
+        outputs.EventsSet(&events[0], (int64_t)events.size());
+
+        SampleAppsCPP::ConstantVelocitySource source(AXIS_COUNT, POINTS, TIME_SLICE, RPS);
+        SampleAppsCPP::StreamingSession<MultiAxis, RSIMotionType> session(multiAxis, RSIMotionType::RSIMotionTypePT, source, TARGET_QUEUED, BUFFER_SZ, EMPTY_CT);
+        session.OutputSchedulerSet(&outputs);
+
+        multiAxis->StreamingOutputsEnableSet(true);
+        session.Start();
+        session.Service(TARGET_QUEUED / BUFFER_SZ);                     // queue the first blocks and their outputs
+
+        controller->SyncInterruptPeriodSet(10); // this generates an interrupt every x cycles of a 1KHz sample rate
+        controller->SyncInterruptEnableSet(true);
+        while (!session.IsFinalSentGet())
+        {
+            controller->SyncInterruptWait();
+            session.Poll();
+            session.Service(2);
+        }
+        controller->SyncInterruptEnableSet(false);
+
+        printf("Updates Done. Waiting to finish motion.\n");
+        multiAxis->MotionDoneWait();
+        printf("%lld output events registered with %lld StreamingOutputAdd() calls, %lld missed.\n",
+            (long long)outputs.EventsAddedGet(), (long long)outputs.CallsMadeGet(), (long long)outputs.EventsMissedGet());
+
+        multiAxis->StreamingOutputsClear();                             // cleanup for next run
+        multiAxis->StreamingOutputsEnableSet(false);
+        multiAxis->AmpEnableSet(false);
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
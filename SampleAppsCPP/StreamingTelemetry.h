@@ -0,0 +1,260 @@
+/*!
+*  @example    StreamingTelemetry.h
+
+*  @page       streaming-telemetry-cpp StreamingTelemetry.h
+
+*  @brief      Underrun-margin telemetry for streaming PT/PVT motion.
+
+*  @details
+The EMPTY_CT argument of MovePT() e-stops the motion when the queue drains, but it does not tell you how close you came.
+Record() is called once per sync interrupt with the number of queued points (StreamingBlockLedger in StreamingDepthController.h computes it)
+and keeps fixed-size histograms of:
+
+- the margin: queued points left above EMPTY_CT,
+- the time since the last MovePT()/MovePVT() call,
+- the points the controller consumed during the cycle.
+
+When the margin drops to alarmMargin or below, Record() returns true and the event is counted and remembered.
+Print() summarizes the histograms and suggests a buffer size based on the measured data.
+No memory is allocated after construction.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include StreamingTelemetry.h
+
+*/
+#ifndef CPP_STREAMING_TELEMETRY
+#define CPP_STREAMING_TELEMETRY
+
+#include <cstdint>
+#include <cstdio>
+
+namespace SampleAppsCPP
+{
+    class StreamingTelemetry
+    {
+    public:
+        static const int MARGIN_BUCKETS = 64;               // linear buckets of marginBucketWidth points; the last bucket collects everything above
+        static const int INTERVAL_BUCKETS = 32;             // power-of-two microsecond buckets for time since the last send
+
+        /// <param name="emptyCount">EMPTY_CT passed to MovePT().</param>
+        /// <param name="alarmMargin">Raise an alarm when queued points minus emptyCount is at or below this.</param>
+        /// <param name="marginBucketWidth">Points per margin histogram bucket.</param>
+        /// <param name="hostTicksPerMicrosecond">PerformanceTimerFrequencyGet() / 1e6.</param>
+        StreamingTelemetry(int32_t emptyCount, int32_t alarmMargin, int32_t marginBucketWidth, double hostTicksPerMicrosecond)
+            : emptyCount(emptyCount), alarmMargin(alarmMargin), marginBucketWidth(marginBucketWidth > 0 ? marginBucketWidth : 1),
+              ticksPerMicrosecond(hostTicksPerMicrosecond)
+        {
+            Reset();
+        }
+
+        void Reset()
+        {
+            for (int i = 0; i < MARGIN_BUCKETS; i++) marginHistogram[i] = 0;
+            for (int i = 0; i < INTERVAL_BUCKETS; i++) intervalHistogram[i] = 0;
+            cycles = 0;
+            alarms = 0;
+            minMargin = INT64_MAX;
+            minMarginSample = 0;
+            lastAlarmSample = 0;
+            lastAlarmMargin = 0;
+            maxIntervalUs = 0;
+            maxConsumedPerCycle = 0;
+            maxConsumedBetweenSends = 0;
+            consumedSinceSend = 0;
+            lastSendTicks = 0;
+            hasSent = false;
+            hasPrevious = false;
+            previousExecuted = 0;
+            lastMotionId = 0;
+            lastElementId = 0;
+        }
+
+        /// <summary>
+        /// Call right after each MovePT()/MovePVT().
+        /// </summary>
+        /// <param name="hostTicks">HostTickCounter::Read(), like Record().</param>
+        void BlockSent(uint64_t hostTicks)
+        {
+            lastSendTicks = hostTicks;
+            hasSent = true;
+            if (consumedSinceSend > maxConsumedBetweenSends)
+            {
+                maxConsumedBetweenSends = consumedSinceSend;
+            }
+            consumedSinceSend = 0;
+        }
+
+        /// <summary>
+        /// Call once per sync interrupt.  Returns true if the margin is at or below the alarm level.
+        /// </summary>
+        /// <param name="sample">Sample counter returned by SyncInterruptWait().</param>
+        /// <param name="motionId">MotionIdExecutingGet().</param>
+        /// <param name="elementId">MotionElementIdExecutingGet().</param>
+        /// <param name="pointsExecuted">Total points consumed so far (StreamingBlockLedger::PointsExecutedGet()).</param>
+        /// <param name="queuedPoints">Points still queued (StreamingBlockLedger::QueuedPointsGet()).</param>
+        /// <param name="hostTicks">HostTickCounter::Read() (StreamingDepthController.h), not the raw 32-bit PerformanceTimerCountGet().</param>
+        bool Record(int32_t sample, int32_t motionId, int32_t elementId, int64_t pointsExecuted, int64_t queuedPoints, uint64_t hostTicks)
+        {
+            ++cycles;
+            lastMotionId = motionId;
+            lastElementId = elementId;
+
+            // margin above the e-stop level
+            const int64_t margin = queuedPoints - emptyCount;
+            int64_t bucket = margin <= 0 ? 0 : margin / marginBucketWidth;
+            marginHistogram[bucket >= MARGIN_BUCKETS ? MARGIN_BUCKETS - 1 : bucket]++;
+            if (margin < minMargin)
+            {
+                minMargin = margin;
+                minMarginSample = sample;
+            }
+
+            // time since the last send
+            if (hasSent)
+            {
+                const double intervalUs = (double)(hostTicks - lastSendTicks) / ticksPerMicrosecond;
+                intervalHistogram[Log2Bucket(intervalUs)]++;
+                if (intervalUs > maxIntervalUs)
+                {
+                    maxIntervalUs = intervalUs;
+                }
+            }
+
+            // controller progress during this cycle
+            if (hasPrevious)
+            {
+                const int64_t consumed = pointsExecuted - previousExecuted;
+                consumedSinceSend += consumed;
+                if (consumed > maxConsumedPerCycle)
+                {
+                    maxConsumedPerCycle = consumed;
+                }
+            }
+            previousExecuted = pointsExecuted;
+            hasPrevious = true;
+
+            if (margin <= alarmMargin)
+            {
+                ++alarms;
+                lastAlarmSample = sample;
+                lastAlarmMargin = margin;
+                return true;
+            }
+            return false;
+        }
+
+        int64_t MinMarginGet() const { return minMargin; }
+        int64_t AlarmCountGet() const { return alarms; }
+        int64_t CycleCountGet() const { return cycles; }
+
+        /// <summary>
+        /// Smallest number of queued points that would have kept the worst recorded stretch above EMPTY_CT plus alarmMargin.
+        /// </summary>
+        int64_t SuggestedQueuedPointsGet() const
+        {
+            return emptyCount + alarmMargin + (maxConsumedBetweenSends > maxConsumedPerCycle ? maxConsumedBetweenSends : maxConsumedPerCycle);
+        }
+
+        /// <summary>
+        /// Print a summary.  Not real-time safe: call it after the streaming loop.
+        /// </summary>
+        void Print(FILE *out) const
+        {
+            fprintf(out, "Streaming telemetry: %lld cycles, %lld alarms (margin <= %d points)\n", (long long)cycles, (long long)alarms, alarmMargin);
+            if (cycles == 0)
+            {
+                return;
+            }
+            fprintf(out, "  min margin %lld points at sample %d", (long long)minMargin, minMarginSample);
+            if (alarms > 0)
+            {
+                fprintf(out, ", last alarm at sample %d with margin %lld", lastAlarmSample, (long long)lastAlarmMargin);
+            }
+            fprintf(out, "\n  last executing motion ID %d element %d", lastMotionId, lastElementId);
+            fprintf(out, "\n  max %.1lf us between sends, max %lld points consumed per cycle, max %lld between sends\n",
+                maxIntervalUs, (long long)maxConsumedPerCycle, (long long)maxConsumedBetweenSends);
+            fprintf(out, "  margin p1 %lld, p50 %lld points; suggested queued points: %lld\n",
+                (long long)MarginPercentile(0.01), (long long)MarginPercentile(0.50), (long long)SuggestedQueuedPointsGet());
+
+            fprintf(out, "  margin histogram (points above EMPTY_CT):\n");
+            for (int i = 0; i < MARGIN_BUCKETS; i++)
+            {
+                if (marginHistogram[i] == 0) continue;
+                if (i == MARGIN_BUCKETS - 1)
+                    fprintf(out, "    >= %6d : %lld\n", i * marginBucketWidth, (long long)marginHistogram[i]);
+                else
+                    fprintf(out, "    %6d-%-6d : %lld\n", i * marginBucketWidth, (i + 1) * marginBucketWidth - 1, (long long)marginHistogram[i]);
+            }
+            fprintf(out, "  time since last send histogram:\n");
+            for (int i = 0; i < INTERVAL_BUCKETS; i++)
+            {
+                if (intervalHistogram[i] == 0) continue;
+                fprintf(out, "    < %10llu us : %lld\n", 1ULL << i, (long long)intervalHistogram[i]);
+            }
+        }
+
+    private:
+        static int Log2Bucket(double microseconds)
+        {
+            int bucket = 0;
+            uint64_t value = microseconds < 1.0 ? 0 : (uint64_t)microseconds;
+            while (value > 0 && bucket < INTERVAL_BUCKETS - 1)
+            {
+                value >>= 1;
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        // Lower edge of the margin bucket holding the given fraction of cycles.
+        int64_t MarginPercentile(double fraction) const
+        {
+            const int64_t target = (int64_t)(fraction * cycles);
+            int64_t seen = 0;
+            for (int i = 0; i < MARGIN_BUCKETS; i++)
+            {
+                seen += marginHistogram[i];
+                if (seen > target)
+                {
+                    return (int64_t)i * marginBucketWidth;
+                }
+            }
+            return (int64_t)(MARGIN_BUCKETS - 1) * marginBucketWidth;
+        }
+
+        int32_t  emptyCount;
+        int32_t  alarmMargin;
+        int32_t  marginBucketWidth;
+        double   ticksPerMicrosecond;
+
+        int64_t  marginHistogram[MARGIN_BUCKETS];
+        int64_t  intervalHistogram[INTERVAL_BUCKETS];
+        int64_t  cycles;
+        int64_t  alarms;
+        int64_t  minMargin;
+        int32_t  minMarginSample;
+        int32_t  lastAlarmSample;
+        int64_t  lastAlarmMargin;
+        double   maxIntervalUs;
+        int64_t  maxConsumedPerCycle;
+        int64_t  maxConsumedBetweenSends;
+        int64_t  consumedSinceSend;
+        uint64_t lastSendTicks;
+        bool     hasSent;
+        bool     hasPrevious;
+        int64_t  previousExecuted;
+        int32_t  lastMotionId;
+        int32_t  lastElementId;
+    };
+}
+#endif
@@ -23,26 +23,145 @@ Robotic Systems Integration.
 *  @include syncInterrupt.cpp
 */
 
-#include <windows.h>    // this is only needed if you try to set the windows thread priority#include "rsi.h"                                    // Import our RapidCode Library. 
+#include "rsi.h"                                    // Import our RapidCode Library. 
 #include "HelperFunctions.h"                        // Import our SampleApp helper functions. 
+#include "CyclicExecutor.h"                         // Import the real-time thread setup and self-check.
+#include "CycleLog.h"                               // Import the asynchronous cycle log.
+#include "CycleIO.h"                                // Import the bulk cycle I/O layer.
+#include "CycleRecorder.h"                          // Import the cycle record/replay.
+#include "HostControlLaw.h"                         // Import the SIMD host control law.
+#include "LatencyHistogram.h"                       // Import the latency histogram.
+#include "MissedSampleMonitor.h"                    // Import the missed sync interrupt detection.
+#include "StreamingDepthController.h"               // Import the wake-up latency estimator.
 using namespace RSI::RapidCode;
 
 //configurable
 const int SYNC_PERIOD = (1);        // interrupt every SynqNet/MotionController sample
 const int AXIS_COUNT = (6);  // how many axes will we process each sample
+const int RT_CPU = (-1);            // CPU to pin the sync thread to, ideally one listed in isolcpus= (-1 for any)
+const int SELF_CHECK_CYCLES = (1000);   // sync interrupts measured by the startup self-check
+const char *RECORD_PATH = nullptr;      // for example "syncInterrupt.cycles": record every cycle's inputs and outputs, saved after the loop
+const char *REPLAY_PATH = nullptr;      // for example "syncInterrupt.cycles": run a recording through CycleCompute() instead of the controller
+const int RECORD_MAX_CYCLES = (60000);  // cycles kept by the recorder, about 150 bytes each
 
 //constants
 const double MS_PER_SECOND = (1000.0);
+const double NS_PER_MS = (1000000.0);
+
+// full distributions, not just min/max (kept off the stack, they are 66 KB each)
+static SampleAppsCPP::LatencyHistogram periodHistogram;        // interrupt-to-interrupt period, ns
+static SampleAppsCPP::LatencyHistogram wakeLatencyHistogram;   // host wake-up after the earliest possible wake-up, ns
+
+// printf() can block for milliseconds, so the loop only queues records and a background thread writes them
+static SampleAppsCPP::CycleLog<4096> cycleLog;
+
+
+typedef SampleAppsCPP::HostControlLaw<AXIS_COUNT> ControlLaw;
+
+// everything CycleCompute() reads in one cycle, so a recording can replay it
+struct SyncCycleInputs
+{
+    double actualPositions[AXIS_COUNT];         // primary encoder positions, in counts
+    double commandPositions[AXIS_COUNT];
+};
+
+
+// set your gains, filters and limits here -- with output limits of 0 the torque outputs stay at 0
+void ControlLawConfigure(ControlLaw& controlLaw)
+{
+    for (int i = 0; i < AXIS_COUNT; i++)
+    {
+        controlLaw.GainsSet(i, 0.0, 0.0, 0.0, 0.0, 0.0);        // KP, KI, KD, velocity and acceleration feed-forward
+        controlLaw.FiltersSet(i, 0.0, 0.0);                     // derivative and output low-pass cutoffs in Hz (0 = off)
+        controlLaw.LimitsSet(i, 0.0, 0.0);                      // integral and output limits
+    }
+}
+
+
+// the calculations of one cycle, shared by the live loop and the replay
+void CycleCompute(ControlLaw& controlLaw, const SyncCycleInputs& inputs, double *torqueOutputs)
+{
+    for (int i = 0; i < AXIS_COUNT; i++)
+    {
+        controlLaw.ActualPositionsGet()[i] = inputs.actualPositions[i];
+        controlLaw.CommandPositionsGet()[i] = inputs.commandPositions[i];
+    }
+    controlLaw.Update();
+    for (int i = 0; i < AXIS_COUNT; i++)
+    {
+        torqueOutputs[i] = controlLaw.OutputsGet()[i];
+    }
+}
+
+
+// Run a recording through CycleCompute() as fast as possible and compare the torques with the recorded ones.  Needs no controller.
+void SyncInterruptReplay(const char *path)
+{
+    SampleAppsCPP::CycleReplay replay;
+    if (!replay.Load(path))
+    {
+        printf("%s: %s\n", path, replay.ErrorGet());
+        return;
+    }
+    ControlLaw controlLaw(AXIS_COUNT, replay.SyncPeriodGet() / replay.SampleRateGet());
+    ControlLawConfigure(controlLaw);
+    SampleAppsCPP::MissedSampleMonitor missedSamples(replay.SyncPeriodGet());
+    missedSamples.HandlerAdd(ControlLaw::MissedSamplesHandle, &controlLaw);
+
+    SampleAppsCPP::CycleReplayResult result = replay.Run<SyncCycleInputs, double>([&](int32 sample, const SyncCycleInputs& inputs, double *torqueOutputs)
+    {
+        missedSamples.Update(sample, (uint32)sample);                   // sample counter as the timer, so event times are in recorded time
+        CycleCompute(controlLaw, inputs, torqueOutputs);
+    }, 0.0);
+    replay.Print(stdout, result);
+    missedSamples.Print(stdout, replay.SampleRateGet());
+}
+
+
+// Controller address of the gain table 0 OUTPUT_OFFSET coefficient that FilterCoeffSet() writes, or 0 if it cannot be proven.
+// The PID coefficients are doubles following KP in RSIFilterGainPIDCoeff order.  Comparing the guess with FilterCoeffGet() proves nothing
+// while both are 0, so write a nonzero probe through each path and read it back through the other, then restore the original.
+// The probes are far below one DAC count, so the brief offset does not move the axis.
+uint64 OutputOffsetAddressGet(MotionController *controller, Axis *axis)
+{
+    const double PROBE_FILTER = 1.0e-200;
+    const double PROBE_MEMORY = -2.0e-200;
+    const uint64 address = axis->AddressGet(RSIAxisAddressTypeFILTER_GAIN_KP) + RSIFilterGainPIDCoeffOUTPUT_OFFSET * sizeof(double);
+    const double original = axis->FilterCoeffGet(RSIFilterGainPIDCoeffOUTPUT_OFFSET, 0);
+
+    axis->FilterCoeffSet(RSIFilterGainPIDCoeffOUTPUT_OFFSET, 0, PROBE_FILTER);
+    bool verified = controller->MemoryDoubleGet(address) == PROBE_FILTER;
+    if (verified)
+    {
+        controller->MemoryDoubleSet(address, PROBE_MEMORY);
+        verified = axis->FilterCoeffGet(RSIFilterGainPIDCoeffOUTPUT_OFFSET, 0) == PROBE_MEMORY;
+    }
+    axis->FilterCoeffSet(RSIFilterGainPIDCoeffOUTPUT_OFFSET, 0, original);
+    return verified ? address : 0;
+}
+
+
+// Bytes between the same field of two neighbouring axes, or 0 (no read gap) if it is not a positive int32.
+int32 AxisStrideGet(Axis **axes, int32 axisCount, RSIAxisAddressType addressType)
+{
+    if (axisCount < 2)
+    {
+        return 0;
+    }
+    const uint64 first = axes[0]->AddressGet(addressType);
+    const uint64 second = axes[1]->AddressGet(addressType);
+    return second > first && second - first <= (uint64)INT32_MAX ? (int32)(second - first) : 0;
+}
 
 
 void syncInterruptMain()
 {
 
     Axis            *axes[AXIS_COUNT];
-    double            encoderPositions[AXIS_COUNT];
-    short            torqueOutputs[AXIS_COUNT] = { 0, 0, 0, 0, 0, 0 };
-    long            currentCounter = 0;
-    long            previousCounter = 0;
+    SyncCycleInputs    cycleInputs;
+    double            torqueOutputs[AXIS_COUNT] = { 0, 0, 0, 0, 0, 0 };
+    uint64_t        currentCounter = 0;
+    uint64_t        previousCounter = 0;
     long            deltaSamples = 0;
     long            iterations = 0;
     unsigned long    cpuFreq = 0;
@@ -52,6 +171,13 @@ void syncInterruptMain()
 
     long i = 0;
     long errorCount = 0;
+
+    if (REPLAY_PATH != nullptr)
+    {
+        SyncInterruptReplay(REPLAY_PATH);
+        return;
+    }
+
     // create and Initialize MotionController class. (PCI board)
     MotionController *controller = MotionController::CreateFromSoftware();
     SampleAppsCPP::HelperFunctions::CheckErrors(controller);
@@ -67,6 +193,44 @@ void syncInterruptMain()
             SampleAppsCPP::HelperFunctions::CheckErrors(axes[i]);
         }
 
+        // resolve every address once, so each cycle is one bulk read of all axis feedback (axis fields sit one axis apart,
+        // so a read gap of one axis stride merges them into one transfer).  The torque outputs are not contiguous, so
+        // Commit() still writes them with one MemoryBlockSet() per axis, but without the per-axis FilterCoeffSet() calls.
+        SampleAppsCPP::CycleIO cycleIO(AxisStrideGet(axes, AXIS_COUNT, RSIAxisAddressTypeENCODER_PRIMARY));
+        int positionChannels[AXIS_COUNT];
+        int torqueChannels[AXIS_COUNT];
+        uint64 outputOffsetAddresses[AXIS_COUNT];
+        bool torqueBulk = true;
+        for (i = 0; i < AXIS_COUNT; i++)
+        {
+            positionChannels[i] = cycleIO.ReadAdd(axes[i]->AddressGet(RSIAxisAddressTypeENCODER_PRIMARY), sizeof(int32));   // what EncoderPositionGet(RSIMotorFeedbackPRIMARY) reads
+            outputOffsetAddresses[i] = OutputOffsetAddressGet(controller, axes[i]);
+            torqueBulk = torqueBulk && outputOffsetAddresses[i] != 0;
+        }
+        for (i = 0; torqueBulk && i < AXIS_COUNT; i++)
+        {
+            torqueChannels[i] = cycleIO.WriteAdd(outputOffsetAddresses[i], sizeof(double));
+        }
+        cycleIO.Build();
+        printf("Cycle I/O: %d read transfer(s), %s\n", cycleIO.ReadRunCountGet(),
+            torqueBulk ? "torques written with one MemoryBlockSet() per axis" : "OUTPUT_OFFSET address not verified, torques use FilterCoeffSet()");
+
+        // host control law for all axes in one SIMD pass, holding each axis at its starting position
+        ControlLaw controlLaw(AXIS_COUNT, SYNC_PERIOD / controller->SampleRateGet());
+        ControlLawConfigure(controlLaw);
+        cycleIO.Snapshot(controller);
+        for (i = 0; i < AXIS_COUNT; i++)
+        {
+            cycleInputs.commandPositions[i] = cycleIO.ReadGet<int32>(positionChannels[i]);
+        }
+
+        // with RECORD_PATH set, keep every cycle's inputs and torques for an offline replay (allocated here, not in the loop)
+        SampleAppsCPP::CycleRecorder recorder(sizeof(SyncCycleInputs), sizeof(torqueOutputs), RECORD_PATH != nullptr ? RECORD_MAX_CYCLES : 0);
+
+        // a sample counter step larger than SYNC_PERIOD means we slept through interrupts: let the control law integrate over the whole gap
+        SampleAppsCPP::MissedSampleMonitor missedSamples(SYNC_PERIOD);
+        missedSamples.HandlerAdd(ControlLaw::MissedSamplesHandle, &controlLaw);
+
         // disable the service thread if using the controller Sync interrupt
         controller->ServiceThreadEnableSet(false);
 
@@ -77,10 +241,15 @@ void syncInterruptMain()
         // See how much total time is available for Sync interrupt processing (before SynqNet buffer is DMA'd)
         printf("Host will have %ld microseconds to process data.\n", controller->SyncInterruptHostProcessTimeGet());
 
-        //
-        // it will be required to set a high thread priority here for Windows... you really should have an RTOS
-        //
-        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+        // start the log's flush thread first so it does not inherit the real-time priority and CPU below
+        cycleLog.Start(stdout);
+
+        // real-time setup for this thread: SCHED_FIFO, CPU pinning and locked, prefaulted memory on Linux (use a PREEMPT_RT kernel),
+        // THREAD_PRIORITY_TIME_CRITICAL on Windows... you really should have an RTOS
+        SampleAppsCPP::CyclicExecutorConfig rtConfig;
+        rtConfig.cpu = RT_CPU;
+        SampleAppsCPP::CyclicExecutor executor(rtConfig);
+        executor.Configure();
 
         // configure a Sync interrupt for every sample
         controller->SyncInterruptPeriodSet(SYNC_PERIOD);
@@ -88,25 +257,43 @@ void syncInterruptMain()
         // enable controller interrupts
         controller->SyncInterruptEnableSet(true);
 
+        // prove the loop wakes with bounded jitter before doing any work in it
+        executor.SelfCheck([&]() { return controller->SyncInterruptWait(); }, SELF_CHECK_CYCLES, SYNC_PERIOD, MS_PER_SECOND * 1000.0 / controller->SampleRateGet());
+        executor.ReportPrint(stdout);
+
+        const double nsPerSample = NS_PER_MS * MS_PER_SECOND / controller->SampleRateGet();
+        SampleAppsCPP::WakeLatencyEstimator wakeLatency((double)cpuFreq / controller->SampleRateGet());
+        SampleAppsCPP::HostTickCounter hostTimer;          // PerformanceTimerCountGet() is 32 bits and wraps
+        periodHistogram.Reset();
+        wakeLatencyHistogram.Reset();
+        missedSamples.Reset();
+
         // wait for someone to press a key 
         while (controller->OS->KeyGet(RSIWaitPOLL) < 0)
         {
             // wait for the controller's Sync interrupt
-            controller->SyncInterruptWait();
+            int32 sample = controller->SyncInterruptWait();
 
             // see if we exceeded our processing time during the previous interrupt
             // did we take too long processing the previous interrupt?
             if (controller->SyncInterruptHostProcessStatusBitGet() == true)
             {
-                printf("\n\n Oops, we took too long processing the last interrupt. \n");
+                cycleLog.Log("\n\n Oops, we took too long processing the last interrupt. \n");
 
                 // clear the Host Process Status Bit
                 controller->SyncInterruptHostProcessStatusClear();
             }
 
             // see how long it's been since last interrupt
-            currentCounter = controller->OS->PerformanceTimerCountGet();
-            deltaSamples = currentCounter - previousCounter;
+            uint64_t hostTicks = hostTimer.Read(controller->OS);
+            double latencySamples = wakeLatency.Update(sample, hostTicks);
+            int32 missedCycles = missedSamples.Update(sample, hostTicks);
+            if (missedCycles > 0)
+            {
+                cycleLog.Log("\n Missed %d sync interrupt(s) before sample %d \n", missedCycles, sample);
+            }
+            currentCounter = hostTicks;
+            deltaSamples = (long)(currentCounter - previousCounter);
             previousCounter = currentCounter;
             deltaTime = (double)(deltaSamples * (double)(1 / (double)cpuFreq)) * MS_PER_SECOND;
             if (iterations > 1) // ignore first time through
@@ -119,25 +306,44 @@ void syncInterruptMain()
                 {
                     minTime = deltaTime;
                 }
-                printf("IRQ %ld: %3.3lf ms  Min: %3.3lf  Max: %3.3lf \n", iterations, deltaTime, minTime, maxTime);
+                cycleLog.Log("IRQ %ld: %3.3lf ms  Min: %3.3lf  Max: %3.3lf \n", iterations, deltaTime, minTime, maxTime);
+                periodHistogram.Record((uint64_t)(deltaTime * NS_PER_MS));
+                wakeLatencyHistogram.Record((uint64_t)(latencySamples * nsPerSample));
             }
 
             // tell the controller firmware that we are going to do some calculations
             controller->SyncInterruptHostProcessFlagSet(true);
 
 
-            // Get Encoder Positions
+            // Get Encoder Positions (primary feedback, in counts) with one bulk read
+            cycleIO.Snapshot(controller);
             for (int i = 0; i < AXIS_COUNT; i++)
             {
-                encoderPositions[i] = axes[i]->EncoderPositionGet(RSIMotorFeedbackPRIMARY);
+                cycleInputs.actualPositions[i] = cycleIO.ReadGet<int32>(positionChannels[i]);
             }
             //
-            // do calculations here
+            // do calculations here (in CycleCompute(), so a recording can replay them)
             //
+            CycleCompute(controlLaw, cycleInputs, torqueOutputs);
+            if (RECORD_PATH != nullptr)
+            {
+                recorder.Record(sample, &cycleInputs, torqueOutputs);
+            }
             // Set Torque Outputs
-            for (int i = 0; i < AXIS_COUNT; i++)
+            if (torqueBulk)
             {
-                axes[i]->FilterCoeffSet(RSIFilterGainPIDCoeffOUTPUT_OFFSET, 0, torqueOutputs[i]);   // gain table 0
+                for (int i = 0; i < AXIS_COUNT; i++)
+                {
+                    cycleIO.WriteDoubleSet(torqueChannels[i], torqueOutputs[i]);                       // gain table 0
+                }
+                cycleIO.Commit(controller);
+            }
+            else
+            {
+                for (int i = 0; i < AXIS_COUNT; i++)
+                {
+                    axes[i]->FilterCoeffSet(RSIFilterGainPIDCoeffOUTPUT_OFFSET, 0, torqueOutputs[i]);   // gain table 0
+                }
             }
 
 
@@ -150,6 +356,18 @@ void syncInterruptMain()
 
         // turn off Sync Interrupt
         controller->SyncInterruptEnableSet(false);
+        cycleLog.Stop();
+
+        periodHistogram.Print(stdout, "\nIRQ period", "us", 1000.0);
+        periodHistogram.BucketsPrint(stdout, 1000.0);
+        wakeLatencyHistogram.Print(stdout, "Wake-up latency", "us", 1000.0);
+        wakeLatencyHistogram.BucketsPrint(stdout, 1000.0);
+        missedSamples.Print(stdout, (double)cpuFreq);
+        if (RECORD_PATH != nullptr)
+        {
+            printf("Recorded %lld cycles (%lld dropped) to %s: %s\n", (long long)recorder.FrameCountGet(), (long long)recorder.DroppedCountGet(),
+                RECORD_PATH, recorder.Save(RECORD_PATH, SYNC_PERIOD, controller->SampleRateGet()) ? "ok" : "FAILED");
+        }
     }
     catch (RsiError const& err)
     {
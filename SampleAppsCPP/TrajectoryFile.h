@@ -0,0 +1,394 @@
+/*!
+*  @example    TrajectoryFile.h
+
+*  @page       trajectory-file-cpp TrajectoryFile.h
+
+*  @brief      Compact binary trajectory file with a memory-mapped reader for MovePT()/MovePVT().
+
+*  @details
+UpdateBufferPoints.cpp and SyncOutputWithMotion.cpp build the whole trajectory in std::vector<double> before motion starts.
+With millions of points that costs gigabytes of RAM and seconds of startup.
+
+A trajectory file stores each array exactly the way MovePT()/MovePVT() wants it:
+
+@code
+    offset 0                    TrajectoryFileHeader (64 bytes)
+    positionsOffset             double positions[pointCount * axisCount]     interleaved per axis (x0,y0,x1,y1...)
+    velocitiesOffset            double velocities[pointCount * axisCount]    only if TRAJECTORY_FILE_HAS_VELOCITIES
+    timesOffset                 double times[pointCount]
+@endcode
+
+Every section starts on a page boundary.  TrajectoryFileMapping maps the file read-only, so a streaming loop can pass
+PositionsGet(i)/TimesGet(i) straight into MovePT() without copying.  Pages are read from disk when first touched, so
+motion can start as soon as the first block is in memory.  PrefetchAhead() asks the OS to read the next blocks early
+and ReleaseBehind() lets it drop blocks that have already been sent, so memory use stays flat for any length of file.
+
+TrajectoryFileWriter writes a file block by block, so a planner never needs the whole trajectory in memory either.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include TrajectoryFile.h
+
+*/
+#ifndef CPP_TRAJECTORY_FILE
+#define CPP_TRAJECTORY_FILE
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SampleAppsCPP
+{
+    const char     TRAJECTORY_FILE_MAGIC[8] = { 'R', 'S', 'I', 'T', 'R', 'A', 'J', '1' };
+    const uint32_t TRAJECTORY_FILE_VERSION = 1;
+    const uint32_t TRAJECTORY_FILE_HAS_VELOCITIES = 0x1;           // flags bit: the file has a velocities section (PVT)
+    const uint64_t TRAJECTORY_FILE_ALIGNMENT = 4096;               // sections start on page boundaries
+
+    /// <summary>
+    /// On-disk header.  Little-endian, 64 bytes.
+    /// </summary>
+    struct TrajectoryFileHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t axisCount;
+        uint64_t pointCount;
+        uint32_t flags;
+        uint32_t reserved;
+        uint64_t positionsOffset;
+        uint64_t velocitiesOffset;                                  // 0 if there are no velocities
+        uint64_t timesOffset;
+        uint64_t reserved2;
+    };
+    static_assert(sizeof(TrajectoryFileHeader) == 64, "TrajectoryFileHeader must stay 64 bytes.");
+
+    inline uint64_t TrajectoryFileAlign(uint64_t offset)
+    {
+        return (offset + TRAJECTORY_FILE_ALIGNMENT - 1) & ~(TRAJECTORY_FILE_ALIGNMENT - 1);
+    }
+
+    /// <summary>
+    /// Fills in a header (including section offsets) for the given shape.  The section sizes must fit in 64 bits: see TrajectoryFileShapeFits().
+    /// </summary>
+    /// <summary>
+    /// True if every section of a file of this shape, and the header before them, fit in maxBytes.  Divides, so it cannot overflow.
+    /// </summary>
+    inline bool TrajectoryFileShapeFits(uint32_t axisCount, uint64_t pointCount, bool hasVelocities, uint64_t maxBytes)
+    {
+        const uint64_t doublesPerPoint = (uint64_t)axisCount * (hasVelocities ? 2 : 1) + 1;     // positions, velocities, time
+        return maxBytes >= sizeof(TrajectoryFileHeader) && pointCount <= (maxBytes - sizeof(TrajectoryFileHeader)) / sizeof(double) / doublesPerPoint;
+    }
+
+    inline TrajectoryFileHeader TrajectoryFileHeaderMake(uint32_t axisCount, uint64_t pointCount, bool hasVelocities)
+    {
+        TrajectoryFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic));
+        header.version = TRAJECTORY_FILE_VERSION;
+        header.axisCount = axisCount;
+        header.pointCount = pointCount;
+        header.flags = hasVelocities ? TRAJECTORY_FILE_HAS_VELOCITIES : 0;
+
+        const uint64_t axisSectionSize = pointCount * axisCount * sizeof(double);
+        header.positionsOffset = TrajectoryFileAlign(sizeof(TrajectoryFileHeader));
+        header.velocitiesOffset = hasVelocities ? TrajectoryFileAlign(header.positionsOffset + axisSectionSize) : 0;
+        header.timesOffset = TrajectoryFileAlign((hasVelocities ? header.velocitiesOffset : header.positionsOffset) + axisSectionSize);
+        return header;
+    }
+
+    /// <summary>
+    /// Writes a trajectory file one block at a time.  The point count must be known up front so each section has a fixed place.
+    /// </summary>
+    class TrajectoryFileWriter
+    {
+    public:
+        TrajectoryFileWriter() : file(nullptr), pointsWritten(0) { memset(&header, 0, sizeof(header)); }
+        ~TrajectoryFileWriter() { Close(); }
+
+        /// <summary>
+        /// Create the file.  Returns false if it could not be created, or if its sections would not fit in 64-bit offsets.
+        /// </summary>
+        bool Open(const char *path, uint32_t axisCount, uint64_t pointCount, bool hasVelocities)
+        {
+            Close();
+            if (!TrajectoryFileShapeFits(axisCount, pointCount, hasVelocities, UINT64_MAX - 4 * TRAJECTORY_FILE_ALIGNMENT))
+            {
+                return false;
+            }
+            header = TrajectoryFileHeaderMake(axisCount, pointCount, hasVelocities);
+            pointsWritten = 0;
+            file = fopen(path, "wb");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            return fwrite(&header, sizeof(header), 1, file) == 1;
+        }
+
+        /// <summary>
+        /// Append count points.  velocities may be nullptr if the file has none.  Returns false on a write error or if it would exceed pointCount.
+        /// </summary>
+        bool PointsAppend(const double *positions, const double *velocities, const double *times, uint64_t count)
+        {
+            if (file == nullptr || count > header.pointCount - pointsWritten)
+            {
+                return false;
+            }
+            const uint64_t axisBytes = header.axisCount * sizeof(double);
+            bool ok = WriteAt(header.positionsOffset + pointsWritten * axisBytes, positions, count * axisBytes);
+            if (header.flags & TRAJECTORY_FILE_HAS_VELOCITIES)
+            {
+                ok = ok && velocities != nullptr && WriteAt(header.velocitiesOffset + pointsWritten * axisBytes, velocities, count * axisBytes);
+            }
+            ok = ok && WriteAt(header.timesOffset + pointsWritten * sizeof(double), times, count * sizeof(double));
+            pointsWritten += count;
+            return ok;
+        }
+
+        /// <summary>
+        /// Finish the file.  Returns false if fewer points than declared were written.
+        /// </summary>
+        bool Close()
+        {
+            if (file == nullptr)
+            {
+                return false;
+            }
+            bool ok = (pointsWritten == header.pointCount);
+            ok = (fclose(file) == 0) && ok;
+            file = nullptr;
+            return ok;
+        }
+
+    private:
+        bool WriteAt(uint64_t offset, const void *data, uint64_t size)
+        {
+#ifdef _WIN32
+            if (_fseeki64(file, (__int64)offset, SEEK_SET) != 0)
+#else
+            if (fseeko(file, (off_t)offset, SEEK_SET) != 0)
+#endif
+            {
+                return false;
+            }
+            return fwrite(data, 1, (size_t)size, file) == size;
+        }
+
+        FILE                 *file;
+        TrajectoryFileHeader header;
+        uint64_t             pointsWritten;
+    };
+
+    /// <summary>
+    /// Read-only memory mapping of a trajectory file.  The pointers it returns stay valid until Close().
+    /// </summary>
+    /// @code
+    ///     SampleAppsCPP::TrajectoryFileMapping trajectory;
+    ///     if (!trajectory.Open("path.rsitraj")) { printf("%s\n", trajectory.ErrorGet()); }
+    ///     multiAxis->MovePT(RSIMotionTypePT, trajectory.PositionsGet(first), trajectory.TimesGet(first), count, EMPTY_CT, false, last);
+    /// @endcode
+    class TrajectoryFileMapping
+    {
+    public:
+        TrajectoryFileMapping() : base(nullptr), size(0), header(nullptr), error("not open")
+        {
+#ifdef _WIN32
+            fileHandle = INVALID_HANDLE_VALUE;
+            mappingHandle = nullptr;
+#else
+            fileDescriptor = -1;
+#endif
+        }
+        ~TrajectoryFileMapping() { Close(); }
+
+        /// <summary>
+        /// Map the file.  Returns false (see ErrorGet()) if it cannot be mapped or is not a valid trajectory file.
+        /// </summary>
+        bool Open(const char *path)
+        {
+            Close();
+            if (!Map(path))
+            {
+                Close();
+                return false;
+            }
+            if (!Validate())
+            {
+                Close();
+                return false;
+            }
+#ifndef _WIN32
+            madvise(base, size, MADV_SEQUENTIAL);                   // streaming reads front to back
+#endif
+            error = nullptr;
+            return true;
+        }
+
+        void Close()
+        {
+#ifdef _WIN32
+            if (base != nullptr) UnmapViewOfFile(base);
+            if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+            fileHandle = INVALID_HANDLE_VALUE;
+            mappingHandle = nullptr;
+#else
+            if (base != nullptr) munmap(base, size);
+            if (fileDescriptor >= 0) close(fileDescriptor);
+            fileDescriptor = -1;
+#endif
+            base = nullptr;
+            size = 0;
+            header = nullptr;
+        }
+
+        const char* ErrorGet() const { return error; }              // nullptr if open and valid
+        bool        IsOpen() const { return header != nullptr; }
+        int32_t     AxisCountGet() const { return (int32_t)header->axisCount; }
+        int64_t     PointCountGet() const { return (int64_t)header->pointCount; }
+        bool        HasVelocitiesGet() const { return (header->flags & TRAJECTORY_FILE_HAS_VELOCITIES) != 0; }
+
+        const double* PositionsGet(int64_t pointIndex) const { return Section(header->positionsOffset) + pointIndex * header->axisCount; }
+        const double* VelocitiesGet(int64_t pointIndex) const { return HasVelocitiesGet() ? Section(header->velocitiesOffset) + pointIndex * header->axisCount : nullptr; }
+        const double* TimesGet(int64_t pointIndex) const { return Section(header->timesOffset) + pointIndex; }
+
+        /// <summary>
+        /// Ask the OS to start reading points [firstPoint, firstPoint + count) from disk without waiting for them.
+        /// </summary>
+        void PrefetchAhead(int64_t firstPoint, int64_t count) const
+        {
+#ifndef _WIN32
+            Advise(firstPoint, count, MADV_WILLNEED);
+#else
+            (void)firstPoint; (void)count;                          // Windows reads mapped pages on first touch
+#endif
+        }
+
+        /// <summary>
+        /// Tell the OS points [firstPoint, firstPoint + count) have been sent and their pages may be dropped.
+        /// Only whole pages inside the range are released.  The data stays readable: it is read from disk again if touched.
+        /// </summary>
+        void ReleaseBehind(int64_t firstPoint, int64_t count) const
+        {
+#ifndef _WIN32
+            Advise(firstPoint, count, MADV_DONTNEED);
+#else
+            (void)firstPoint; (void)count;
+#endif
+        }
+
+    private:
+        const double* Section(uint64_t offset) const { return (const double*)(base + offset); }
+
+        bool Map(const char *path)
+        {
+#ifdef _WIN32
+            fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (fileHandle == INVALID_HANDLE_VALUE) { error = "cannot open trajectory file"; return false; }
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(fileHandle, &fileSize)) { error = "cannot get trajectory file size"; return false; }
+            size = (uint64_t)fileSize.QuadPart;
+            if (size < sizeof(TrajectoryFileHeader)) { error = "trajectory file is too small"; return false; }
+            mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mappingHandle == nullptr) { error = "cannot map trajectory file"; return false; }
+            base = (char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+            if (base == nullptr) { error = "cannot map trajectory file"; return false; }
+#else
+            fileDescriptor = open(path, O_RDONLY);
+            if (fileDescriptor < 0) { error = "cannot open trajectory file"; return false; }
+            struct stat fileStat;
+            if (fstat(fileDescriptor, &fileStat) != 0) { error = "cannot get trajectory file size"; return false; }
+            size = (uint64_t)fileStat.st_size;
+            if (size < sizeof(TrajectoryFileHeader)) { error = "trajectory file is too small"; return false; }
+            void *mapped = mmap(nullptr, (size_t)size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+            if (mapped == MAP_FAILED) { error = "cannot map trajectory file"; return false; }
+            base = (char*)mapped;
+#endif
+            return true;
+        }
+
+        bool Validate()
+        {
+            const TrajectoryFileHeader *candidate = (const TrajectoryFileHeader*)base;
+            if (memcmp(candidate->magic, TRAJECTORY_FILE_MAGIC, sizeof(TRAJECTORY_FILE_MAGIC)) != 0) { error = "not a trajectory file"; return false; }
+            if (candidate->version != TRAJECTORY_FILE_VERSION) { error = "unsupported trajectory file version"; return false; }
+            if (candidate->axisCount == 0) { error = "trajectory file has no axes"; return false; }
+
+            // the file must hold every section, checked by division before any size is multiplied out
+            const bool hasVelocities = (candidate->flags & TRAJECTORY_FILE_HAS_VELOCITIES) != 0;
+            if (!TrajectoryFileShapeFits(candidate->axisCount, candidate->pointCount, hasVelocities, size)) { error = "trajectory file is truncated"; return false; }
+
+            // the offsets must be the ones this version writes
+            TrajectoryFileHeader expected = TrajectoryFileHeaderMake(candidate->axisCount, candidate->pointCount, hasVelocities);
+            if (candidate->positionsOffset != expected.positionsOffset || candidate->velocitiesOffset != expected.velocitiesOffset || candidate->timesOffset != expected.timesOffset)
+            {
+                error = "trajectory file section offsets are corrupt";
+                return false;
+            }
+            if (size < expected.timesOffset + expected.pointCount * sizeof(double)) { error = "trajectory file is truncated"; return false; }
+
+            header = candidate;
+            return true;
+        }
+
+#ifndef _WIN32
+        void AdviseRange(uint64_t begin, uint64_t end, int advice, bool wholePagesOnly) const
+        {
+            const uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+            uint64_t first = wholePagesOnly ? (begin + page - 1) / page * page : begin / page * page;
+            uint64_t last = wholePagesOnly ? end / page * page : (end + page - 1) / page * page;
+            if (last > size) last = size;
+            if (last > first)
+            {
+                madvise(base + first, (size_t)(last - first), advice);
+            }
+        }
+
+        void Advise(int64_t firstPoint, int64_t count, int advice) const
+        {
+            if (header == nullptr || count <= 0) return;
+            if (firstPoint + count > PointCountGet()) count = PointCountGet() - firstPoint;
+            if (count <= 0) return;
+
+            const bool wholePagesOnly = (advice == MADV_DONTNEED);   // never drop a page that still holds unsent points
+            const uint64_t axisBytes = header->axisCount * sizeof(double);
+            AdviseRange(header->positionsOffset + firstPoint * axisBytes, header->positionsOffset + (firstPoint + count) * axisBytes, advice, wholePagesOnly);
+            if (HasVelocitiesGet())
+            {
+                AdviseRange(header->velocitiesOffset + firstPoint * axisBytes, header->velocitiesOffset + (firstPoint + count) * axisBytes, advice, wholePagesOnly);
+            }
+            AdviseRange(header->timesOffset + firstPoint * sizeof(double), header->timesOffset + (firstPoint + count) * sizeof(double), advice, wholePagesOnly);
+        }
+#endif
+
+        char                        *base;
+        uint64_t                    size;
+        const TrajectoryFileHeader  *header;
+        const char                  *error;
+#ifdef _WIN32
+        HANDLE                      fileHandle;
+        HANDLE                      mappingHandle;
+#else
+        int                         fileDescriptor;
+#endif
+    };
+}
+#endif
@@ -0,0 +1,194 @@
+/*!
+@example    TrajectoryFileMotion.cpp
+
+*  @page       trajectory-file-motion-cpp TrajectoryFileMotion.cpp
+
+*  @brief      Streaming PT motion straight out of a memory-mapped trajectory file.
+
+*  @details
+This is the UpdateBufferPoints.cpp motion, but the trajectory lives in a file instead of in std::vector<double>.
+
+First the trajectory is written to TRAJECTORY_PATH one block at a time with a TrajectoryFileWriter, so the planner never holds more than one block.
+Then the file is mapped with a TrajectoryFileMapping and each MovePT() call gets pointers into the mapping, so no point is ever copied by the application.
+Motion starts as soon as the first blocks are paged in, while the rest of the file is still on disk.
+
+*  @pre        This sample code presumes that the user has set the tuning paramters(PID, PIV, etc.) prior to running this program so that the motor can rotate in a stable manner.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+*
+*  @include TrajectoryFileMotion.cpp
+*/
+
+#include <cassert>
+#include <cmath>
+#include "rsi.h"                                    // Import our RapidCode Library.
+#include "HelperFunctions.h"                        // Import our SampleApp helper functions.
+#include "TrajectoryFile.h"                         // Import the trajectory file format.
+
+using namespace RSI::RapidCode;
+
+namespace
+{
+    const double    TIME_SLICE = 0.001;                                 // 0.001s = 1ms
+    const int       AXIS_COUNT = 1;                                     // number of axes
+    const int       REVS = 5;                                           // number of revolutions
+    const int       RPS = 1;                                            // revs / sec
+    const int       TOTAL_POINTS = (int)(REVS / TIME_SLICE / RPS);      // total number of points
+    const int       BUFFER_SZ = 100;                                    // Number of points to send in a buffer
+    const int       PREFETCH_BLOCKS = 4;                                // Blocks to ask the OS to read ahead of the one being sent
+
+    const char      TRAJECTORY_PATH[] = "UpdateBufferPoints.rsitraj";
+
+    // Write the trajectory one block at a time.  Memory use does not depend on TOTAL_POINTS.
+    bool WriteTrajectoryFile()
+    {
+        double positions[BUFFER_SZ * AXIS_COUNT];
+        double times[BUFFER_SZ];
+
+        SampleAppsCPP::TrajectoryFileWriter writer;
+        if (!writer.Open(TRAJECTORY_PATH, AXIS_COUNT, TOTAL_POINTS, false))
+        {
+            return false;
+        }
+        for (int first = 0; first < TOTAL_POINTS; first += BUFFER_SZ)
+        {
+            int count = (TOTAL_POINTS - first < BUFFER_SZ) ? (TOTAL_POINTS - first) : BUFFER_SZ;
+            for (int i = 0; i < count; i++)
+            {
+                for (int axis = 0; axis < AXIS_COUNT; axis++)
+                {
+                    positions[i * AXIS_COUNT + axis] = (first + i) * TIME_SLICE * RPS;
+                }
+                times[i] = TIME_SLICE;
+            }
+            if (!writer.PointsAppend(positions, nullptr, times, count))
+            {
+                return false;
+            }
+        }
+        return writer.Close();
+    }
+}
+
+void trajectoryFileMotionMain()
+{
+    const int       CPS = (int)std::pow(2, 20);                         // encoder counts per rev (set as appropiate)
+    const int       EMPTY_CT = 10;                                      // Number of points that remains in the buffer before an e-stop
+
+    if (!WriteTrajectoryFile())
+    {
+        printf("Could not write %s\n", TRAJECTORY_PATH);
+        return;
+    }
+
+    SampleAppsCPP::TrajectoryFileMapping trajectory;
+    if (!trajectory.Open(TRAJECTORY_PATH))
+    {
+        printf("Could not map %s: %s\n", TRAJECTORY_PATH, trajectory.ErrorGet());
+        return;
+    }
+    assert(trajectory.AxisCountGet() == AXIS_COUNT);
+    const int64_t totalPoints = trajectory.PointCountGet();
+
+    MotionController *controller = MotionController::CreateFromSoftware();
+    SampleAppsCPP::HelperFunctions::CheckErrors(controller);
+    try
+    {
+        SampleAppsCPP::HelperFunctions::StartTheNetwork(controller);
+
+        // add an additional axis for the multiaxis supervisor
+        controller->MotionCountSet(AXIS_COUNT + 1);
+        MultiAxis *multiAxis = controller->MultiAxisGet(AXIS_COUNT);
+        SampleAppsCPP::HelperFunctions::CheckErrors(multiAxis);
+
+        for (int i = 0; i < AXIS_COUNT; i++)
+        {
+            Axis *tempAxis = controller->AxisGet(i);
+            SampleAppsCPP::HelperFunctions::CheckErrors(tempAxis);
+
+            tempAxis->EStopAbort();
+            tempAxis->ClearFaults();
+            tempAxis->PositionSet(0);
+            tempAxis->UserUnitsSet(CPS);
+            multiAxis->AxisAdd(tempAxis);
+        }
+
+        // prepare the controller (and drive)
+        multiAxis->Abort();
+        multiAxis->ClearFaults();
+        assert(multiAxis->StateGet() == RSIState::RSIStateIDLE);
+        multiAxis->AmpEnableSet(true);
+
+        // reset the motion ID to 0
+        multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, trajectory.PositionsGet(0), trajectory.TimesGet(0), 1, -1, false, true);
+        multiAxis->MotionIdSet(0);
+
+        int curMotionID = 0, finalMotionID = 0;
+        int64_t numPointsToSend = BUFFER_SZ;
+        int64_t endOfLastSent = 0;
+        bool exitCondition = false;
+
+        // Set up a motion hold gate so we can start buffering blocks
+        const int motionHoldGate = 3;
+        controller->MotionHoldGateSet(motionHoldGate, true);
+        multiAxis->MotionHoldGateSet(motionHoldGate);
+
+        trajectory.PrefetchAhead(0, BUFFER_SZ * (2 + PREFETCH_BLOCKS));
+        for (int i = 0; i < 2; ++i)
+        {
+            multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, trajectory.PositionsGet(endOfLastSent), trajectory.TimesGet(endOfLastSent), (int32)numPointsToSend, EMPTY_CT, false, exitCondition);
+            endOfLastSent += numPointsToSend;
+            ++finalMotionID;
+        }
+
+        controller->SyncInterruptPeriodSet(10); // this generates an interrupt every x cycles of a 1KHz sample rate
+        controller->SyncInterruptEnableSet(true);
+
+        controller->MotionHoldGateSet(motionHoldGate, false); // release the hold gate to start moving
+
+        while (!exitCondition)
+        {
+            controller->SyncInterruptWait();
+            curMotionID = multiAxis->MotionIdExecutingGet();
+
+            if (std::abs(finalMotionID - curMotionID) < 2)
+            {
+                // check end condition
+                if (totalPoints <= (endOfLastSent + BUFFER_SZ))
+                {
+                    numPointsToSend = totalPoints - endOfLastSent; // send the remaining points
+                    exitCondition = true;
+                }
+
+                // pointers straight into the mapped file, no copy
+                multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, trajectory.PositionsGet(endOfLastSent), trajectory.TimesGet(endOfLastSent), (int32)numPointsToSend, EMPTY_CT, false, exitCondition);
+
+                // keep the disk ahead of the motion and let the OS drop what the library has already copied
+                trajectory.ReleaseBehind(endOfLastSent, numPointsToSend);
+                endOfLastSent += numPointsToSend;
+                trajectory.PrefetchAhead(endOfLastSent + BUFFER_SZ, BUFFER_SZ * PREFETCH_BLOCKS);
+                ++finalMotionID;
+            }
+        }
+        printf("Updates Done. Waiting to finish motion.\n");
+        multiAxis->MotionDoneWait();
+        printf("Motion Complete. Final Motion ID: %d\tFinal Element ID %d\n", multiAxis->MotionIdExecutingGet(), multiAxis->MotionElementIdExecutingGet());
+
+        controller->SyncInterruptEnableSet(false);
+        multiAxis->EStopAbort();
+    }
+    catch (RsiError const& err)
+    {
+        printf("\n%s\n", err.text);
+    }
+    controller->Delete();                                   // Delete the controller as the program exits to ensure memory is deallocated in the correct order.
+}
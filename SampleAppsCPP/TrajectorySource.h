@@ -0,0 +1,210 @@
+/*!
+*  @example    TrajectorySource.h
+
+*  @page       trajectory-source-cpp TrajectorySource.h
+
+*  @brief      Lazy trajectory sources that compute points only when the streaming loop asks for them.
+
+*  @details
+UpdateBufferPoints.cpp pushes every point into a std::vector before motion starts and PVTmotionMultiAxis.cpp fills fixed stack arrays.
+Memory grows with motion length and the first point waits for the whole precompute.
+
+A TrajectorySource is a generator: each PointsNext() call computes only the next block, straight into the caller's buffers
+(for example a PointBlock from StreamingPointRing.h).  Memory stays constant no matter how long the motion is,
+and the first block is ready after computing a single block.
+
+*  @warning    This is a sample program to assist in the integration of your motion controller with your application. It may not contain all of the logic and safety features that your application requires.
+
+*  @copyright
+Copyright &copy; 1998-2019 by Robotic Systems Integration, Inc. All rights reserved.
+This software contains proprietary and confidential information of Robotic
+Systems Integration, Inc. (RSI) and its suppliers. Except as may be set forth
+in the license agreement under which this software is supplied, disclosure,
+reproduction, or use with controls other than those provided by RSI or suppliers
+for RSI is strictly prohibited without the prior express written consent of
+Robotic Systems Integration.
+
+*  @include TrajectorySource.h
+
+*/
+#ifndef CPP_TRAJECTORY_SOURCE
+#define CPP_TRAJECTORY_SOURCE
+
+#include <cmath>
+#include <cstdint>
+
+namespace SampleAppsCPP
+{
+    /// <summary>
+    /// A generator of streamed points.  Positions and velocities are interleaved per axis (x0,y0,x1,y1...) like MovePT()/MovePVT() expect.
+    /// </summary>
+    class TrajectorySource
+    {
+    public:
+        virtual ~TrajectorySource() {}
+
+        virtual int32_t AxisCountGet() const = 0;
+
+        /// <summary>
+        /// True if PointsNext() fills velocities (use MovePVT()), false if it leaves them alone (use MovePT()).
+        /// </summary>
+        virtual bool HasVelocitiesGet() const = 0;
+
+        /// <summary>
+        /// Compute up to maxPoints more points.  Returns how many were written, 0 once the trajectory is finished.
+        /// velocities may be nullptr when HasVelocitiesGet() is false.
+        /// </summary>
+        virtual int32_t PointsNext(double *positions, double *velocities, double *times, int32_t maxPoints) = 0;
+
+        /// <summary>
+        /// True once every point has been returned.  The block that returns the last point should be sent with final=true.
+        /// </summary>
+        virtual bool IsDoneGet() const = 0;
+    };
+
+    /// <summary>
+    /// A source of pointCount points computed one at a time by a callable:
+    /// void pointFunction(int64_t index, double *positions, double *velocities, double *time).
+    /// </summary>
+    template <class PointFunction>
+    class FunctionTrajectorySource : public TrajectorySource
+    {
+    public:
+        FunctionTrajectorySource(int32_t axisCount, int64_t pointCount, bool hasVelocities, PointFunction pointFunction)
+            : axisCount(axisCount), pointCount(pointCount), hasVelocities(hasVelocities), pointFunction(pointFunction), nextIndex(0), done(pointCount <= 0) {}
+
+        int32_t AxisCountGet() const override { return axisCount; }
+        bool    HasVelocitiesGet() const override { return hasVelocities; }
+        bool    IsDoneGet() const override { return done; }
+
+        int32_t PointsNext(double *positions, double *velocities, double *times, int32_t maxPoints) override
+        {
+            int32_t count = 0;
+            while (!done && count < maxPoints)
+            {
+                double *pointVelocities = hasVelocities ? &velocities[count * axisCount] : nullptr;
+                pointFunction(nextIndex, &positions[count * axisCount], pointVelocities, &times[count]);
+                ++count;
+                done = (++nextIndex >= pointCount);
+            }
+            return count;
+        }
+
+    private:
+        int32_t         axisCount;
+        int64_t         pointCount;
+        bool            hasVelocities;
+        PointFunction   pointFunction;
+        int64_t         nextIndex;
+        bool            done;
+    };
+
+    /// <summary>
+    /// Helper so the callable type does not have to be spelled out.
+    /// </summary>
+    template <class PointFunction>
+    FunctionTrajectorySource<PointFunction> FunctionTrajectorySourceMake(int32_t axisCount, int64_t pointCount, bool hasVelocities, PointFunction pointFunction)
+    {
+        return FunctionTrajectorySource<PointFunction>(axisCount, pointCount, hasVelocities, pointFunction);
+    }
+
+    /// <summary>
+    /// The UpdateBufferPoints.cpp trajectory: every axis moves at a constant revsPerSecond, one point per timeSlice.
+    /// </summary>
+    class ConstantVelocitySource : public TrajectorySource
+    {
+    public:
+        ConstantVelocitySource(int32_t axisCount, int64_t pointCount, double timeSlice, double revsPerSecond)
+            : axisCount(axisCount), pointCount(pointCount), timeSlice(timeSlice), revsPerSecond(revsPerSecond), nextIndex(0) {}
+
+        int32_t AxisCountGet() const override { return axisCount; }
+        bool    HasVelocitiesGet() const override { return false; }
+        bool    IsDoneGet() const override { return nextIndex >= pointCount; }
+
+        int32_t PointsNext(double *positions, double * /*velocities*/, double *times, int32_t maxPoints) override
+        {
+            int32_t count = (pointCount - nextIndex < maxPoints) ? (int32_t)(pointCount - nextIndex) : maxPoints;
+            for (int32_t i = 0; i < count; i++)
+            {
+                const double position = (nextIndex + i) * timeSlice * revsPerSecond;
+                for (int32_t axis = 0; axis < axisCount; axis++)
+                {
+                    positions[i * axisCount + axis] = position;
+                }
+                times[i] = timeSlice;
+            }
+            nextIndex += count;
+            return count;
+        }
+
+    private:
+        int32_t axisCount;
+        int64_t pointCount;
+        double  timeSlice;
+        double  revsPerSecond;
+        int64_t nextIndex;
+    };
+
+    /// <summary>
+    /// The PVTmotionMultiAxis.cpp quarter circle on two axes, with the same forward-difference velocities and a final velocity of 0.
+    /// Only the next point is computed ahead, so there is no array sized by the point count.
+    /// </summary>
+    class QuarterCircleSource : public TrajectorySource
+    {
+    public:
+        QuarterCircleSource(double radius, int64_t pointCount, double timeSlice)
+            : radius(radius), pointCount(pointCount), timeSlice(timeSlice), nextIndex(0),
+              radiansPerPoint((90.0 / pointCount) * 3.14159265358979323 / 180.0) {}
+
+        int32_t AxisCountGet() const override { return 2; }
+        bool    HasVelocitiesGet() const override { return true; }
+        bool    IsDoneGet() const override { return nextIndex >= pointCount; }
+
+        int32_t PointsNext(double *positions, double *velocities, double *times, int32_t maxPoints) override
+        {
+            int32_t count = (pointCount - nextIndex < maxPoints) ? (int32_t)(pointCount - nextIndex) : maxPoints;
+            for (int32_t i = 0; i < count; i++)
+            {
+                const int64_t index = nextIndex + i;
+                const double x = radius * std::cos((index + 1) * radiansPerPoint);
+                const double y = radius * std::sin((index + 1) * radiansPerPoint);
+                positions[i * 2] = x;
+                positions[i * 2 + 1] = y;
+
+                if (index + 1 < pointCount)
+                {
+                    velocities[i * 2] = (radius * std::cos((index + 2) * radiansPerPoint) - x) / timeSlice;
+                    velocities[i * 2 + 1] = (radius * std::sin((index + 2) * radiansPerPoint) - y) / timeSlice;
+                }
+                else
+                {
+                    velocities[i * 2] = 0;                          // stop at the final point
+                    velocities[i * 2 + 1] = 0;
+                }
+                times[i] = timeSlice;
+            }
+            nextIndex += count;
+            return count;
+        }
+
+    private:
+        double  radius;
+        int64_t pointCount;
+        double  timeSlice;
+        int64_t nextIndex;
+        double  radiansPerPoint;
+    };
+
+    /// <summary>
+    /// Fill a PointBlock (StreamingPointRing.h) from a source.  Returns the number of points written.
+    /// </summary>
+    template <class BlockT>
+    int32_t PointBlockFill(TrajectorySource& source, BlockT& block, int64_t firstPointIndex)
+    {
+        block.pointCount = source.PointsNext(block.positions, block.velocities, block.times, BlockT::CAPACITY);
+        block.firstPointIndex = (int32_t)firstPointIndex;
+        block.isFinal = source.IsDoneGet();
+        return block.pointCount;
+    }
+}
+#endif
@@ -31,9 +31,15 @@ Robotic Systems Integration.
 
 #include <cassert>
 #include "rsi.h"                                    // Import our RapidCode Library. 
+#include "StreamingDepthController.h"               // Import StreamingBlockLedger to count queued points.
+#include "StreamingTelemetry.h"                     // Import the underrun margin telemetry.
+#include "CycleLog.h"                               // Import the asynchronous cycle log.
 
 using namespace RSI::RapidCode;
 
+// messages from the streaming loop are queued here and printed by a background thread
+static SampleAppsCPP::CycleLog<1024> updateBufferLog;
+
 void PrintUpdateBufferErrors(RapidCodeObject *rsiClass)
 {
     RsiError *err;
@@ -81,6 +87,7 @@ void updateBufferPointsMain()
     const int        TOTAL_POINTS = (int)(REVS / TIME_SLICE / RPS);    // total number of points
     const int        BUFFER_SZ = 100;                                // Number of points to send in a buffer
     const int        EMPTY_CT = 10;                                    // Number of points that remains in the beffer before an e-stop
+    const int        ALARM_MARGIN = BUFFER_SZ / 2;                    // Warn when fewer than this many points remain above EMPTY_CT
 
     // Initizalize the controller from software w/ multiple axes
     MotionController *controller;
@@ -142,6 +149,12 @@ void updateBufferPointsMain()
 
         bool exitCondition = false;
 
+        // Track every block sent so queued points can be measured at each interrupt
+        SampleAppsCPP::StreamingBlockLedger ledger;
+        SampleAppsCPP::StreamingTelemetry telemetry(EMPTY_CT, ALARM_MARGIN, 10, controller->OS->PerformanceTimerFrequencyGet() / 1e6);
+        SampleAppsCPP::HostTickCounter hostTimer;          // the 32-bit host timer, unwrapped so send intervals stay right across a wrap
+        ledger.Reset(0);
+
 
         // Set up a motion hold gate so we can start buffering blocks
         const int motionHoldGate = 3;
@@ -151,11 +164,15 @@ void updateBufferPointsMain()
         for (int i = 0; i < 2; ++i)
         {
             multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, &positions[0] + endOfLastSent * AXIS_COUNT, &times[0] + endOfLastSent, numPointsToSend, EMPTY_CT, false, exitCondition);
+            ledger.BlockSent(numPointsToSend);
+            telemetry.BlockSent(hostTimer.Read(controller->OS));
             endOfLastSent += numPointsToSend;
             ++finalMotionID;
         }
 
 
+        updateBufferLog.Start(stdout);
+
         // Set up the interrupt frequency period
         controller->SyncInterruptPeriodSet(10); // this generates an interrupt every x cycles of a 1KHz sample rate
         // With our timeslices of 1ms, this is 10*1ms=10ms
@@ -170,6 +187,14 @@ void updateBufferPointsMain()
             // There's an additional delay to retrieve the data as well.
             curMotionElementID = multiAxis->MotionElementIdExecutingGet();
 
+            // record how much margin is left above EMPTY_CT
+            if (telemetry.Record(sampleRecieved, curMotionID, curMotionElementID,
+                ledger.PointsExecutedGet(curMotionID, curMotionElementID), ledger.QueuedPointsGet(curMotionID, curMotionElementID),
+                hostTimer.Read(controller->OS)))
+            {
+                updateBufferLog.Log("Warning: only %lld points queued above EMPTY_CT\n", (long long)(ledger.QueuedPointsGet(curMotionID, curMotionElementID) - EMPTY_CT));
+            }
+
             /*
             Each MovePT assigns a new MotionID for each call to a move update (with the bufferred points)
             Working under the assumption that each Buffer gets a new ID, send two (or several) smaller ones
@@ -187,17 +212,21 @@ void updateBufferPointsMain()
                     exitCondition = true;
                 }
                 multiAxis->MovePT(RSIMotionType::RSIMotionTypePT, &positions[0] + endOfLastSent * AXIS_COUNT, &times[0] + endOfLastSent, numPointsToSend, EMPTY_CT, false, exitCondition);
+                ledger.BlockSent(numPointsToSend);
+                telemetry.BlockSent(hostTimer.Read(controller->OS));
 
-                printf("MotionID %d\nEnd of Last Sent %d\nElement ID %d\nNum to Send %d\nIs Done %s\n===========================================\n\n",
+                updateBufferLog.Log("MotionID %d\nEnd of Last Sent %d\nElement ID %d\nNum to Send %d\nIs Done %s\n===========================================\n\n",
                     curMotionID, endOfLastSent, curMotionElementID, numPointsToSend, exitCondition ? "yes" : "no");
 
                 endOfLastSent += numPointsToSend;
                 ++finalMotionID;
             }
         }
+        updateBufferLog.Stop();
         printf("Updates Done. Waiting to finish motion.\n");
         multiAxis->MotionDoneWait();
         printf("Motion Complete. Final Motion ID: %d\tFinal Element ID %d\n", multiAxis->MotionIdExecutingGet(), multiAxis->MotionElementIdExecutingGet());
+        telemetry.Print(stdout);
 
         multiAxis->EStopAbort();
     }
@@ -13,6 +13,7 @@
 #include <tchar.h>
 
 void AbsoluteMotionMain();
+void adaptiveBufferDepthMain();
 void AxisSettlingMain();
 void AxisStatusMain();
 void CammingMain();
@@ -20,6 +21,7 @@ void captureMain();
 void configAmpFaultMain();
 void controllerInterruptsMain();
 void custom97Main();
+void cycleIOBenchmarkMain();
 void customHomeMain();
 void DedicatedIOMain();
 void driveMonitorMain();
@@ -27,6 +29,8 @@ void ErrorLogMain();
 void FeedRateMain();
 void FinalVelocityMain();
 void GearingMain();
+void hostControlLawBenchmarkMain();
+void generatorTrajectorySourceMain();
 void homeMain();
 void HardwareLimitsMain();
 void HomeToNegativeLimitMain();
@@ -37,22 +41,33 @@ void MotionHoldReleasedByDigitalInputMain();
 void MotionHoldReleasedByDigitalInputMain();
 void MotionHoldReleasedBySoftwareAddressMain();
 void multiaxisMotionMain();
+void multiGroupStreamingMain();
+void multiRateTasksMain();
+void movePTBenchmarkMain();
 void memoryMain();
 void pathMotionMain();
+void pointTransposeBenchmarkMain();
 void PTmotionMain();
 void PVTmotionMain();
 void PVTmotionMultiAxisMain();
+void pvtBuilderBenchmarkMain();
 void PhantomAxisMain();
 void PointToPointMultiaxisMotionMain();
 void PTmotionWhileStoppingMain();
 void RelativeMotionMain();
 void RecorderMain();
+void recordCompressionBenchmarkMain();
+void recorderDrainBenchmarkMain();
 void settleCriteriaMain();
 void StopRateMain();
 void streamingMotionBufferManagementMain();
+void streamingPointRingBenchmarkMain();
+void streamingPointRingMotionMain();
+void streamingSyncOutputsMain();
 void syncInterruptMain();
 void SCurveMotionMain();
 void SetUserUnitsMain();
+void trajectoryFileMotionMain();
 void SingleAxisSyncOutputsMain();
 void VelocitySetByAnalogInputValueMain();
 void UserLimitDigitalInputActionMain();